@@ -0,0 +1,49 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file allocation_counter.h
+ * @brief Global operator new/delete replacements that count heap traffic
+ *
+ * Include from exactly one translation unit of a benchmark program. Counts
+ * cover every thread, including the logger's workers.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace allocation_counter {
+
+inline std::atomic<uint64_t> bytes{0};
+inline std::atomic<uint64_t> count{0};
+
+struct Snapshot {
+    uint64_t bytes;
+    uint64_t count;
+};
+
+inline Snapshot now() {
+    return {bytes.load(std::memory_order_relaxed), count.load(std::memory_order_relaxed)};
+}
+
+inline void* allocate(std::size_t size) {
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace allocation_counter
+
+void* operator new(std::size_t size) { return allocation_counter::allocate(size); }
+void* operator new[](std::size_t size) { return allocation_counter::allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,160 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file detector_scaling_benchmark.cpp
+ * @brief Anomaly detector throughput with 1 to 16 concurrent workers
+ *
+ * Every worker scores and trains batches of metric-carrying events against
+ * one shared z-score + moving-average ensemble, the way the Logger's worker
+ * threads do. RateDetector is left out: its training cost grows with the
+ * events in its window, which would swamp the locking cost measured here.
+ * Three ways of driving the ensemble are compared:
+ *
+ *   global lock     the whole detector behind one mutex, score then train
+ *                   (how the detectors used to serialize workers)
+ *   separate calls  score_batch() then train_batch() on the sharded state
+ *   fused           score_and_train_batch(), one pass per shard
+ *
+ * Scaling past 1 worker needs as many cores; on a single core the numbers
+ * only show the per-batch overhead of each approach.
+ */
+
+#include <agentlog/agentlog.h>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace agentlog;
+
+namespace {
+
+constexpr size_t kBatchSize = 64;
+constexpr size_t kMetricsPerEvent = 4;
+constexpr size_t kMetricNames = 64;
+constexpr size_t kEventTypes = 16;
+constexpr size_t kEventsPerWorker = 20000;
+
+// The old locking scheme: every call serialized on a single mutex
+class GlobalLockDetector : public AnomalyDetector {
+public:
+    explicit GlobalLockDetector(std::shared_ptr<AnomalyDetector> inner)
+        : inner_(std::move(inner)) {}
+
+    double score(const LogEvent& event) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return inner_->score(event);
+    }
+
+    void train(const LogEvent& event) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inner_->train(event);
+    }
+
+    void score_batch(const std::vector<const LogEvent*>& events,
+                     std::vector<double>& scores) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inner_->score_batch(events, scores);
+    }
+
+    void train_batch(const std::vector<const LogEvent*>& events) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inner_->train_batch(events);
+    }
+
+    std::string name() const override { return "global_lock"; }
+
+private:
+    std::shared_ptr<AnomalyDetector> inner_;
+    std::mutex mutex_;
+};
+
+enum class Mode { GLOBAL_LOCK, SEPARATE, FUSED };
+
+std::vector<LogEvent> make_events(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> value(100.0, 10.0);
+    std::uniform_int_distribution<size_t> metric(0, kMetricNames - 1);
+    std::uniform_int_distribution<size_t> type(0, kEventTypes - 1);
+
+    std::vector<LogEvent> events;
+    events.reserve(kBatchSize * 16);
+    for (size_t i = 0; i < kBatchSize * 16; ++i) {
+        LogEvent event("event_" + std::to_string(type(rng)));
+        for (size_t m = 0; m < kMetricsPerEvent; ++m) {
+            event.metric("metric_" + std::to_string(metric(rng)), value(rng));
+        }
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+void worker(AnomalyDetector& detector, Mode mode, unsigned seed) {
+    std::vector<LogEvent> events = make_events(seed);
+    std::vector<const LogEvent*> batch;
+    std::vector<double> scores;
+
+    for (size_t done = 0; done < kEventsPerWorker; done += kBatchSize) {
+        batch.clear();
+        for (size_t i = 0; i < kBatchSize; ++i) {
+            batch.push_back(&events[(done + i) % events.size()]);
+        }
+
+        if (mode == Mode::FUSED) {
+            detector.score_and_train_batch(batch, scores);
+        } else {
+            detector.score_batch(batch, scores);
+            detector.train_batch(batch);
+        }
+    }
+}
+
+double run(Mode mode, size_t workers) {
+    auto ensemble = std::make_shared<EnsembleDetector>(EnsembleDetector::CombineMethod::MAX);
+    ensemble->add_detector(DetectorFactory::create_z_score(3.0));
+    ensemble->add_detector(DetectorFactory::create_moving_average(100));
+
+    std::shared_ptr<AnomalyDetector> detector = ensemble;
+    if (mode == Mode::GLOBAL_LOCK) {
+        detector = std::make_shared<GlobalLockDetector>(detector);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back(worker, std::ref(*detector), mode, static_cast<unsigned>(w + 1));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(workers * kEventsPerWorker) / seconds;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Detector scaling (" << kBatchSize << "-event batches, "
+              << kMetricsPerEvent << " metrics per event, "
+              << std::thread::hardware_concurrency() << " hardware threads)\n";
+    std::cout << "  workers   global lock   separate calls   fused   (k events/s)\n";
+
+    for (size_t workers : {1, 2, 4, 8, 16}) {
+        double global = run(Mode::GLOBAL_LOCK, workers);
+        double separate = run(Mode::SEPARATE, workers);
+        double fused = run(Mode::FUSED, workers);
+
+        std::cout << "  " << workers
+                  << "\t    " << static_cast<int>(global / 1000)
+                  << "\t\t  " << static_cast<int>(separate / 1000)
+                  << "\t\t   " << static_cast<int>(fused / 1000) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file event_layout_benchmark.cpp
+ * @brief Allocations and lookup cost of LogEvent entity/metric/context storage
+ *
+ * Builds the same "typical" event (3 entities, 2 metrics, 2 context entries)
+ * twice: once with the std::map layout LogEvent used to have, and once as a
+ * real LogEvent with its flat contiguous maps. Reports heap allocations per
+ * event and the time spent building and probing them.
+ */
+
+#include "allocation_counter.h"
+#include <agentlog/agentlog.h>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace agentlog;
+
+namespace {
+
+constexpr int kIterations = 200000;
+
+// The layout LogEvent used before flat storage
+struct MapLayoutEvent {
+    std::map<std::string, std::string> entities;
+    std::map<std::string, double> metrics;
+    std::map<std::string, std::string> context;
+};
+
+const char* user_for(int i) {
+    return (i & 1) ? "user-1042" : "user-2077";
+}
+
+void fill_entities(std::map<std::string, std::string>& entities, int i) {
+    entities["user_id"] = user_for(i);
+    entities["order_id"] = "ord-88812";
+    entities["region"] = "us-east";
+}
+
+void fill_entities(LogEvent& event, int i) {
+    event.entity("user_id", user_for(i))
+         .entity("order_id", "ord-88812")
+         .entity("region", "us-east");
+}
+
+template<typename Fn>
+void run(const char* label, Fn&& fn) {
+    uint64_t before = allocation_counter::now().count;
+    auto start = std::chrono::steady_clock::now();
+
+    double checksum = 0.0;
+    for (int i = 0; i < kIterations; ++i) {
+        checksum += fn(i);
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t allocations = allocation_counter::now().count - before;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+
+    std::cout << "  " << label << ": "
+              << static_cast<double>(allocations) / kIterations << " allocations/event, "
+              << ns << " ns/event (checksum " << checksum << ")\n";
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== LogEvent storage layout benchmark (" << kIterations << " events) ===\n\n";
+
+    std::cout << "Build event (3 entities, 2 metrics, 2 context):\n";
+    run("std::map layout", [](int i) {
+        MapLayoutEvent event;
+        fill_entities(event.entities, i);
+        event.metrics["latency_ms"] = 12.5 + i % 7;
+        event.metrics["amount_usd"] = 99.99;
+        event.context["endpoint"] = "/api/checkout";
+        event.context["method"] = "POST";
+        return event.metrics["latency_ms"];
+    });
+    run("flat LogEvent ", [](int i) {
+        LogEvent event("payment.processed");
+        fill_entities(event, i);
+        event.metric("latency_ms", 12.5 + i % 7)
+             .metric("amount_usd", 99.99)
+             .context("endpoint", "/api/checkout")
+             .context("method", "POST");
+        return event.metrics().at("latency_ms");
+    });
+
+    std::cout << "\nLookup entities and metrics (per event, 5 probes):\n";
+    MapLayoutEvent map_event;
+    fill_entities(map_event.entities, 0);
+    map_event.metrics["latency_ms"] = 12.5;
+    map_event.metrics["amount_usd"] = 99.99;
+
+    LogEvent flat_event("payment.processed");
+    fill_entities(flat_event, 0);
+    flat_event.metric("latency_ms", 12.5).metric("amount_usd", 99.99);
+
+    run("std::map layout", [&](int) {
+        double hits = 0.0;
+        hits += map_event.entities.count("user_id");
+        hits += map_event.entities.count("region");
+        hits += map_event.entities.count("session_id");
+        hits += map_event.metrics.find("latency_ms")->second;
+        hits += map_event.metrics.find("amount_usd")->second;
+        return hits;
+    });
+    run("flat LogEvent ", [&](int) {
+        double hits = 0.0;
+        hits += flat_event.entities().count("user_id");
+        hits += flat_event.entities().count("region");
+        hits += flat_event.entities().count("session_id");
+        hits += flat_event.metrics().find("latency_ms")->second;
+        hits += flat_event.metrics().find("amount_usd")->second;
+        return hits;
+    });
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file load_generator.cpp
+ * @brief End-to-end multi-producer throughput and emit latency
+ *
+ * Producer threads emit the request traces of microservices_correlation.cpp
+ * (gateway, auth, database, response; one trace ID each) through the full
+ * pipeline with every analysis stage enabled, as fast as they can. The
+ * events are built as LogEvents, since EventBuilder cannot set a trace ID.
+ *
+ * Reports emitted and processed events/s, emit() latency percentiles,
+ * heap bytes allocated per event (all threads, workers included), the
+ * logger's drop and queue-wait figures and its per-stage p99.
+ *
+ *   load_generator [producers] [seconds] [drop|block]
+ *
+ * "block" uses the BLOCK overflow policy, so producers are held to what
+ * the workers sustain instead of dropping the excess (the default).
+ */
+
+#include "allocation_counter.h"
+#include <agentlog/agentlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace agentlog;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr size_t kLatencySampleEvery = 16;  // Emits timed per producer
+constexpr uint64_t kUsers = 10000;
+
+struct ProducerResult {
+    uint64_t emitted{0};
+    std::vector<uint32_t> latencies_ns;
+};
+
+void emit_timed(ProducerResult& result, LogEvent& event) {
+    if (result.emitted++ % kLatencySampleEvery != 0) {
+        Logger::instance().emit(std::move(event));
+        return;
+    }
+    auto start = clock_type::now();
+    Logger::instance().emit(std::move(event));
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+    result.latencies_ns.push_back(static_cast<uint32_t>(std::min<int64_t>(ns, UINT32_MAX)));
+}
+
+void produce(size_t id, const std::atomic<bool>& stop, ProducerResult& result) {
+    std::mt19937_64 rng(id + 1);
+    std::uniform_int_distribution<uint64_t> user(0, kUsers - 1);
+    std::normal_distribution<double> query_ms(45.0, 5.0);
+    result.latencies_ns.reserve(1 << 20);
+
+    char trace_id[32];
+    while (!stop.load(std::memory_order_relaxed)) {
+        std::snprintf(trace_id, sizeof(trace_id), "trace-%016llx",
+                      static_cast<unsigned long long>(rng()));
+        std::string user_id = "user-" + std::to_string(user(rng));
+
+        LogEvent request("api.request.received");
+        request.trace_id(trace_id)
+            .entity("user_id", user_id)
+            .context("endpoint", "/api/orders")
+            .context("method", "POST");
+        emit_timed(result, request);
+
+        LogEvent auth("auth.token.validated");
+        auth.trace_id(trace_id).entity("user_id", user_id);
+        emit_timed(result, auth);
+
+        LogEvent query("database.query.executed");
+        query.trace_id(trace_id)
+            .entity("database_name", "orders-db")
+            .metric("query_time_ms", query_ms(rng));
+        emit_timed(result, query);
+
+        LogEvent response("api.response.sent");
+        response.trace_id(trace_id).metric("status_code", 201.0);
+        emit_timed(result, response);
+    }
+}
+
+double percentile_us(std::vector<uint32_t>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t producers = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 4;
+    double seconds = argc > 2 ? std::max(std::atof(argv[2]), 0.1) : 5.0;
+    bool block = argc > 3 && std::strcmp(argv[3], "block") == 0;
+
+    Config config;
+    config.service_name = "load-generator";
+    config.log_to_console = false;
+    config.enable_anomaly_detection = true;
+    config.enable_pattern_matching = true;
+    config.enable_correlation = true;
+    config.async_queue_size = 16384;
+    // Every event of a burst is within the temporal window of the others,
+    // so correlation cost grows with what the correlator retains
+    config.correlation_max_events = 10000;
+    config.overflow_policy = block ? Config::OverflowPolicy::BLOCK : Config::OverflowPolicy::DROP_NEWEST;
+    Logger::instance().init(config);
+
+    std::atomic<bool> stop{false};
+    std::vector<ProducerResult> results(producers);
+    std::vector<std::thread> threads;
+
+    auto allocations_before = allocation_counter::now();
+    auto start = clock_type::now();
+    for (size_t i = 0; i < producers; ++i) {
+        threads.emplace_back(produce, i, std::cref(stop), std::ref(results[i]));
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double emit_seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    // Shutdown drains the queues, so the processing rate covers every event
+    auto stats_before_drain = Logger::instance().get_stats();
+    Logger::instance().shutdown();
+    double total_seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+    auto allocations_after = allocation_counter::now();
+    auto stats = Logger::instance().get_stats();
+
+    uint64_t emitted = 0;
+    std::vector<uint32_t> latencies;
+    for (auto& result : results) {
+        emitted += result.emitted;
+        latencies.insert(latencies.end(), result.latencies_ns.begin(), result.latencies_ns.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    uint64_t processed = stats.events_total - stats.events_dropped;
+
+    std::cout << "\n" << producers << " producers, " << seconds << " s, "
+              << (block ? "BLOCK" : "DROP_NEWEST") << " overflow\n"
+              << "  emitted:    " << static_cast<uint64_t>(emitted / emit_seconds) << " events/s ("
+              << emitted << " events)\n"
+              << "  processed:  " << static_cast<uint64_t>(processed / total_seconds) << " events/s ("
+              << processed << " events, " << stats.events_dropped << " dropped, "
+              << stats_before_drain.queue_depth << " queued at stop)\n"
+              << "  emit():     p50 " << percentile_us(latencies, 0.50) << " us, p99 "
+              << percentile_us(latencies, 0.99) << " us, p99.9 "
+              << percentile_us(latencies, 0.999) << " us\n"
+              << "  heap:       "
+              << static_cast<double>(allocations_after.bytes - allocations_before.bytes) / std::max<uint64_t>(emitted, 1)
+              << " bytes and "
+              << static_cast<double>(allocations_after.count - allocations_before.count) / std::max<uint64_t>(emitted, 1)
+              << " allocations per emitted event\n"
+              << "  queue wait: p50 " << stats.queue_wait.p50_us << " us, p99 " << stats.queue_wait.p99_us << " us\n"
+              << "  stage p99 per batch (us): anomaly " << stats.anomaly_stage.p99_us
+              << ", pattern " << stats.pattern_stage.p99_us
+              << ", correlation " << stats.correlation_stage.p99_us
+              << ", callbacks " << stats.callback_stage.p99_us << "\n";
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file regex_prefilter_benchmark.cpp
+ * @brief Cost of matching ~150 RegexPatterns per event, with and without
+ *        the PatternEngine literal prefilter
+ *
+ * The corpus mimics service logs: mostly request, cache and query lines,
+ * with a few percent warnings, errors and stack-trace lines. The same
+ * patterns are run once by calling every RegexPattern directly (what the
+ * engine used to do) and once through PatternEngine, which only runs the
+ * regexes whose required literals occur in the message. Both must report
+ * the same number of matches.
+ */
+
+#include <agentlog/agentlog.h>
+#include <agentlog/pattern_engine.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace agentlog;
+
+namespace {
+
+constexpr size_t kEvents = 20000;
+
+const char* kServices[] = {"payments", "orders", "inventory", "auth", "search", "billing"};
+const char* kPaths[] = {"/api/v1/orders", "/api/v1/users/42", "/healthz", "/api/v2/cart", "/login"};
+
+std::vector<std::string> make_corpus() {
+    std::mt19937 rng(7);
+    auto pick = [&](auto& items) { return items[rng() % (sizeof(items) / sizeof(items[0]))]; };
+
+    std::vector<std::string> messages;
+    messages.reserve(kEvents);
+    for (size_t i = 0; i < kEvents; ++i) {
+        unsigned roll = rng() % 100;
+        std::string ms = std::to_string(rng() % 900 + 3);
+        if (roll < 40) {
+            messages.push_back(std::string("GET ") + pick(kPaths) + " 200 " + ms + "ms user=u" +
+                               std::to_string(rng() % 5000));
+        } else if (roll < 60) {
+            messages.push_back(std::string("cache hit ratio 0.") + std::to_string(rng() % 100) +
+                               " for " + pick(kServices));
+        } else if (roll < 85) {
+            messages.push_back("SELECT * FROM orders WHERE id=" + std::to_string(rng() % 100000) +
+                               " took " + ms + "ms");
+        } else if (roll < 95) {
+            messages.push_back(std::string("slow upstream ") + pick(kServices) + " latency " + ms +
+                               "ms, retrying");
+        } else if (roll < 98) {
+            messages.push_back(std::string("Error contacting ") + pick(kServices) +
+                               ": connection refused (attempt " + std::to_string(rng() % 5) + ")");
+        } else {
+            messages.push_back("java.lang.IllegalStateException: bad state\n    at com.shop.Cart.add(Cart.java:" +
+                               std::to_string(rng() % 400) + ")");
+        }
+    }
+    return messages;
+}
+
+std::vector<std::shared_ptr<RegexPattern>> make_patterns() {
+    std::vector<std::shared_ptr<RegexPattern>> patterns;
+    patterns.push_back(PatternFactory::exception_pattern());
+
+    // Per-service and per-error-code rules, the bulk of a real rule set
+    const char* templates[] = {
+        "timeout calling %s after \\d+ms",
+        "%s: connection refused",
+        "circuit (open|half-open) for %s",
+        "%s quota exceeded",
+        "failed to publish to %s-events",
+    };
+    for (const char* service : kServices) {
+        for (const char* tmpl : templates) {
+            std::string regex(tmpl);
+            regex.replace(regex.find("%s"), 2, service);
+            patterns.push_back(std::make_shared<RegexPattern>(
+                "rule_" + std::to_string(patterns.size()), regex));
+        }
+    }
+    for (int code = 0; patterns.size() < 150; ++code) {
+        patterns.push_back(std::make_shared<RegexPattern>(
+            "code_" + std::to_string(code), "ERR-" + std::to_string(4000 + code) + "\\b"));
+    }
+    return patterns;
+}
+
+template <typename Fn>
+void run(const char* label, const std::vector<LogEventPtr>& events, Fn&& count_matches) {
+    auto start = std::chrono::steady_clock::now();
+    size_t matches = 0;
+    for (const auto& event : events) {
+        matches += count_matches(*event);
+    }
+    double us = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / events.size();
+
+    std::cout << "  " << label << ": " << us << " us/event, " << matches << " matches\n";
+}
+
+} // namespace
+
+int main() {
+    auto patterns = make_patterns();
+    std::vector<LogEventPtr> events;
+    for (auto& message : make_corpus()) {
+        LogEvent event("log.message");
+        event.message(std::move(message));
+        events.push_back(std::make_shared<const LogEvent>(std::move(event)));
+    }
+
+    PatternEngine engine;
+    for (const auto& pattern : patterns) {
+        engine.register_pattern(pattern);
+    }
+
+    std::cout << "Regex matching: " << patterns.size() << " patterns, "
+              << events.size() << " messages\n";
+
+    EventHistory context;
+    run("every regex", events, [&](const LogEvent& event) {
+        size_t n = 0;
+        for (const auto& pattern : patterns) {
+            n += pattern->match(event, context) > 0.5;
+        }
+        return n;
+    });
+
+    run("prefiltered", events, [&](const LogEvent& event) {
+        return engine.match_patterns(event, context).size();
+    });
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file remote_ingestion.cpp
+ * @brief Services shipping events to one AgentLog process over a socket
+ *
+ * Starts an IngestionServer feeding the logger, then runs each "service"
+ * on its own thread with its own IngestionClient, as separate processes
+ * on one node would. The services share trace IDs, so the correlator
+ * links their events although they never share a Logger.
+ *
+ *   remote_ingestion [services] [events per service] [address]
+ *
+ * Events are built as LogEvents, since EventBuilder cannot set a trace ID
+ * or service name. The address defaults to unix:///tmp/agentlog_ingest.sock;
+ * tcp://, udp:// and unixgram:// endpoints work as well.
+ */
+
+#include <agentlog/agentlog.h>
+#include <agentlog/ingestion.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace agentlog;
+
+int main(int argc, char** argv) {
+    size_t services = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 4;
+    size_t per_service = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 25000;
+    std::string address = argc > 3 ? argv[3] : "unix:///tmp/agentlog_ingest.sock";
+
+    Config config;
+    config.service_name = "agentlog-collector";
+    config.log_to_console = false;
+    config.enable_correlation = true;
+    config.async_queue_size = 65536;
+    // A burst puts every event in the temporal window of the others, so
+    // correlation cost grows with what the correlator retains
+    config.correlation_max_events = 10000;
+    config.overflow_policy = Config::OverflowPolicy::BLOCK;
+    Logger::instance().init(config);
+
+    IngestionServer::Config server_config;
+    server_config.listen = {address};
+    IngestionServer server(server_config);
+    if (!server.start()) {
+        return 1;
+    }
+    if (address.rfind("tcp://", 0) == 0 || address.rfind("udp://", 0) == 0) {
+        // Point the clients at the port actually bound, should it be 0
+        address = address.substr(0, address.rfind(':') + 1) + std::to_string(server.port(0));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    std::vector<IngestionClient::Stats> client_stats(services);
+    for (size_t s = 0; s < services; ++s) {
+        threads.emplace_back([&, s] {
+            IngestionClient::Config client_config;
+            client_config.address = address;
+            IngestionClient client(client_config);
+
+            std::string service = "service-" + std::to_string(s);
+            for (size_t i = 0; i < per_service; ++i) {
+                LogEvent event("request.handled");
+                event.service_name(service)
+                    .trace_id("trace-" + std::to_string(i % 1000))
+                    .entity("user_id", "user-" + std::to_string(i % 97))
+                    .metric("latency_ms", 20.0 + static_cast<double>(i % 13));
+                client.send(event);
+            }
+            client.flush();
+            client_stats[s] = client.get_stats();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double send_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Everything the clients flushed is in the kernel; wait for the server
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+    for (const auto& stats : client_stats) {
+        sent += stats.events_sent;
+        dropped += stats.events_dropped;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (server.get_stats().events_received < sent && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double receive_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    server.stop();
+    Logger::instance().shutdown();
+
+    auto server_stats = server.get_stats();
+    auto stats = Logger::instance().get_stats();
+    std::cout << "\n" << services << " services -> " << address << "\n"
+              << "  sent:       " << sent << " events (" << dropped << " dropped by clients), "
+              << static_cast<uint64_t>(sent / send_seconds) << " events/s\n"
+              << "  received:   " << server_stats.events_received << " events, "
+              << server_stats.bytes_received / (1024 * 1024) << " MiB, "
+              << static_cast<uint64_t>(server_stats.events_received / receive_seconds) << " events/s, "
+              << server_stats.records_malformed << " malformed, "
+              << server_stats.records_refused << " refused\n"
+              << "  processed:  " << stats.events_total << " events, "
+              << stats.correlations_found << " correlations\n";
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file serialization_benchmark.cpp
+ * @brief Throughput of LogEvent JSON and binary serialization
+ *
+ * Serializes the same realistic event with the std::ostringstream JSON
+ * writer LogEvent used to have, with to_json() returning a string, with
+ * to_json() appending into a reused buffer, and with the binary encoding.
+ * Reports output bytes per second and heap allocations per event, and
+ * checks that a binary record decodes back to the same JSON.
+ */
+
+#include "allocation_counter.h"
+#include <agentlog/agentlog.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace agentlog;
+
+namespace {
+
+constexpr int kIterations = 200000;
+
+// The stream-based writer LogEvent::to_json() used before (no escaping)
+std::string legacy_to_json(const LogEvent& event) {
+    std::ostringstream oss;
+    oss << "{";
+    oss << "\"event_id\":" << event.event_id() << ",";
+    oss << "\"event_type\":\"" << event.event_type() << "\",";
+    oss << "\"timestamp\":" << std::chrono::duration_cast<std::chrono::milliseconds>(
+        event.timestamp().time_since_epoch()).count() << ",";
+    oss << "\"severity\":\"" << severity_to_string(event.severity()) << "\",";
+    if (!event.message().empty()) {
+        oss << "\"message\":\"" << event.message() << "\",";
+    }
+    if (!event.service_name().empty()) {
+        oss << "\"service\":\"" << event.service_name() << "\",";
+    }
+    if (!event.trace_id().empty()) {
+        oss << "\"trace_id\":\"" << event.trace_id() << "\",";
+    }
+    if (!event.entities().empty()) {
+        oss << "\"entities\":{";
+        bool first = true;
+        for (const auto& [key, value] : event.entities()) {
+            if (!first) oss << ",";
+            oss << "\"" << key << "\":\"" << value << "\"";
+            first = false;
+        }
+        oss << "},";
+    }
+    if (!event.metrics().empty()) {
+        oss << "\"metrics\":{";
+        bool first = true;
+        for (const auto& [key, value] : event.metrics()) {
+            if (!first) oss << ",";
+            oss << "\"" << key << "\":" << value;
+            first = false;
+        }
+        oss << "},";
+    }
+    if (!event.context().empty()) {
+        oss << "\"context\":{";
+        bool first = true;
+        for (const auto& [key, value] : event.context()) {
+            if (!first) oss << ",";
+            oss << "\"" << key << "\":\"" << value << "\"";
+            first = false;
+        }
+        oss << "},";
+    }
+    oss << "\"anomaly_score\":" << event.anomaly_score();
+    oss << "}";
+    return oss.str();
+}
+
+LogEvent make_event() {
+    LogEvent event("payment.processed");
+    event.severity(Severity::WARNING)
+         .message("Payment \"ord-88812\" took longer than expected\n retrying")
+         .service_name("payment-service")
+         .service_instance("pod-7a8f9b")
+         .trace_id("4bf92f3577b34da6a3ce929d0e0e4736")
+         .entity("user_id", "user-1042")
+         .entity("order_id", "ord-88812")
+         .entity("region", "us-east")
+         .metric("latency_ms", 1234.5678)
+         .metric("amount_usd", 99.99)
+         .context("endpoint", "/api/checkout")
+         .context("method", "POST")
+         .anomaly_score(0.8125);
+    return event;
+}
+
+template<typename Fn>
+void run(const char* label, Fn&& fn) {
+    uint64_t before = allocation_counter::now().count;
+    auto start = std::chrono::steady_clock::now();
+
+    size_t bytes = 0;
+    for (int i = 0; i < kIterations; ++i) {
+        bytes += fn();
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t allocations = allocation_counter::now().count - before;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+
+    std::cout << "  " << label << ": "
+              << static_cast<double>(bytes) / seconds / (1024 * 1024) << " MB/s, "
+              << seconds * 1e9 / kIterations << " ns/event, "
+              << static_cast<double>(allocations) / kIterations << " allocations/event, "
+              << bytes / kIterations << " bytes/event\n";
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== LogEvent serialization benchmark (" << kIterations << " events) ===\n\n";
+
+    const LogEvent event = make_event();
+    std::string buffer;
+
+    run("ostringstream to_json   ", [&] { return legacy_to_json(event).size(); });
+    run("to_json() -> string     ", [&] { return event.to_json().size(); });
+    run("to_json(buffer), reused ", [&] {
+        buffer.clear();
+        event.to_json(buffer);
+        return buffer.size();
+    });
+    run("to_string(buffer)       ", [&] {
+        buffer.clear();
+        event.to_string(buffer);
+        return buffer.size();
+    });
+    run("encode_binary(buffer)   ", [&] {
+        buffer.clear();
+        event.encode_binary(buffer);
+        return buffer.size();
+    });
+
+    std::string record;
+    event.encode_binary(record);
+    run("decode_binary           ", [&] {
+        auto decoded = LogEvent::decode_binary(record);
+        return decoded ? record.size() : 0;
+    });
+
+    auto decoded = LogEvent::decode_binary(record);
+    bool round_trip = decoded && decoded->to_json() == event.to_json();
+    std::cout << "\nBinary round trip: " << (round_trip ? "OK" : "MISMATCH") << "\n";
+    return round_trip ? 0 : 1;
+}
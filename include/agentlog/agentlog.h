@@ -63,6 +63,8 @@
 // #include "agentlog/pattern_engine.h"
 // #include "agentlog/correlation_engine.h"
 // #include "agentlog/incident_manager.h"
+// #include "agentlog/storage.h"
+// #include "agentlog/ingestion.h"
 
 // Version information
 #define AGENTLOG_VERSION_MAJOR 0
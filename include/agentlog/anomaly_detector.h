@@ -5,13 +5,62 @@
 
 #include "common.h"
 #include "event.h"
+#include <algorithm>
+#include <array>
 #include <deque>
 #include <unordered_map>
 #include <mutex>
 #include <cmath>
+#include <string_view>
 
 namespace agentlog {
 
+namespace detail {
+
+// Per-key detector state is split across this many independently locked
+// shards, picked by interned id modulo the count, so workers scoring
+// different metrics or event types do not contend
+constexpr size_t kDetectorShards = 16;
+
+/**
+ * @brief Positions of a batch grouped by the shard of their key
+ *
+ * A counting sort, so each shard's positions stay in batch order and a
+ * batch takes every shard lock at most once.
+ */
+struct ShardGroups {
+    std::vector<uint32_t> order;
+    std::array<uint32_t, kDetectorShards + 1> offsets{};
+    
+    void build(const std::vector<SymbolId>& keys);
+    
+    // fn(shard, first, last) for every shard with at least one position
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t shard = 0; shard < kDetectorShards; ++shard) {
+            if (offsets[shard] != offsets[shard + 1]) {
+                fn(shard, order.data() + offsets[shard], order.data() + offsets[shard + 1]);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Metric observations of a batch flattened in event order
+ *
+ * Detectors keep one per thread so steady-state batches do not allocate.
+ */
+struct MetricBatch {
+    std::vector<SymbolId> metrics;   // Interned metric name
+    std::vector<double> values;
+    std::vector<uint32_t> owners;    // Index of the event in the batch
+    ShardGroups groups;              // Observations by metric shard
+    
+    void gather(const std::vector<const LogEvent*>& events);
+};
+
+} // namespace detail
+
 /**
  * @brief Base class for anomaly detection algorithms
  */
@@ -32,6 +81,52 @@ public:
      */
     virtual void train(const LogEvent& event) = 0;
     
+    /**
+     * @brief Score a batch of events
+     * 
+     * Every event is scored against the model as it was before the batch;
+     * overrides take their lock once per batch instead of once per event.
+     * @param events Events to analyze
+     * @param scores Receives one score per event, in order
+     */
+    virtual void score_batch(const std::vector<const LogEvent*>& events,
+                             std::vector<double>& scores);
+    
+    /**
+     * @brief Train the detector with a batch of events, in order
+     */
+    virtual void train_batch(const std::vector<const LogEvent*>& events);
+    
+    /**
+     * @brief Score an event, then train on it
+     * @return The score score() would have returned before training
+     */
+    virtual double score_and_train(const LogEvent& event);
+    
+    /**
+     * @brief score_batch() followed by train_batch() on the same events
+     * 
+     * Sharded detectors score and train each shard under a single lock
+     * acquisition instead of locking once for each step.
+     */
+    virtual void score_and_train_batch(const std::vector<const LogEvent*>& events,
+                                       std::vector<double>& scores);
+    
+    /**
+     * @brief Append the learned model to @p out
+     * 
+     * The encoding is private to each detector and keys metrics and event
+     * types by name, so it can be restored in another process. Stateless
+     * detectors append nothing.
+     */
+    virtual void serialize_state(std::string& /*out*/) const {}
+    
+    /**
+     * @brief Replace the learned model with one from serialize_state()
+     * @return false if @p data is malformed; the model is then left empty
+     */
+    virtual bool restore_state(std::string_view /*data*/) { return true; }
+    
     /**
      * @brief Get detector name
      */
@@ -51,22 +146,51 @@ public:
     
     double score(const LogEvent& event) override;
     void train(const LogEvent& event) override;
+    void score_batch(const std::vector<const LogEvent*>& events,
+                     std::vector<double>& scores) override;
+    void train_batch(const std::vector<const LogEvent*>& events) override;
+    void serialize_state(std::string& out) const override;
+    bool restore_state(std::string_view data) override;
+    double score_and_train(const LogEvent& event) override;
+    void score_and_train_batch(const std::vector<const LogEvent*>& events,
+                               std::vector<double>& scores) override;
     std::string name() const override { return "z_score"; }
     
 private:
-    struct Stats {
-        double mean{0.0};
-        double m2{0.0};  // Sum of squared differences
-        uint64_t count{0};
+    // A batch flattened for the kernel, with each observation's stats
+    // gathered next to it
+    struct Scratch {
+        detail::MetricBatch batch;
+        std::vector<double> means, m2s, counts, contributions;
+    };
+    
+    static constexpr uint32_t kNoSlot = 0;
+    
+    // Welford state of the metrics in one shard as structure-of-arrays,
+    // indexed by slot (slot 0 is a permanent empty entry), so scoring
+    // gathers plain doubles for the SIMD kernel without a string hash per
+    // metric. Counts are doubles to feed the kernel directly; they stay
+    // exact below 2^53.
+    struct alignas(64) Shard {
+        std::vector<double> means{0.0};
+        std::vector<double> m2s{0.0};     // Sum of squared differences
+        std::vector<double> counts{0.0};
+        std::vector<SymbolId> slot_metric{0};
+        std::vector<uint32_t> slot_by_metric;  // SymbolId / kDetectorShards -> slot
+        mutable std::mutex mutex;
         
-        double stddev() const {
-            return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0;
-        }
+        uint32_t slot_of(SymbolId metric) const;  // kNoSlot if untracked
+        uint32_t add_slot(SymbolId metric);
+        void clear();
     };
     
-    std::unordered_map<std::string, Stats> metric_stats_;
+    // Score (when scores is set) and/or train on a batch, visiting each
+    // shard once
+    void run_batch(const std::vector<const LogEvent*>& events,
+                   std::vector<double>* scores, bool train);
+    
+    std::array<Shard, detail::kDetectorShards> shards_;
     double threshold_;
-    mutable std::mutex mutex_;
 };
 
 /**
@@ -76,24 +200,68 @@ private:
  */
 class MovingAverageDetector : public AnomalyDetector {
 public:
-    explicit MovingAverageDetector(size_t window_size = 100, double threshold = 2.5)
-        : window_size_(window_size)
-        , threshold_(threshold) {}
+    /**
+     * @brief How the spread of the window is measured
+     */
+    enum class Dispersion {
+        MEAN_ABSOLUTE_DEVIATION,  // Exact MAD, O(window) per metric scored
+        STREAMING_STDDEV          // Running stddev scaled to MAD, O(1) per metric
+    };
+    
+    explicit MovingAverageDetector(size_t window_size = 100, double threshold = 2.5,
+                                   Dispersion dispersion = Dispersion::MEAN_ABSOLUTE_DEVIATION)
+        : window_size_(std::max<size_t>(window_size, 1))
+        , threshold_(threshold)
+        , dispersion_(dispersion) {}
     
     double score(const LogEvent& event) override;
     void train(const LogEvent& event) override;
+    void score_batch(const std::vector<const LogEvent*>& events,
+                     std::vector<double>& scores) override;
+    void train_batch(const std::vector<const LogEvent*>& events) override;
+    void serialize_state(std::string& out) const override;
+    bool restore_state(std::string_view data) override;
+    double score_and_train(const LogEvent& event) override;
+    void score_and_train_batch(const std::vector<const LogEvent*>& events,
+                               std::vector<double>& scores) override;
     std::string name() const override { return "moving_average"; }
     
 private:
+    // The last window_size values of one metric in a ring buffer, with the
+    // window's mean and sum of squared deviations kept up to date on every
+    // push. The sliding update accumulates rounding error, so the
+    // statistics are recomputed exactly once per window of pushes.
     struct History {
-        std::deque<double> values;
-        double sum{0.0};
+        std::vector<double> values;  // Ring; oldest at head once full
+        size_t head{0};
+        double mean{0.0};
+        double m2{0.0};
+        size_t pushes_since_refresh{0};
+        
+        void push(double value, size_t window_size);
+        void refresh();
+        
+        template <typename Fn>
+        void for_each(Fn&& fn) const {
+            for (size_t i = 0; i < values.size(); ++i) {
+                fn(values[(head + i) % values.size()]);
+            }
+        }
+    };
+    
+    struct alignas(64) Shard {
+        std::unordered_map<SymbolId, History> histories;  // Keyed by interned metric
+        mutable std::mutex mutex;
     };
     
-    std::unordered_map<std::string, History> metric_history_;
+    double metric_score(const History& history, double value) const;
+    void run_batch(const std::vector<const LogEvent*>& events,
+                   std::vector<double>* scores, bool train);
+    
+    std::array<Shard, detail::kDetectorShards> shards_;
     size_t window_size_;
     double threshold_;
-    mutable std::mutex mutex_;
+    Dispersion dispersion_;
 };
 
 /**
@@ -108,6 +276,14 @@ public:
     
     double score(const LogEvent& event) override;
     void train(const LogEvent& event) override;
+    void score_batch(const std::vector<const LogEvent*>& events,
+                     std::vector<double>& scores) override;
+    void train_batch(const std::vector<const LogEvent*>& events) override;
+    void serialize_state(std::string& out) const override;
+    bool restore_state(std::string_view data) override;
+    double score_and_train(const LogEvent& event) override;
+    void score_and_train_batch(const std::vector<const LogEvent*>& events,
+                               std::vector<double>& scores) override;
     std::string name() const override { return "rate"; }
     
 private:
@@ -116,9 +292,22 @@ private:
         double baseline_rate{0.0};
     };
     
-    std::unordered_map<std::string, RateStats> event_rates_;
+    struct alignas(64) Shard {
+        std::unordered_map<SymbolId, RateStats> event_rates;  // Keyed by interned event type
+        mutable std::mutex mutex;
+    };
+    
+    double score_locked(RateStats& rate_stats, const LogEvent& event) const;
+    void train_locked(RateStats& rate_stats, const LogEvent& event) const;
+    void run_batch(const std::vector<const LogEvent*>& events,
+                   std::vector<double>* scores, bool train);
+    
+    Shard& shard_for(SymbolId event_type) {
+        return shards_[event_type % detail::kDetectorShards];
+    }
+    
+    std::array<Shard, detail::kDetectorShards> shards_;
     duration_t window_duration_;
-    mutable std::mutex mutex_;
 };
 
 /**
@@ -142,9 +331,19 @@ public:
     
     double score(const LogEvent& event) override;
     void train(const LogEvent& event) override;
+    void score_batch(const std::vector<const LogEvent*>& events,
+                     std::vector<double>& scores) override;
+    void train_batch(const std::vector<const LogEvent*>& events) override;
+    void serialize_state(std::string& out) const override;
+    bool restore_state(std::string_view data) override;
+    double score_and_train(const LogEvent& event) override;
+    void score_and_train_batch(const std::vector<const LogEvent*>& events,
+                               std::vector<double>& scores) override;
     std::string name() const override { return "ensemble"; }
     
 private:
+    double combine(const std::vector<double>& scores) const;
+    
     struct DetectorInfo {
         std::shared_ptr<AnomalyDetector> detector;
         double weight;
@@ -161,7 +360,9 @@ class DetectorFactory {
 public:
     static std::shared_ptr<AnomalyDetector> create_default();
     static std::shared_ptr<AnomalyDetector> create_z_score(double threshold = 3.0);
-    static std::shared_ptr<AnomalyDetector> create_moving_average(size_t window = 100);
+    static std::shared_ptr<AnomalyDetector> create_moving_average(
+        size_t window = 100,
+        MovingAverageDetector::Dispersion dispersion = MovingAverageDetector::Dispersion::MEAN_ABSOLUTE_DEVIATION);
     static std::shared_ptr<AnomalyDetector> create_rate(std::chrono::seconds window = std::chrono::seconds(60));
     static std::shared_ptr<AnomalyDetector> create_ensemble();
 };
@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include "flat_map.h"
+#include "symbol_table.h"
 #include <chrono>
+#include <deque>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -55,10 +58,13 @@ enum class EntityType {
 
 // Metric types
 using MetricValue = double;
-using MetricMap = std::map<std::string, MetricValue>;
+using MetricMap = FlatMap<std::string, MetricValue>;
 
-// Context types
-using ContextMap = std::map<std::string, std::string>;
+// Context types (contiguous sorted storage, see flat_map.h)
+using ContextMap = FlatMap<std::string, std::string>;
+
+// Entities are keyed by interned names (see symbol_table.h)
+using EntityMap = FlatMap<Symbol, std::string>;
 
 // Stack trace frame
 struct StackFrame {
@@ -81,13 +87,18 @@ class AnomalyDetector;
 class PatternEngine;
 class CorrelationEngine;
 class IncidentManager;
+class EventStore;
 
 // Smart pointers
-using LogEventPtr = std::shared_ptr<LogEvent>;
+using LogEventPtr = std::shared_ptr<const LogEvent>;  // Immutable once published
 using LoggerPtr = std::shared_ptr<Logger>;
 using AnomalyDetectorPtr = std::shared_ptr<AnomalyDetector>;
 using PatternEnginePtr = std::shared_ptr<PatternEngine>;
 using CorrelationEnginePtr = std::shared_ptr<CorrelationEngine>;
 using IncidentManagerPtr = std::shared_ptr<IncidentManager>;
+using EventStorePtr = std::shared_ptr<EventStore>;
+
+// Recent events shared between the logger and its analysis engines
+using EventHistory = std::deque<LogEventPtr>;
 
 } // namespace agentlog
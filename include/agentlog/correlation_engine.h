@@ -5,19 +5,118 @@
 
 #include "common.h"
 #include "event.h"
+#include <cstddef>
 #include <deque>
+#include <iterator>
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 #include <mutex>
 #include <memory>
+#include <string_view>
 
 namespace agentlog {
 
+namespace detail {
+
+// Fixed-capacity block of an append-only id list. Slots are written once,
+// before any view covering them is handed out, and next is set before a
+// view can extend past this block, so views read without a lock.
+struct IdChunk {
+    explicit IdChunk(size_t cap)
+        : ids(new uint64_t[cap])
+        , capacity(cap) {}
+    
+    std::unique_ptr<uint64_t[]> ids;
+    size_t capacity;
+    std::shared_ptr<IdChunk> next;
+};
+
+} // namespace detail
+
+/**
+ * @brief Read-only sequence of the event ids in a correlation
+ * 
+ * Correlations point into the correlator's shared, append-only id lists:
+ * the membership list of a trace ID or entity value, or the time buckets
+ * of a service or of the whole stream. A correlation over a hot key or a
+ * busy window so costs a few words per list rather than a copy of every
+ * id. A view can span several lists (an event sharing more than one entity
+ * value); an id in two of them is then visited twice.
+ */
+class EventIdView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint64_t*;
+        using reference = const uint64_t&;
+        
+        const_iterator() = default;
+        
+        reference operator*() const { return chunk_->ids[pos_]; }
+        pointer operator->() const { return &chunk_->ids[pos_]; }
+        const_iterator& operator++();
+        const_iterator operator++(int) { auto old = *this; ++*this; return old; }
+        
+        bool operator==(const const_iterator& other) const {
+            return chunk_ == other.chunk_ && pos_ == other.pos_ && segment_ == other.segment_;
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+        
+    private:
+        friend class EventIdView;
+        
+        const_iterator(const EventIdView* view, size_t segment);
+        void enter_segment();
+        
+        const EventIdView* view_{nullptr};
+        size_t segment_{0};
+        const detail::IdChunk* chunk_{nullptr};
+        size_t pos_{0};
+        size_t remaining_{0};  // Ids left in the current segment, this one included
+    };
+    
+    EventIdView() = default;
+    
+    // Owning view over a private copy of @p ids
+    explicit EventIdView(const std::vector<uint64_t>& ids);
+    
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    uint64_t front() const { return *begin(); }
+    
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, segments_.size()); }
+    
+    bool contains(uint64_t id) const;
+    std::vector<uint64_t> to_vector() const;
+    
+private:
+    friend class EventCorrelator;
+    
+    struct Segment {
+        std::shared_ptr<const detail::IdChunk> chunk;
+        size_t offset;  // First id within chunk
+        size_t count;   // Ids in the segment, possibly continuing into later chunks
+    };
+    
+    void append(Segment segment);
+    
+    std::vector<Segment> segments_;
+    size_t size_{0};
+};
+
 /**
  * @brief Represents a correlation between events
+ * 
+ * Published as an immutable CorrelationPtr that the correlator, its
+ * per-event index and every caller share.
  */
 struct Correlation {
-    std::vector<uint64_t> event_ids;      // IDs of correlated events
+    EventIdView event_ids;                 // IDs of correlated events
     std::string correlation_type;          // Type of correlation
     double confidence;                     // Confidence score 0.0-1.0
     std::string reason;                    // Why these events are correlated
@@ -28,63 +127,204 @@ struct Correlation {
     std::unordered_map<std::string, std::string> metadata;
 };
 
+using CorrelationPtr = std::shared_ptr<const Correlation>;
+
+/**
+ * @brief Retention limits for EventCorrelator
+ */
+struct EventCorrelatorConfig {
+    // Events and correlations this much older than the newest event seen
+    // are expired a few at a time as new events arrive
+    duration_t max_age{std::chrono::hours(1)};
+    size_t expire_batch{32};          // Max aged-out events evicted per correlate()
+    
+    // Timestamps are the producer's. One stamped further ahead of the wall
+    // clock than this still advances the expiry watermark only to
+    // now + max_clock_skew, so a skewed clock cannot age out everything else
+    duration_t max_clock_skew{std::chrono::seconds(5)};
+    
+    // Hard caps; the oldest entries are evicted immediately beyond these
+    size_t max_events{100000};
+    size_t max_correlations{100000};
+};
+
 /**
  * @brief Correlates events across services using various strategies
  */
 class EventCorrelator {
 public:
-    EventCorrelator() = default;
+    using Config = EventCorrelatorConfig;
+    
+    explicit EventCorrelator(Config config = Config())
+        : config_(std::move(config)) {}
     
     /**
      * @brief Add event and find correlations
      * @return Vector of correlations found
      */
-    std::vector<Correlation> correlate(const LogEvent& event);
+    std::vector<CorrelationPtr> correlate(const LogEvent& event);
     
     /**
-     * @brief Get all correlations involving a specific event
+     * @brief Add a shared event without copying it
      */
-    std::vector<Correlation> get_correlations_for_event(uint64_t event_id) const;
+    std::vector<CorrelationPtr> correlate(const LogEventPtr& event);
+    
+    /**
+     * @brief Add a batch of events, in order, under a single lock
+     * @return One vector of correlations per event
+     */
+    std::vector<std::vector<CorrelationPtr>> correlate_batch(
+        const std::vector<LogEventPtr>& events);
+    
+    /**
+     * @brief Get the correlations involving a retained event
+     * 
+     * Returns the correlations found when the event arrived plus, for each
+     * trace ID and entity value it shares, the most recent (and so largest)
+     * correlation over that key. O(1) in the number of retained events.
+     */
+    std::vector<CorrelationPtr> get_correlations_for_event(uint64_t event_id) const;
     
     /**
      * @brief Get all active correlations
      */
-    std::vector<Correlation> get_active_correlations() const;
+    std::vector<CorrelationPtr> get_active_correlations() const;
     
     /**
      * @brief Clear old correlations (cleanup)
+     * 
+     * Expiry normally happens incrementally inside correlate(); this drops
+     * everything older than @p max_age relative to the wall clock at once.
      */
     void cleanup(duration_t max_age = std::chrono::hours(1));
     
+    /**
+     * @brief Number of events currently retained
+     */
+    size_t event_count() const;
+    
 private:
     struct EventRecord {
-        LogEvent event;
-        std::vector<size_t> correlation_indices;
+        LogEventPtr event;
+        std::vector<CorrelationPtr> correlations;  // Found when the event arrived
     };
     
-    // Find correlations by trace ID
-    std::optional<Correlation> correlate_by_trace_id(const LogEvent& event);
+    using EventMap = std::unordered_map<uint64_t, EventRecord>;
+    
+    // Ids in arrival order, kept in chunks of growing capacity that the
+    // views handed out share. Evicted ids normally leave from the front;
+    // one evicted out of order stays in place, counted as dead, until the
+    // dead outnumber the live and the list is rebuilt from the live ids.
+    class IdList {
+    public:
+        void push_back(uint64_t id);
+        void pop_front();
+        uint64_t front() const { return chunks_.front()->ids[head_]; }
+        size_t size() const { return size_; }  // Dead ids included
+        bool empty() const { return size_ == 0; }
+        
+        // Drop an id whose event has already left @p live
+        void remove(uint64_t id, const EventMap& live);
+        
+        // The first @p count members, sharing this list's storage
+        EventIdView::Segment prefix(size_t count) const;
+        
+        CorrelationPtr latest;  // Most recent correlation over this list
+        
+    private:
+        // Rebuild from the ids still in @p live; views keep the old chunks
+        void compact(const EventMap& live);
+        
+        std::deque<std::shared_ptr<detail::IdChunk>> chunks_;
+        size_t head_{0};   // Offset of the first member in chunks_.front()
+        size_t tail_{0};   // Ids used in chunks_.back()
+        size_t size_{0};
+        size_t dead_{0};   // Evicted ids not yet dropped
+    };
+    
+    // Event ids grouped into fixed-width time buckets, each an IdList, so
+    // a window query only touches the buckets overlapping the window and
+    // its correlation shares their storage instead of copying the ids.
+    class TimeIndex {
+    public:
+        static constexpr duration_t kBucketWidth = std::chrono::seconds(1);
+        
+        void insert(timestamp_t timestamp, uint64_t id);
+        
+        // Drop an evicted id from the bucket of @p timestamp
+        void remove(timestamp_t timestamp, uint64_t id, const EventMap& live);
+        
+        // Id at the front of the oldest bucket. Buckets hold ids in arrival
+        // order, so this is the oldest id only to within a bucket width.
+        uint64_t oldest() const { return buckets_.begin()->second.front(); }
+        void pop_oldest();
+        
+        // Append one segment per bucket overlapping [from, to], oldest
+        // first. Buckets are taken whole, so the window is widened to
+        // bucket boundaries.
+        void window(timestamp_t from, timestamp_t to, EventIdView& out) const;
+        
+        bool empty() const { return buckets_.empty(); }
+        
+    private:
+        static int64_t bucket_of(timestamp_t timestamp);
+        
+        std::map<int64_t, IdList> buckets_;
+    };
+    
+    std::vector<CorrelationPtr> correlate_locked(const LogEventPtr& event);
+    
+    // Add an already-stored event to the lookup indexes
+    void index_event(uint64_t id, const LogEvent& event);
+    
+    // Evict events and correlations past max_age or the hard caps; at most
+    // @p budget events are evicted for age alone
+    void expire_locked(timestamp_t cutoff, size_t budget);
     
-    // Find correlations by entity matching
-    std::optional<Correlation> correlate_by_entities(const LogEvent& event);
+    // Drop one event from events_ and every index
+    void evict_oldest_event();
     
-    // Find correlations by service relationships
-    std::optional<Correlation> correlate_by_service(const LogEvent& event);
+    // Find correlations by trace ID; runs after the event is indexed
+    CorrelationPtr correlate_by_trace_id(const LogEvent& event);
     
-    // Find correlations by temporal proximity
-    std::optional<Correlation> correlate_by_time(const LogEvent& event);
+    // Find correlations by entity matching; runs after the event is indexed
+    CorrelationPtr correlate_by_entities(const LogEvent& event);
     
-    std::unordered_map<uint64_t, EventRecord> events_;
-    std::vector<Correlation> correlations_;
+    // Find correlations by service relationships; runs after the event is indexed
+    CorrelationPtr correlate_by_service(const LogEvent& event);
     
-    // Index structures for fast lookup
-    std::unordered_map<std::string, std::vector<uint64_t>> trace_id_index_;
-    std::unordered_map<std::string, std::vector<uint64_t>> entity_index_;
-    std::unordered_map<std::string, std::vector<uint64_t>> service_index_;
+    // Find correlations by temporal proximity; runs after the event is indexed
+    CorrelationPtr correlate_by_time(const LogEvent& event);
+    
+    Config config_;
+    EventMap events_;
+    std::deque<CorrelationPtr> correlations_;  // Appended as found, so roughly time-ordered
+    timestamp_t newest_{};                  // Latest event timestamp seen, clamped to the wall clock
+    
+    // Index structures for fast lookup. Trace IDs and entity values are
+    // unbounded, so rather than being interned they are keyed by a 64-bit
+    // hash (see index_key()); services are keyed by their interned id and
+    // ordered by time like time_index_.
+    std::unordered_map<uint64_t, IdList> trace_id_index_;
+    std::unordered_map<uint64_t, IdList> entity_index_;
+    std::unordered_map<SymbolId, TimeIndex> service_index_;
+    TimeIndex time_index_;
     
     mutable std::mutex mutex_;
 };
 
+/**
+ * @brief Learning parameters for CausalityAnalyzer
+ */
+struct CausalityAnalyzerConfig {
+    // An event is linked to every event type seen at most this long before it
+    duration_t window{std::chrono::seconds(60)};
+    
+    // Observations lose half their weight over this much event time, so
+    // strengths follow the current behaviour of the system
+    duration_t half_life{std::chrono::hours(1)};
+};
+
 /**
  * @brief Analyzes causality relationships between events
  * 
@@ -92,9 +332,17 @@ private:
  * - A causes B (e.g., database slow → API timeout)
  * - A prevents B (e.g., circuit breaker → no downstream calls)
  * - A enables B (e.g., auth success → protected resource access)
+ * 
+ * Learning is incremental: the analyzer keeps the last time each event
+ * type was seen, so an event costs work proportional to the distinct
+ * types seen within the window rather than to the history. A learned
+ * strength is the time-decayed fraction of the cause's occurrences that
+ * were followed by the effect within the window.
  */
 class CausalityAnalyzer {
 public:
+    using Config = CausalityAnalyzerConfig;
+    
     enum class CausalityType {
         CAUSES,      // A causes B
         PREVENTS,    // A prevents B
@@ -113,20 +361,35 @@ public:
         std::string description() const;
     };
     
-    CausalityAnalyzer() = default;
+    explicit CausalityAnalyzer(Config config = Config())
+        : config_(std::move(config)) {}
     
     /**
      * @brief Analyze event for causal relationships
+     * 
+     * Returns the known relationships whose cause type was learned within
+     * the window before @p event. @p context is not scanned.
      */
     std::vector<CausalRelationship> analyze(
         const LogEvent& event,
-        const std::deque<LogEvent>& context
+        const EventHistory& context
     );
     
     /**
      * @brief Learn causal relationships from event stream
+     * 
+     * Events must be learned in stream order; each is linked to the types
+     * learned before it within the window, so @p context is not scanned.
+     */
+    void learn(const LogEvent& event, const EventHistory& context);
+    
+    /**
+     * @brief Learn from a batch of events under a single lock
+     * 
+     * Same as learn() for each event in order; @p context is unchanged.
      */
-    void learn(const LogEvent& event, const std::deque<LogEvent>& context);
+    void learn_batch(const std::vector<LogEventPtr>& events,
+                     EventHistory& context);
     
     /**
      * @brief Get all known causal relationships
@@ -138,10 +401,44 @@ public:
      */
     void register_relationship(const CausalRelationship& rel);
     
+    /**
+     * @brief Append every known relationship to @p out
+     */
+    void serialize_state(std::string& out) const;
+    
+    /**
+     * @brief Merge relationships from serialize_state() into the known set
+     * 
+     * A restored relationship replaces any known one for the same
+     * cause/effect pair, so learned strengths win over built-in defaults.
+     * @return false if @p data is malformed; nothing is merged then
+     */
+    bool restore_state(std::string_view data);
+    
 private:
+    void learn_locked(const LogEvent& event);
+    
+    
+    // A weight decaying by half every config_.half_life of event time
+    struct Decayed {
+        double weight{0.0};
+        timestamp_t updated{};
+        
+        void add(timestamp_t now, duration_t half_life);
+        double at(timestamp_t now, duration_t half_life) const;
+    };
+    
+    // Latest occurrence of an event type still inside the window
+    struct RecentType {
+        Symbol type;
+        timestamp_t last_seen;
+        uint64_t last_event_id;
+    };
+    
+    // Interned cause/effect event types
     struct EventPair {
-        std::string cause_type;
-        std::string effect_type;
+        SymbolId cause_type;
+        SymbolId effect_type;
         
         bool operator==(const EventPair& other) const {
             return cause_type == other.cause_type && effect_type == other.effect_type;
@@ -150,12 +447,29 @@ private:
     
     struct EventPairHash {
         size_t operator()(const EventPair& pair) const {
-            return std::hash<std::string>()(pair.cause_type) ^
-                   (std::hash<std::string>()(pair.effect_type) << 1);
+            return std::hash<uint64_t>()(
+                (static_cast<uint64_t>(pair.cause_type) << 32) | pair.effect_type);
         }
     };
     
-    std::unordered_map<EventPair, CausalRelationship, EventPairHash> relationships_;
+    // A relationship with the evidence behind its learned strength:
+    // followed counts cause occurrences with the effect after them, at
+    // most once per occurrence, so followed <= the cause's occurrences
+    struct Learned {
+        CausalRelationship rel;
+        Decayed followed;
+        timestamp_t credited{};  // Cause occurrence followed last counted
+        double prior{0.1};       // Strength before any evidence
+    };
+    
+    // rel with its strength as of the newest event learned
+    CausalRelationship current(const EventPair& pair, const Learned& learned) const;
+    
+    Config config_;
+    timestamp_t latest_{};                                // Newest event learned
+    std::vector<RecentType> recent_;                      // Unordered; pruned as scanned
+    std::unordered_map<SymbolId, Decayed> occurrences_;   // Per cause type
+    std::unordered_map<EventPair, Learned, EventPairHash> relationships_;
     mutable std::mutex mutex_;
 };
 
@@ -186,6 +500,15 @@ public:
     ) : correlator_(std::move(correlator))
       , causality_(std::move(causality)) {}
     
+    /**
+     * @brief Search this store for events the in-memory correlator no
+     * longer holds (see find_root_cause_for_event)
+     */
+    void set_event_store(EventStorePtr store, duration_t lookback = std::chrono::minutes(10)) {
+        store_ = std::move(store);
+        store_lookback_ = lookback;
+    }
+    
     /**
      * @brief Analyze correlation to find root cause
      */
@@ -193,15 +516,23 @@ public:
     
     /**
      * @brief Find root cause for a specific problematic event
+     * 
+     * Falls back to the event store, if one is set, when the correlator has
+     * nothing for the event: earlier events on the same trace within the
+     * lookback window are read back from disk.
      */
     std::optional<RootCause> find_root_cause_for_event(
         uint64_t event_id,
-        const std::deque<LogEvent>& context
+        const EventHistory& context
     );
     
 private:
+    std::optional<Correlation> correlate_from_store(uint64_t event_id) const;
+    
     std::shared_ptr<EventCorrelator> correlator_;
     std::shared_ptr<CausalityAnalyzer> causality_;
+    EventStorePtr store_;
+    duration_t store_lookback_{std::chrono::minutes(10)};
 };
 
 /**
@@ -209,15 +540,27 @@ private:
  */
 class CorrelationEngine {
 public:
-    CorrelationEngine()
-        : correlator_(std::make_shared<EventCorrelator>())
+    explicit CorrelationEngine(EventCorrelator::Config correlator_config = EventCorrelator::Config())
+        : correlator_(std::make_shared<EventCorrelator>(std::move(correlator_config)))
         , causality_(std::make_shared<CausalityAnalyzer>())
         , root_cause_(std::make_shared<RootCauseAnalyzer>(correlator_, causality_)) {}
     
     /**
      * @brief Process event and find correlations
      */
-    void process(const LogEvent& event, const std::deque<LogEvent>& context);
+    void process(const LogEvent& event, const EventHistory& context);
+    
+    /**
+     * @brief Process a batch of events in order
+     * 
+     * Correlates every event once and learns causality against @p context
+     * (see CausalityAnalyzer::learn_batch).
+     * @return One vector of correlations per event
+     */
+    std::vector<std::vector<CorrelationPtr>> process_batch(
+        const std::vector<LogEventPtr>& events,
+        EventHistory& context
+    );
     
     /**
      * @brief Get correlator
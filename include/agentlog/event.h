@@ -5,12 +5,35 @@
 
 #include "common.h"
 #include <atomic>
+#include <limits>
 #include <optional>
 #include <sstream>
+#include <string_view>
 #include <utility>
 
 namespace agentlog {
 
+/**
+ * @brief How LogEvent::decode_binary() adopts a record
+ *
+ * The defaults suit records this process wrote itself (event store, spill).
+ * Records from another process need a fresh event_id, as every process
+ * numbers its events from 0, and a bound on the names they may intern, as
+ * interned strings are never freed.
+ */
+struct DecodeOptions {
+    bool fresh_id{false};  // Replace the sender's event_id with a new local one
+    
+    // Refuse a record whose event type, service name, entity keys or metric
+    // names would grow the SymbolTable to more than this many strings
+    size_t max_symbols{std::numeric_limits<size_t>::max()};
+};
+
+enum class DecodeError {
+    MALFORMED,     // Truncated or invalid record
+    SYMBOL_LIMIT   // Refused for DecodeOptions::max_symbols
+};
+
 /**
  * @brief Structured semantic log event with rich metadata
  * 
@@ -30,8 +53,8 @@ public:
         , event_id_(generate_id())
     {}
     
-    explicit LogEvent(std::string event_type)
-        : event_type_(std::move(event_type))
+    explicit LogEvent(std::string_view event_type)
+        : event_type_(event_type)
         , timestamp_(std::chrono::system_clock::now())
         , severity_(Severity::INFO)
         , anomaly_score_(0.0)
@@ -39,8 +62,13 @@ public:
     {}
     
     // Fluent API for building events
-    LogEvent& event_type(std::string type) {
-        event_type_ = std::move(type);
+    LogEvent& event_type(std::string_view type) {
+        event_type_ = Symbol(type);
+        return *this;
+    }
+    
+    LogEvent& event_type(Symbol type) {
+        event_type_ = type;
         return *this;
     }
     
@@ -49,26 +77,37 @@ public:
         return *this;
     }
     
+    // Defaults to construction time; set for events timed elsewhere
+    LogEvent& timestamp(timestamp_t ts) {
+        timestamp_ = ts;
+        return *this;
+    }
+    
     LogEvent& message(std::string msg) {
         message_ = std::move(msg);
         return *this;
     }
     
     // Add structured entity
-    LogEvent& entity(const std::string& name, const std::string& value) {
-        entities_[name] = value;
+    LogEvent& entity(std::string_view name, const std::string& value) {
+        entities_.insert_or_assign(Symbol(name), value);
+        return *this;
+    }
+    
+    LogEvent& entity(Symbol name, const std::string& value) {
+        entities_.insert_or_assign(name, value);
         return *this;
     }
     
     // Add numeric metric
     LogEvent& metric(const std::string& name, MetricValue value) {
-        metrics_[name] = value;
+        metrics_.insert_or_assign(name, value);
         return *this;
     }
     
     // Add context information
     LogEvent& context(const std::string& key, const std::string& value) {
-        context_[key] = value;
+        context_.insert_or_assign(key, value);
         return *this;
     }
     
@@ -84,9 +123,15 @@ public:
         return *this;
     }
     
-    // Capture stack trace
+    // Capture stack trace. Only the return addresses are recorded here;
+    // the worker resolves them into stack_trace() before analysis, through
+    // a process-wide cache, and encode_binary() resolves any still pending.
     LogEvent& capture_stack_trace(size_t max_frames = 32);
     
+    // Resolve captured addresses into stack_trace() now
+    LogEvent& symbolize_stack_trace();
+    bool has_unresolved_stack_trace() const { return !stack_addresses_.empty(); }
+    
     // Capture local variables (implementation-specific)
     template<typename... Args>
     LogEvent& capture_variables(Args&&... args) {
@@ -95,8 +140,8 @@ public:
     }
     
     // Service identification
-    LogEvent& service_name(std::string name) {
-        service_name_ = std::move(name);
+    LogEvent& service_name(std::string_view name) {
+        service_name_ = Symbol(name);
         return *this;
     }
     
@@ -133,16 +178,18 @@ public:
     }
     
     // Getters
-    const std::string& event_type() const { return event_type_; }
+    const std::string& event_type() const { return event_type_.str(); }
+    Symbol event_type_symbol() const { return event_type_; }
     timestamp_t timestamp() const { return timestamp_; }
     Severity severity() const { return severity_; }
     const std::string& message() const { return message_; }
-    const ContextMap& entities() const { return entities_; }
+    const EntityMap& entities() const { return entities_; }
     const MetricMap& metrics() const { return metrics_; }
     const ContextMap& context() const { return context_; }
     const std::vector<std::string>& tags() const { return tags_; }
     const StackTrace& stack_trace() const { return stack_trace_; }
-    const std::string& service_name() const { return service_name_; }
+    const std::string& service_name() const { return service_name_.str(); }
+    Symbol service_symbol() const { return service_name_; }
     const std::string& trace_id() const { return trace_id_; }
     const std::string& span_id() const { return span_id_; }
     double anomaly_score() const { return anomaly_score_; }
@@ -154,31 +201,66 @@ public:
         return anomaly_score_ >= threshold;
     }
     
-    // Serialization (for storage/transmission)
+    // Serialization (for storage/transmission). The overloads taking a
+    // buffer append to it, so a buffer reused across events stops
+    // allocating once it has grown to the largest event.
     std::string to_json() const;
     std::string to_string() const;
+    void to_json(std::string& out) const;
+    void to_string(std::string& out) const;
+    
+    // Compact length-prefixed binary encoding (layout in event.cpp).
+    // decode_binary() reads one record from the front of data, reports its
+    // size through consumed, and returns nullopt, with the reason in error,
+    // if the record is truncated, malformed or refused under options.
+    void encode_binary(std::string& out) const;
+    static std::optional<LogEvent> decode_binary(std::string_view data, size_t* consumed = nullptr,
+                                                 const DecodeOptions& options = DecodeOptions(),
+                                                 DecodeError* error = nullptr);
+    
+    // Ids count up from 0 in every process. A store reopened from an
+    // earlier run calls this with the largest id it recovered, so new
+    // events cannot take the ids of stored ones.
+    static void skip_ids_through(uint64_t id) {
+        uint64_t next = id_counter().load(std::memory_order_relaxed);
+        while (next <= id &&
+               !id_counter().compare_exchange_weak(next, id + 1, std::memory_order_relaxed)) {}
+    }
     
 private:
-    static uint64_t generate_id() {
+    struct DecodeTag {};
+    explicit LogEvent(DecodeTag)
+        : severity_(Severity::INFO)
+        , anomaly_score_(0.0)
+        , event_id_(0)
+    {}
+    
+
+    static std::atomic<uint64_t>& id_counter() {
         static std::atomic<uint64_t> counter{0};
-        return counter.fetch_add(1, std::memory_order_relaxed);
+        return counter;
+    }
+    
+    static uint64_t generate_id() {
+        return id_counter().fetch_add(1, std::memory_order_relaxed);
     }
     
     // Core fields
-    std::string event_type_;
+    Symbol event_type_;        // Interned
     timestamp_t timestamp_;
     Severity severity_;
     std::string message_;
     
     // Structured data
-    ContextMap entities_;      // Semantic entities
+    EntityMap entities_;       // Semantic entities
     MetricMap metrics_;        // Numeric metrics
     ContextMap context_;       // Additional context
     std::vector<std::string> tags_;
     StackTrace stack_trace_;
+    std::vector<uintptr_t> stack_addresses_;  // Captured, not yet symbolized
     
     // Service info
-    std::string service_name_;
+    Symbol service_name_;      // Interned
     std::string service_instance_;
     
     // Distributed tracing
@@ -199,10 +281,10 @@ private:
  */
 class EventBuilder {
 public:
-    explicit EventBuilder(std::string event_type)
-        : event_(std::move(event_type)) {}
+    explicit EventBuilder(std::string_view event_type)
+        : event_(event_type) {}
     
-    EventBuilder& entity(const std::string& name, const std::string& value) {
+    EventBuilder& entity(std::string_view name, const std::string& value) {
         event_.entity(name, value);
         return *this;
     }
@@ -232,7 +314,8 @@ public:
         return *this;
     }
     
-    // Emit the event (sends to processing pipeline)
+    // Emit the event (sends to processing pipeline); moves the event out,
+    // so the builder must not be reused afterwards
     void emit();
     
     // Get the built event without emitting
@@ -0,0 +1,193 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace agentlog {
+
+/**
+ * @brief Sorted-vector associative container
+ *
+ * Drop-in replacement for the small std::maps carried by every LogEvent.
+ * Entries live in one contiguous block (keys and values keep their own
+ * small-string storage), so an event with a handful of entities costs a
+ * single allocation instead of one node per entry, and lookups scan or
+ * binary-search adjacent memory. Iteration is in key order, exactly
+ * like std::map.
+ *
+ * Insertion is O(n); intended for the few-dozen-entry maps found on events.
+ */
+template<typename K, typename V, typename Compare = std::less<>>
+class FlatMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using container_type = std::vector<value_type>;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+    using size_type = typename container_type::size_type;
+
+    // Capacity reserved on first insert so typical events allocate once
+    static constexpr size_type kInitialCapacity = 4;
+
+    FlatMap() = default;
+
+    FlatMap(std::initializer_list<value_type> init) {
+        for (const auto& entry : init) {
+            insert_or_assign(entry.first, entry.second);
+        }
+    }
+
+    // Iteration
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    const_iterator cbegin() const { return entries_.cbegin(); }
+    const_iterator cend() const { return entries_.cend(); }
+
+    // Capacity
+    bool empty() const { return entries_.empty(); }
+    size_type size() const { return entries_.size(); }
+    void reserve(size_type n) { entries_.reserve(n); }
+    void clear() { entries_.clear(); }
+
+    // Lookup (heterogeneous: accepts anything comparable with K)
+    template<typename Q>
+    iterator find(const Q& key) {
+        const auto& probe = as_probe(key);
+        auto it = lower_bound(probe);
+        return (it != entries_.end() && !Compare()(probe, it->first)) ? it : entries_.end();
+    }
+
+    template<typename Q>
+    const_iterator find(const Q& key) const {
+        const auto& probe = as_probe(key);
+        auto it = lower_bound(probe);
+        return (it != entries_.end() && !Compare()(probe, it->first)) ? it : entries_.end();
+    }
+
+    template<typename Q>
+    size_type count(const Q& key) const { return find(key) != end() ? 1 : 0; }
+
+    template<typename Q>
+    const V& at(const Q& key) const {
+        auto it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("FlatMap::at: key not found");
+        }
+        return it->second;
+    }
+
+    // Modifiers
+    template<typename KeyArg, typename... Args>
+    std::pair<iterator, bool> try_emplace(KeyArg&& key, Args&&... args) {
+        auto it = lower_bound(key);
+        if (it != entries_.end() && !Compare()(key, it->first)) {
+            return {it, false};
+        }
+        reserve_for_insert();
+        it = lower_bound(key);
+        it = entries_.emplace(it, std::piecewise_construct,
+                              std::forward_as_tuple(std::forward<KeyArg>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+        return {it, true};
+    }
+
+    template<typename KeyArg, typename M>
+    std::pair<iterator, bool> insert_or_assign(KeyArg&& key, M&& value) {
+        auto result = try_emplace(std::forward<KeyArg>(key), std::forward<M>(value));
+        if (!result.second) {
+            result.first->second = std::forward<M>(value);
+        }
+        return result;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& entry) {
+        return try_emplace(entry.first, entry.second);
+    }
+
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+    V& operator[](K&& key) { return try_emplace(std::move(key)).first->second; }
+
+    template<typename Q>
+    size_type erase(const Q& key) {
+        auto it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        entries_.erase(it);
+        return 1;
+    }
+
+    // Both iterator overloads, or erase(find(key)) would pick the key template
+    iterator erase(iterator pos) { return entries_.erase(pos); }
+    iterator erase(const_iterator pos) { return entries_.erase(pos); }
+
+    friend bool operator==(const FlatMap& a, const FlatMap& b) {
+        return a.entries_ == b.entries_;
+    }
+
+    friend bool operator!=(const FlatMap& a, const FlatMap& b) {
+        return !(a == b);
+    }
+
+private:
+    // Below this size a linear scan beats binary search
+    static constexpr size_type kLinearSearchLimit = 8;
+
+    // String-like probes are compared as string_view so C-string keys are
+    // measured once instead of on every comparison
+    template<typename Q>
+    static decltype(auto) as_probe(const Q& key) {
+        if constexpr (std::is_convertible_v<const Q&, std::string_view>) {
+            return std::string_view(key);
+        } else {
+            return (key);
+        }
+    }
+
+    template<typename Q>
+    iterator lower_bound(const Q& key) {
+        return lower_bound_in(entries_.begin(), entries_.end(), key);
+    }
+
+    template<typename Q>
+    const_iterator lower_bound(const Q& key) const {
+        return lower_bound_in(entries_.begin(), entries_.end(), key);
+    }
+
+    template<typename It, typename Q>
+    static It lower_bound_in(It first, It last, const Q& key) {
+        if (static_cast<size_type>(last - first) <= kLinearSearchLimit) {
+            while (first != last && Compare()(first->first, key)) {
+                ++first;
+            }
+            return first;
+        }
+        return std::lower_bound(first, last, key,
+            [](const value_type& entry, const Q& k) { return Compare()(entry.first, k); });
+    }
+
+    void reserve_for_insert() {
+        if (entries_.capacity() == 0) {
+            entries_.reserve(kInitialCapacity);
+        }
+    }
+
+    container_type entries_;
+};
+
+} // namespace agentlog
@@ -0,0 +1,87 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "common.h"
+#include <charconv>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace agentlog {
+
+namespace detail {
+
+// Copies format text up to the next "{}" into out, unescaping "{{" and
+// "}}"; returns false if the text ran out first
+inline bool format_literal(std::string& out, std::string_view format, size_t& pos) {
+    while (pos < format.size()) {
+        char c = format[pos];
+        if ((c == '{' || c == '}') && pos + 1 < format.size() && format[pos + 1] == c) {
+            out += c;
+            pos += 2;
+        } else if (c == '{' && pos + 1 < format.size() && format[pos + 1] == '}') {
+            pos += 2;
+            return true;
+        } else {
+            out += c;
+            pos++;
+        }
+    }
+    return false;
+}
+
+inline void format_arg(std::string& out, std::string_view value) { out += value; }
+inline void format_arg(std::string& out, const char* value) { out += value ? value : "(null)"; }
+inline void format_arg(std::string& out, const std::string& value) { out += value; }
+inline void format_arg(std::string& out, char value) { out += value; }
+inline void format_arg(std::string& out, bool value) { out += value ? "true" : "false"; }
+inline void format_arg(std::string& out, Severity value) { out += severity_to_string(value); }
+
+template <typename T>
+void format_arg(std::string& out, const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    } else if constexpr (std::is_enum_v<T>) {
+        format_arg(out, static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        std::ostringstream oss;
+        oss << value;
+        out += oss.str();
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Append @p format to @p out with each "{}" replaced by the next argument
+ *
+ * Like std::format without format specs: "{{" and "}}" are literal braces,
+ * numbers use their shortest round-trip form, and other types are written
+ * with operator<<. Surplus arguments are ignored and surplus "{}" kept.
+ */
+template <typename... Args>
+void format_message_to(std::string& out, std::string_view format, const Args&... args) {
+    size_t pos = 0;
+    ((detail::format_literal(out, format, pos) ? detail::format_arg(out, args) : void()), ...);
+    while (pos < format.size()) {
+        if (!detail::format_literal(out, format, pos)) {
+            break;
+        }
+        out += "{}";
+    }
+}
+
+template <typename... Args>
+std::string format_message(std::string_view format, const Args&... args) {
+    std::string out;
+    out.reserve(format.size() + 16 * sizeof...(Args));
+    format_message_to(out, format, args...);
+    return out;
+}
+
+} // namespace agentlog
@@ -6,8 +6,10 @@
 #include "common.h"
 #include "event.h"
 #include "correlation_engine.h"
+#include <deque>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <mutex>
 #include <functional>
@@ -16,6 +18,7 @@ namespace agentlog {
 
 // Forward declarations
 class IncidentIntegration;
+class IncidentDispatcher;
 
 /**
  * @brief Severity levels for incidents
@@ -115,15 +118,26 @@ struct IncidentManagerConfig {
     double critical_threshold{0.95};
     double high_threshold{0.85};
     double medium_threshold{0.75};
+    
+    // Integration dispatch (runs on a background thread)
+    size_t dispatch_queue_size{1024};         // Max outstanding integration calls
+    size_t dispatch_max_retries{3};
+    std::chrono::milliseconds dispatch_retry_backoff{200};      // Doubles per attempt
+    std::chrono::milliseconds dispatch_max_retry_backoff{10000};
+    std::chrono::milliseconds dispatch_flush_timeout{5000};     // Max wait on shutdown
+    size_t dispatch_max_idle_tickets{4096};   // Unresolved tickets remembered for updates
+    std::chrono::seconds dispatch_idle_ticket_timeout{std::chrono::hours(24)};
 };
 
 class IncidentManager {
 public:
     using Config = IncidentManagerConfig;
     
-    IncidentManager(Config config = Config())
-        : config_(std::move(config))
-        , next_incident_id_(1) {}
+    IncidentManager(Config config = Config());
+    ~IncidentManager();
+    
+    IncidentManager(const IncidentManager&) = delete;
+    IncidentManager& operator=(const IncidentManager&) = delete;
     
     /**
      * @brief Evaluate if event should create incident
@@ -131,7 +145,7 @@ public:
      */
     std::optional<Incident> evaluate_event(
         const LogEvent& event,
-        const std::vector<Correlation>& correlations = {},
+        const std::vector<CorrelationPtr>& correlations = {},
         const std::vector<std::string>& matched_patterns = {}
     );
     
@@ -172,6 +186,11 @@ public:
     
     /**
      * @brief Check for duplicate incidents (deduplication)
+     * 
+     * An open incident created within the deduplication window is a
+     * duplicate if it has the same title and severity, or holds more than
+     * half of the incident's event IDs. Both are index lookups, so the cost
+     * does not grow with incident history. The caller holds the lock.
      */
     std::optional<std::string> find_duplicate(const Incident& incident) const;
     
@@ -185,6 +204,12 @@ public:
      */
     void register_integration(std::shared_ptr<IncidentIntegration> integration);
     
+    /**
+     * @brief Wait for queued integration calls to complete
+     * @return false if calls were still pending when the timeout expired
+     */
+    bool flush_integrations(std::chrono::milliseconds timeout);
+    
     /**
      * @brief Register callback for incident creation
      */
@@ -203,6 +228,14 @@ public:
         size_t currently_open{0};
         size_t resolved{0};
         size_t deduplicated{0};
+        
+        // Integration dispatch
+        uint64_t notifications_sent{0};
+        uint64_t notifications_coalesced{0};
+        uint64_t notifications_retried{0};
+        uint64_t notifications_failed{0};
+        uint64_t notifications_dropped{0};
+        uint64_t tickets_evicted{0};          // Idle, unresolved tickets forgotten
     };
     
     Stats get_stats() const;
@@ -215,6 +248,16 @@ private:
     ) const;
     
     std::string generate_incident_id();
+    void store_incident(const Incident& incident);
+    
+    // Deduplication index upkeep; all need the lock held
+    static std::string fingerprint(const Incident& incident);
+    void index_incident(const Incident& incident);
+    void unindex_incident(const Incident& incident);
+    void expire_dedup_index(timestamp_t now);
+    void record_external_id(const IncidentIntegration& integration,
+                            const std::string& incident_id,
+                            const std::string& external_id);
     
     Config config_;
     std::atomic<uint64_t> next_incident_id_;
@@ -222,6 +265,18 @@ private:
     std::unordered_map<std::string, Incident> incidents_;
     mutable std::mutex mutex_;
     
+    // Deduplication index: open incidents created within the window, by
+    // title/severity fingerprint and by event ID. Resolved incidents leave
+    // it at once, the rest when they age out of the window.
+    struct IndexedIncident {
+        std::string incident_id;
+        timestamp_t created_at;
+    };
+    std::unordered_map<std::string, std::vector<std::string>> by_fingerprint_;
+    std::unordered_map<uint64_t, std::vector<std::string>> by_event_id_;
+    std::unordered_set<std::string> indexed_;
+    std::deque<IndexedIncident> index_order_;  // Creation order, for aging out
+    
     std::vector<IncidentCallback> on_created_callbacks_;
     std::vector<IncidentCallback> on_resolved_callbacks_;
     
@@ -229,10 +284,18 @@ private:
     std::vector<std::shared_ptr<IncidentIntegration>> integrations_;
     
     Stats stats_;
+    
+    // Delivers integration calls off the event pipeline; declared last so it
+    // is torn down before the state its callbacks touch
+    std::unique_ptr<IncidentDispatcher> dispatcher_;
 };
 
 /**
  * @brief External integrations for incident management
+ *
+ * IncidentManager calls these from its dispatcher thread, never from the
+ * event pipeline. Throwing from any method marks the call as failed and
+ * schedules a retry with backoff.
  */
 class IncidentIntegration {
 public:
@@ -0,0 +1,229 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "common.h"
+#include "event.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace agentlog {
+
+// Endpoints are written as
+//   tcp://host:port    udp://host:port
+//   unix:///path       (unix-domain stream socket)
+//   unixgram:///path   (unix-domain datagram socket)
+// Port 0 in a listen endpoint binds an ephemeral port (see
+// IngestionServer::port()).
+//
+// The wire format is the LogEvent binary record (LogEvent::encode_binary)
+// repeated: a stream carries records back to back, and each datagram holds
+// one or more whole records.
+
+/**
+ * @brief Configuration for the network ingestion server
+ */
+struct IngestionServerConfig {
+    std::vector<std::string> listen;           // Endpoints to accept events on
+    size_t max_connections{1024};              // Stream clients beyond this are refused
+    size_t max_record_bytes{1024 * 1024};      // Larger records close the connection
+    size_t read_buffer_bytes{256 * 1024};      // Max per stream connection; starts at 4 KiB
+    int backlog{128};
+    
+    // Event types, service names, entity keys and metric names in received
+    // records are interned only while the SymbolTable holds fewer strings
+    // than this; records that need more are refused
+    size_t max_symbols{65536};
+};
+
+/**
+ * @brief Receives binary-encoded events from remote processes
+ *
+ * One thread multiplexes every listener and connection with epoll and
+ * decodes records straight out of each connection's receive buffer; every
+ * decoded event is moved to the handler, by default Logger::emit(), which
+ * moves it into a queue slot. Datagram sockets read up to 32 datagrams per
+ * system call. A record that fails to decode is counted and skipped; one
+ * whose length prefix exceeds max_record_bytes closes its connection.
+ *
+ * Senders number their events independently, so every received event gets
+ * a new local event_id. Interned names are never freed, so a peer sending
+ * endless new event types or keys has its records refused once the symbol
+ * table reaches max_symbols, rather than growing it without bound.
+ *
+ * Only available on Linux; start() fails elsewhere.
+ */
+class IngestionServer {
+public:
+    using Config = IngestionServerConfig;
+    using Handler = std::function<void(LogEvent&&)>;
+
+    struct Stats {
+        uint64_t events_received{0};
+        uint64_t bytes_received{0};
+        uint64_t records_malformed{0};
+        uint64_t records_refused{0};           // Over max_symbols
+        uint64_t connections_accepted{0};
+        uint64_t connections_refused{0};       // Over max_connections
+        uint64_t connections_open{0};
+    };
+
+    explicit IngestionServer(Config config, Handler handler = nullptr);
+    ~IngestionServer();
+
+    IngestionServer(const IngestionServer&) = delete;
+    IngestionServer& operator=(const IngestionServer&) = delete;
+
+    /**
+     * @brief Open every endpoint and start the receive thread
+     * @return false if an endpoint could not be opened (nothing is left open)
+     */
+    bool start();
+
+    /**
+     * @brief Stop receiving, close every socket and remove unix socket files
+     */
+    void stop();
+
+    bool is_running() const { return thread_.joinable(); }
+
+    /**
+     * @brief Port bound for config.listen[index]; 0 for unix endpoints
+     */
+    uint16_t port(size_t index) const;
+
+    Stats get_stats() const;
+
+private:
+    struct Listener {
+        int fd{-1};
+        bool stream{true};
+        std::string unix_path;                 // Unlinked on stop()
+        uint16_t port{0};
+    };
+
+    struct Connection {
+        int fd{-1};
+        std::string buffer;
+        size_t used{0};                        // Bytes of buffer holding data
+    };
+
+    void run();
+    void accept_all(const Listener& listener);
+    bool read_stream(Connection& connection);
+    void read_datagrams(int fd);
+    size_t decode_records(const char* data, size_t size, bool stream);
+    void close_connection(int fd);
+    void close_all();
+
+    Config config_;
+    Handler handler_;
+    std::thread thread_;
+    int epoll_fd_{-1};
+    int wake_fd_{-1};                          // eventfd that stop() signals
+    std::vector<Listener> listeners_;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;  // Receive thread only
+    std::vector<char> datagram_buffer_;
+
+    std::atomic<uint64_t> events_received_{0};
+    std::atomic<uint64_t> bytes_received_{0};
+    std::atomic<uint64_t> records_malformed_{0};
+    std::atomic<uint64_t> records_refused_{0};
+    std::atomic<uint64_t> connections_accepted_{0};
+    std::atomic<uint64_t> connections_refused_{0};
+    std::atomic<uint64_t> connections_open_{0};
+};
+
+/**
+ * @brief Configuration for IngestionClient
+ */
+struct IngestionClientConfig {
+    std::string address;                       // Server endpoint, as for IngestionServerConfig::listen
+    size_t batch_bytes{64 * 1024};             // Send early once this much is buffered
+    std::chrono::milliseconds flush_interval{50};
+    size_t max_pending_bytes{8 * 1024 * 1024}; // Events beyond this backlog are dropped
+    std::chrono::milliseconds reconnect_interval{1000};
+};
+
+/**
+ * @brief Batches events and ships them to an IngestionServer
+ *
+ * send() encodes the event into a shared buffer and returns; a background
+ * thread writes the buffer out whenever batch_bytes have accumulated or
+ * flush_interval has passed. Datagram endpoints get whole records packed
+ * into datagrams of at most batch_bytes (capped at 65507 for UDP). While
+ * the server is unreachable the client reconnects every
+ * reconnect_interval and keeps buffering up to max_pending_bytes; events
+ * that do not fit are dropped and counted, so send() never blocks.
+ *
+ * A process ships its events with client.send(EventBuilder(...).build()).
+ */
+class IngestionClient {
+public:
+    using Config = IngestionClientConfig;
+
+    struct Stats {
+        uint64_t events_sent{0};               // Handed to the OS
+        uint64_t events_dropped{0};            // Backlog full, or lost with a broken connection
+        uint64_t bytes_sent{0};
+        uint64_t reconnects{0};
+    };
+
+    explicit IngestionClient(Config config);
+    ~IngestionClient();                        // Flushes, then disconnects
+
+    IngestionClient(const IngestionClient&) = delete;
+    IngestionClient& operator=(const IngestionClient&) = delete;
+
+    bool is_valid() const { return valid_; }   // False if the address did not parse
+
+    void send(const LogEvent& event);
+
+    /**
+     * @brief Wait until everything sent so far has been written
+     * @return false if the server stayed unreachable until the timeout
+     */
+    bool flush(std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+    Stats get_stats() const;
+
+private:
+    void run();
+    bool connect();
+    void disconnect();
+    bool write_out(const std::string& data, size_t& records_written);
+
+    Config config_;
+    bool valid_{false};
+    int fd_{-1};                               // Writer thread only
+    bool stream_{true};
+    bool udp_{false};
+    size_t datagram_limit_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable data_cv_;          // Writer waits for data
+    std::condition_variable done_cv_;          // flush() waits for the writer
+    std::string pending_;
+    size_t pending_records_{0};
+    uint64_t accepted_{0};                     // Records taken by send()
+    uint64_t settled_{0};                      // Records written or dropped by the writer
+    bool flush_requested_{false};
+    bool stop_{false};
+    std::thread thread_;
+
+    std::atomic<uint64_t> events_sent_{0};
+    std::atomic<uint64_t> events_dropped_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> reconnects_{0};
+};
+
+} // namespace agentlog
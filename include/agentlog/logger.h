@@ -5,14 +5,21 @@
 
 #include "common.h"
 #include "event.h"
+#include "format.h"
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <mutex>
 #include <thread>
 #include <deque>
-#include <fstream>
+#include <memory>
 
 namespace agentlog {
 
+class FileSink;
+class Sampler;
+class SubscriberHub;
+
 /**
  * @brief Configuration for AgentLog
  */
@@ -24,10 +31,47 @@ struct Config {
     // Sampling
     double sampling_rate{1.0};  // 1.0 = 100%, 0.1 = 10%
     bool sample_anomalies_always{true};  // Always keep anomalous events
+    bool sample_by_trace_id{true};       // Keep or drop each trace as a whole
+    // Adaptive sampling: lower the rate per event type so that about this
+    // many events/s are kept in total, sharing the budget fairly between
+    // types (0 = off; sampling_rate stays the upper bound)
+    double sampling_target_per_sec{0.0};
+    
+    // Messages below this severity are discarded by trace()..critical(),
+    // log() and the AGENTLOG_* message macros before they are built.
+    // AGENTLOG_ACTIVE_LEVEL removes macros below it at compile time.
+    Severity min_severity{Severity::TRACE};
     
     // Performance
     size_t async_queue_size{8192};
     size_t worker_threads{2};
+    size_t max_batch_size{64};                    // Events a worker drains per wake-up
+    std::chrono::microseconds max_batch_linger{0}; // Max wait for a batch to fill
+    
+    // What emit() does when the event's queue is full:
+    //  DROP_NEWEST       drop the new event
+    //  BLOCK             wait up to overflow_block_timeout, then drop it
+    //  DROP_OLDEST       discard the oldest queued events to make room
+    //  SHED_BY_SEVERITY  drop low-severity events early as the queue fills
+    //                    (TRACE/DEBUG from 1/2 full, INFO from 3/4, WARNING
+    //                    from 9/10); ERROR and above displace the oldest
+    //  SPILL_TO_DISK     append to <storage_path>/spill/ and replay once the
+    //                    queue has drained below half full; replayed
+    //                    segments are deleted, and the new event is dropped
+    //                    while spill_max_mb of unreplayed events wait
+    enum class OverflowPolicy { DROP_NEWEST, BLOCK, DROP_OLDEST, SHED_BY_SEVERITY, SPILL_TO_DISK };
+    OverflowPolicy overflow_policy{OverflowPolicy::DROP_NEWEST};
+    std::chrono::milliseconds overflow_block_timeout{10};
+    size_t spill_max_mb{256};  // Cap on the unreplayed spill backlog
+    
+    // Partitioned pipeline: route every event by a key to one of
+    // worker_threads partitions, each with its own queue, worker, history,
+    // pattern engine and correlator, so events sharing a key are analyzed
+    // in emit order without contending with other partitions. Events that
+    // lack the key are routed by event type.
+    enum class PartitionKey { NONE, SERVICE_NAME, TRACE_ID, ENTITY };
+    PartitionKey partition_key{PartitionKey::NONE};
+    std::string partition_entity;  // Entity routed on when partition_key is ENTITY
     
     // AI features
     bool enable_anomaly_detection{true};
@@ -36,18 +80,35 @@ struct Config {
     bool enable_prediction{false};  // Not implemented yet
     bool enable_auto_incidents{false};
     
+    // Correlator retention (events and correlations kept for matching)
+    size_t correlation_max_events{100000};
+    std::chrono::seconds correlation_max_age{3600};
+    
     // Incident thresholds
     double incident_anomaly_threshold{0.8};
     size_t incident_pattern_threshold{1};
     size_t incident_correlation_threshold{3};
     
     // Storage
+    bool enable_storage{false};   // Persist events to segment files under storage_path
     std::string storage_path{"./agentlog_data"};
-    size_t max_storage_mb{1024};  // 1GB default
+    size_t max_storage_mb{1024};  // Event segments only; log files and spill have their own caps
+    size_t storage_segment_mb{16};
+    
+    // Learned-state snapshots: detector baselines, pattern windows and
+    // causality are saved to <storage_path>/state.snapshot and loaded by init()
+    bool enable_state_snapshots{false};
+    std::chrono::seconds snapshot_interval{300};  // Background save period (0 = only on shutdown)
     
     // File logging
     std::string log_file_path;     // If set, logs will be written to this file
     bool log_to_console{true};     // Log to stdout/stderr
+    size_t log_buffer_size{64 * 1024};  // Bytes buffered before a write
+    std::chrono::milliseconds log_flush_interval{200};  // Max delay before buffered lines hit the file
+    bool log_fdatasync{false};     // Sync the file after every write
+    size_t log_max_file_mb{64};    // Rotate at this size (0 = never)
+    std::chrono::seconds log_rotate_interval{0};  // Rotate this often (0 = never)
+    size_t log_max_total_mb{1024}; // Rotated files are pruned to fit this (0 = keep all)
     
     // Phase 3: External Integrations
     // Jira Cloud REST API configuration
@@ -79,6 +140,27 @@ struct Config {
  */
 using EventCallback = std::function<void(const LogEvent&)>;
 
+/**
+ * @brief Which processed events a subscription receives
+ */
+struct SubscriptionFilter {
+    std::string event_type_prefix;           // e.g. "payment."; empty = every type
+    Severity min_severity{Severity::TRACE};
+    double min_anomaly_score{0.0};           // Unscored events have score 0
+};
+
+struct SubscriptionOptions {
+    SubscriptionFilter filter;
+    
+    // Deliver on a thread of the subscription's own through a bounded
+    // queue, so a slow callback never holds up the workers. Events that
+    // find the queue full are dropped (Stats::events_subscriber_dropped).
+    bool async{false};
+    size_t queue_size{4096};
+};
+
+using SubscriptionId = uint64_t;
+
 /**
  * @brief Main logger class - thread-safe singleton
  */
@@ -102,72 +184,171 @@ public:
     void error(const std::string& msg);
     void critical(const std::string& msg);
     
-    // Emit event (called by EventBuilder)
+    // Whether messages of this severity pass Config::min_severity
+    bool is_enabled(Severity severity) const {
+        return static_cast<int>(severity) >= min_severity_.load(std::memory_order_relaxed);
+    }
+    
+    // Message with "{}" placeholders (see format_message()); the arguments
+    // are only formatted once the message has passed the level check and
+    // sampling
+    template <typename... Args>
+    void log(Severity severity, std::string_view format, const Args&... args);
+    
+    // Emit event (called by EventBuilder). The rvalue overload moves the
+    // event into the queue; the const& overload copies it once.
     void emit(const LogEvent& event);
+    void emit(LogEvent&& event);
     
-    // Register callbacks
+    // Register callbacks. Synchronous callbacks run on a worker thread
+    // after the batch has been analyzed; each callback is called for one
+    // batch at a time, but different callbacks run concurrently.
+    SubscriptionId subscribe(EventCallback callback, SubscriptionOptions options = {});
+    bool unsubscribe(SubscriptionId id);
     void on_event(EventCallback callback);
-    void on_anomaly(EventCallback callback);
+    void on_anomaly(EventCallback callback);  // Events scored >= 0.7
     
     // Configuration access
     const Config& config() const { return config_; }
     
+    // Save/restore the learned anomaly, pattern and causality state. Both
+    // return false if the file could not be written or read.
+    bool save_state_snapshot(const std::string& path) const;
+    bool load_state_snapshot(const std::string& path);
+    
     // Stats
+    struct LatencyStats {
+        uint64_t count{0};
+        double mean_us{0.0};
+        double p50_us{0.0};
+        double p90_us{0.0};
+        double p99_us{0.0};
+        double max_us{0.0};
+    };
+    
     struct Stats {
         uint64_t events_total{0};
-        uint64_t events_dropped{0};
+        uint64_t events_dropped{0};          // Sum of the drop counters below
+        uint64_t events_dropped_newest{0};   // Rejected on a full queue
+        uint64_t events_dropped_oldest{0};   // Evicted to make room
+        uint64_t events_shed{0};             // Shed by severity before the queue filled
+        uint64_t events_blocked{0};          // Emits that had to wait for room
+        uint64_t events_spilled{0};
+        uint64_t events_replayed{0};         // Spilled events processed since
+        uint64_t events_subscriber_dropped{0};  // Lost to full async subscriber queues
         uint64_t anomalies_detected{0};
         uint64_t patterns_matched{0};
         uint64_t correlations_found{0};
         uint64_t incidents_created{0};
+        
+        // Events queued now, over all partitions
+        size_t queue_depth{0};
+        size_t queue_capacity{0};
+        
+        // Per event: from its push onto the queue until a worker picked it up
+        LatencyStats queue_wait;
+        
+        // Per batch: worker time spent in each stage of process_batch()
+        LatencyStats anomaly_stage;
+        LatencyStats storage_stage;
+        LatencyStats pattern_stage;
+        LatencyStats correlation_stage;
+        LatencyStats incident_stage;
+        LatencyStats callback_stage;   // Subscriber delivery (sync callbacks, async enqueue)
+        LatencyStats sink_stage;       // Log file and console output
     };
     
     Stats get_stats() const;
     
-    // Access to AI components (for advanced usage)
-    PatternEnginePtr pattern_engine() const { return pattern_engine_; }
-    CorrelationEnginePtr correlation_engine() const { return correlation_engine_; }
+    // Counters, queue gauges and latency histograms in the Prometheus text
+    // exposition format, for serving on a /metrics endpoint
+    std::string prometheus_metrics() const;
+    
+    // Access to AI components (for advanced usage). A partitioned logger
+    // has one pattern engine and correlation engine per partition; the
+    // overloads without an index return the first partition's.
+    PatternEnginePtr pattern_engine() const { return pattern_engine(0); }
+    CorrelationEnginePtr correlation_engine() const { return correlation_engine(0); }
+    PatternEnginePtr pattern_engine(size_t partition) const;
+    CorrelationEnginePtr correlation_engine(size_t partition) const;
+    size_t partition_count() const { return partitions_.size(); }
     IncidentManagerPtr incident_manager() const { return incident_manager_; }
+    EventStorePtr event_store() const { return event_store_; }
     
 private:
-    Logger() = default;
+    Logger();
     ~Logger();
     
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     
-    void process_event(const LogEvent& event);
-    void async_worker();
+    struct Partition;
+    struct Metrics;
+    
+    void process_batch(Partition& partition, std::vector<LogEvent>& batch);
+    void async_worker(Partition& partition);
+    size_t partition_of(const LogEvent& event) const;
     bool should_sample(const LogEvent& event) const;
+    void emit_sampled(LogEvent&& event);
+    static LogEvent make_message(Severity severity);
+    void enqueue(Partition& partition, LogEvent&& event);
+    bool replay_spill(Partition& partition, std::vector<LogEvent>& batch, bool drain);
+    void snapshot_worker();
+    std::string snapshot_path() const;
     
     Config config_;
     bool initialized_{false};
     bool shutdown_requested_{false};
+    std::atomic<int> min_severity_{static_cast<int>(Severity::TRACE)};
     
     std::mutex mutex_;
-    std::mutex file_mutex_;  // Separate mutex for file I/O
-    std::ofstream log_file_;   // File output stream
-    std::vector<EventCallback> event_callbacks_;
-    std::vector<EventCallback> anomaly_callbacks_;
+    std::unique_ptr<FileSink> file_sink_;  // Buffered writer for log_file_path
+    std::unique_ptr<Sampler> sampler_;
+    std::unique_ptr<SubscriberHub> subscribers_;
     
-    // Stats
-    mutable std::mutex stats_mutex_;
-    Stats stats_;
+    // Counters and latency histograms, bumped without locks
+    std::unique_ptr<Metrics> metrics_;
     
     // Worker thread for async processing
     std::vector<std::thread> workers_;
     
-    // Components (initialized in init())
+    // Periodic state snapshots
+    std::thread snapshot_thread_;
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_cv_;
+    bool snapshot_stop_{false};
+    
+    // Components (initialized in init()). Detection, incidents and storage
+    // are shared; queues, history and pattern/correlation state belong to
+    // a partition.
     AnomalyDetectorPtr anomaly_detector_;
-    PatternEnginePtr pattern_engine_;
-    CorrelationEnginePtr correlation_engine_;
     IncidentManagerPtr incident_manager_;
+    EventStorePtr event_store_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    Symbol partition_entity_;
     
-    // Event history for pattern/correlation analysis
-    std::deque<LogEvent> event_history_;
+    // Events of history each partition keeps for pattern/correlation analysis
     size_t max_history_size_{1000};
 };
 
+template <typename... Args>
+void Logger::log(Severity severity, std::string_view format, const Args&... args) {
+    if (!is_enabled(severity)) {
+        return;
+    }
+    LogEvent event = make_message(severity);
+    if (!should_sample(event)) {
+        return;
+    }
+    std::string message;
+    format_message_to(message, format, args...);
+    event.message(std::move(message));
+    if (severity >= Severity::CRITICAL) {
+        event.capture_stack_trace();  // As critical() does
+    }
+    emit_sampled(std::move(event));
+}
+
 /**
  * @brief Global convenience functions
  */
@@ -213,16 +394,83 @@ inline void critical(const std::string& msg) {
     Logger::instance().critical(msg);
 }
 
+template <typename... Args>
+void log(Severity severity, std::string_view format, const Args&... args) {
+    Logger::instance().log(severity, format, args...);
+}
+
 } // namespace global
 
 } // namespace agentlog
 
-// Convenience macros
+// Compile-time level floor. Message macros below AGENTLOG_ACTIVE_LEVEL
+// expand to nothing and their arguments are not evaluated, e.g. build
+// with -DAGENTLOG_ACTIVE_LEVEL=AGENTLOG_LEVEL_INFO to strip TRACE/DEBUG.
+#define AGENTLOG_LEVEL_TRACE    0
+#define AGENTLOG_LEVEL_DEBUG    1
+#define AGENTLOG_LEVEL_INFO     2
+#define AGENTLOG_LEVEL_WARNING  3
+#define AGENTLOG_LEVEL_ERROR    4
+#define AGENTLOG_LEVEL_CRITICAL 5
+#define AGENTLOG_LEVEL_OFF      6
+
+#ifndef AGENTLOG_ACTIVE_LEVEL
+#define AGENTLOG_ACTIVE_LEVEL AGENTLOG_LEVEL_TRACE
+#endif
+
+// The message expression is only evaluated if the level is enabled at runtime
+#define AGENTLOG_LOG_IF_ENABLED_(severity, call) \
+    (agentlog::Logger::instance().is_enabled(agentlog::Severity::severity) ? call : void())
+
+// Convenience macros. The *F variants take a "{}" format and arguments,
+// formatted only for messages that are kept.
 #define AGENTLOG_EVENT(type) agentlog::global::event(type)
 #define AGENTLOG_OBSERVE(metric) agentlog::global::observe(metric)
-#define AGENTLOG_TRACE(msg) agentlog::global::trace(msg)
-#define AGENTLOG_DEBUG(msg) agentlog::global::debug(msg)
-#define AGENTLOG_INFO(msg) agentlog::global::info(msg)
-#define AGENTLOG_WARN(msg) agentlog::global::warn(msg)
-#define AGENTLOG_ERROR(msg) agentlog::global::error(msg)
-#define AGENTLOG_CRITICAL(msg) agentlog::global::critical(msg)
+
+#if AGENTLOG_ACTIVE_LEVEL <= AGENTLOG_LEVEL_TRACE
+#define AGENTLOG_TRACE(msg) AGENTLOG_LOG_IF_ENABLED_(TRACE, agentlog::global::trace(msg))
+#define AGENTLOG_TRACEF(...) agentlog::global::log(agentlog::Severity::TRACE, __VA_ARGS__)
+#else
+#define AGENTLOG_TRACE(msg) void()
+#define AGENTLOG_TRACEF(...) void()
+#endif
+
+#if AGENTLOG_ACTIVE_LEVEL <= AGENTLOG_LEVEL_DEBUG
+#define AGENTLOG_DEBUG(msg) AGENTLOG_LOG_IF_ENABLED_(DEBUG, agentlog::global::debug(msg))
+#define AGENTLOG_DEBUGF(...) agentlog::global::log(agentlog::Severity::DEBUG, __VA_ARGS__)
+#else
+#define AGENTLOG_DEBUG(msg) void()
+#define AGENTLOG_DEBUGF(...) void()
+#endif
+
+#if AGENTLOG_ACTIVE_LEVEL <= AGENTLOG_LEVEL_INFO
+#define AGENTLOG_INFO(msg) AGENTLOG_LOG_IF_ENABLED_(INFO, agentlog::global::info(msg))
+#define AGENTLOG_INFOF(...) agentlog::global::log(agentlog::Severity::INFO, __VA_ARGS__)
+#else
+#define AGENTLOG_INFO(msg) void()
+#define AGENTLOG_INFOF(...) void()
+#endif
+
+#if AGENTLOG_ACTIVE_LEVEL <= AGENTLOG_LEVEL_WARNING
+#define AGENTLOG_WARN(msg) AGENTLOG_LOG_IF_ENABLED_(WARNING, agentlog::global::warn(msg))
+#define AGENTLOG_WARNF(...) agentlog::global::log(agentlog::Severity::WARNING, __VA_ARGS__)
+#else
+#define AGENTLOG_WARN(msg) void()
+#define AGENTLOG_WARNF(...) void()
+#endif
+
+#if AGENTLOG_ACTIVE_LEVEL <= AGENTLOG_LEVEL_ERROR
+#define AGENTLOG_ERROR(msg) AGENTLOG_LOG_IF_ENABLED_(ERROR, agentlog::global::error(msg))
+#define AGENTLOG_ERRORF(...) agentlog::global::log(agentlog::Severity::ERROR, __VA_ARGS__)
+#else
+#define AGENTLOG_ERROR(msg) void()
+#define AGENTLOG_ERRORF(...) void()
+#endif
+
+#if AGENTLOG_ACTIVE_LEVEL <= AGENTLOG_LEVEL_CRITICAL
+#define AGENTLOG_CRITICAL(msg) AGENTLOG_LOG_IF_ENABLED_(CRITICAL, agentlog::global::critical(msg))
+#define AGENTLOG_CRITICALF(...) agentlog::global::log(agentlog::Severity::CRITICAL, __VA_ARGS__)
+#else
+#define AGENTLOG_CRITICAL(msg) void()
+#define AGENTLOG_CRITICALF(...) void()
+#endif
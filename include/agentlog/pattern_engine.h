@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <mutex>
 #include <memory>
+#include <string_view>
 
 namespace agentlog {
 
@@ -27,13 +28,32 @@ public:
      * @return Score between 0.0 (no match) and 1.0 (perfect match)
      */
     virtual double match(const LogEvent& event, 
-                        const std::deque<LogEvent>& context) = 0;
+                        const EventHistory& context) = 0;
     
     /**
      * @brief Learn from observed events
      */
     virtual void train(const LogEvent& event) = 0;
     
+    /**
+     * @brief Append learned state to @p out (nothing for stateless patterns)
+     */
+    virtual void serialize_state(std::string& /*out*/) const {}
+    
+    /**
+     * @brief Replace learned state with one from serialize_state()
+     * @return false if @p data is malformed
+     */
+    virtual bool restore_state(std::string_view /*data*/) { return true; }
+    
+    /**
+     * @brief Event types whose events can affect match() or train()
+     * 
+     * PatternEngine only hands a pattern events of the types it lists; an
+     * empty list (the default) means every event.
+     */
+    virtual std::vector<Symbol> event_types() const { return {}; }
+    
     /**
      * @brief Get pattern name/description
      */
@@ -50,6 +70,11 @@ public:
  * 
  * Example: "database.slow" followed by "api.timeout" followed by "user.error"
  * indicates a cascading failure pattern.
+ * 
+ * Matching is incremental: train() advances a small automaton with every
+ * event, and match() only consults it, so the cost per event is independent
+ * of how much history the caller passes. Step i links to step i + 1 when the
+ * later event arrives within steps[i].max_time_since_prev of it.
  */
 class SequentialPattern : public PatternMatcher {
 public:
@@ -64,15 +89,15 @@ public:
             , max_time_since_prev(max_time) {}
     };
     
-    SequentialPattern(std::string name, std::vector<Step> steps)
-        : name_(std::move(name))
-        , steps_(std::move(steps))
-        , match_count_(0) {}
+    SequentialPattern(std::string name, std::vector<Step> steps);
     
     double match(const LogEvent& event, 
-                const std::deque<LogEvent>& context) override;
+                const EventHistory& context) override;
     
     void train(const LogEvent& event) override;
+    void serialize_state(std::string& out) const override;
+    bool restore_state(std::string_view data) override;
+    std::vector<Symbol> event_types() const override;
     
     std::string name() const override { return name_; }
     std::string description() const override;
@@ -81,14 +106,55 @@ public:
     uint64_t match_count() const { return match_count_; }
     
 private:
-    bool matches_step(const LogEvent& event, const Step& step) const;
+    // Interned form of a Step, compared by id on the hot path, with its
+    // entity_matcher compiled once
+    struct StepSymbols {
+        Symbol event_type;
+        std::vector<Symbol> required_entities;
+        std::optional<std::regex> entity_regex;
+    };
+    
+    bool matches_step(const LogEvent& event, size_t index) const;
+    
+    // Whether the run through step index can still be extended at now
+    bool chain_live(size_t index, timestamp_t now) const;
     
     std::string name_;
     std::vector<Step> steps_;
+    std::vector<StepSymbols> step_symbols_;
+    
+    // chain_ends_[i]: when the newest run of steps 0..i completed. A newer
+    // run can always be extended wherever an older one could, so one
+    // timestamp per step is the whole automaton state.
+    std::vector<std::optional<timestamp_t>> chain_ends_;
     uint64_t match_count_;
     mutable std::mutex mutex_;
 };
 
+/**
+ * @brief Sizing of FrequencyPattern's fixed-memory SKETCH counting
+ */
+struct FrequencySketchConfig {
+    // Window resolution: counts cover the window plus at most
+    // window / buckets, so they can only err towards matching
+    size_t buckets{8};
+    
+    // Count-min table per bucket (REPEATED only). With N events in the
+    // window an entity is overcounted by more than e * N / width with
+    // probability at most e^-depth; memory is (buckets + 1) * depth *
+    // width * 4 bytes however many distinct entities arrive. 0 sizes the
+    // width for expected_events_per_second (see width_for()).
+    size_t width{0};
+    size_t depth{4};
+    
+    // Traffic of the pattern's event type, all entities together
+    double expected_events_per_second{1000.0};
+    
+    // width, or e * N / threshold for the N events expected per window, so
+    // an entity is pushed to the threshold with probability at most e^-depth
+    size_t width_for(size_t threshold, duration_t window) const;
+};
+
 /**
  * @brief Detects unusual frequency patterns
  * 
@@ -96,6 +162,12 @@ private:
  * - Sudden burst of errors from same user
  * - Repeated failed login attempts
  * - High frequency of specific event type
+ * 
+ * EXACT counting keeps every timestamp in the window, per entity for
+ * REPEATED, so memory grows with traffic and entity cardinality. SKETCH
+ * counting uses time-bucketed counters and, for REPEATED, a count-min
+ * sketch: constant memory and O(1) updates, at the cost of counts that
+ * may run high (see FrequencySketchConfig).
  */
 class FrequencyPattern : public PatternMatcher {
 public:
@@ -105,40 +177,56 @@ public:
         ABSENCE      // Expected event not occurring
     };
     
+    enum class Counting {
+        EXACT,       // Timestamp per event
+        SKETCH       // Fixed-size approximate counters
+    };
+    
+    using SketchConfig = FrequencySketchConfig;
+    
     FrequencyPattern(std::string name, 
                     std::string event_type,
                     FrequencyType type,
                     size_t threshold,
-                    duration_t window = std::chrono::seconds(60))
-        : name_(std::move(name))
-        , event_type_(std::move(event_type))
-        , type_(type)
-        , threshold_(threshold)
-        , window_(window) {}
+                    duration_t window = std::chrono::seconds(60),
+                    Counting counting = Counting::EXACT,
+                    SketchConfig sketch = SketchConfig());
+    ~FrequencyPattern() override;
     
     double match(const LogEvent& event, 
-                const std::deque<LogEvent>& context) override;
+                const EventHistory& context) override;
     
     void train(const LogEvent& event) override;
+    void serialize_state(std::string& out) const override;
+    bool restore_state(std::string_view data) override;
+    std::vector<Symbol> event_types() const override { return {event_symbol_}; }
     
     std::string name() const override { return name_; }
     std::string description() const override;
     
 private:
+    struct Sketch;
+    
     std::string name_;
     std::string event_type_;
+    Symbol event_symbol_;
     FrequencyType type_;
     size_t threshold_;
     duration_t window_;
     
-    // Track event history
+    // Track event history (EXACT)
     std::deque<timestamp_t> event_times_;
     std::unordered_map<std::string, std::deque<timestamp_t>> entity_times_;
+    
+    std::unique_ptr<Sketch> sketch_;  // Set for SKETCH counting
     mutable std::mutex mutex_;
 };
 
 /**
  * @brief Detects regex-based patterns in event messages or entities
+ * 
+ * PatternEngine prefilters registered regex patterns on literals their
+ * regex requires, so most events never reach std::regex at all.
  */
 class RegexPattern : public PatternMatcher {
 public:
@@ -148,16 +236,26 @@ public:
         : name_(std::move(name))
         , pattern_(pattern)
         , field_(std::move(field))
-        , regex_(pattern) {}
+        , regex_(pattern, std::regex::ECMAScript | std::regex::optimize) {}
     
     double match(const LogEvent& event, 
-                const std::deque<LogEvent>& context) override;
+                const EventHistory& context) override;
     
-    void train(const LogEvent& event) override {}
+    void train(const LogEvent& /*event*/) override {}
     
     std::string name() const override { return name_; }
     std::string description() const override;
     
+    const std::string& pattern() const { return pattern_; }
+    const std::string& field() const { return field_; }
+    
+    /**
+     * @brief The text matched for @p field of @p event
+     * @return nullopt if the event has no such entity
+     */
+    static std::optional<std::string_view> field_value(const LogEvent& event,
+                                                       const std::string& field);
+    
 private:
     std::string name_;
     std::string pattern_;
@@ -167,10 +265,18 @@ private:
 
 /**
  * @brief Pattern library for managing and matching patterns
+ * 
+ * Patterns are indexed by the event types they declare (see
+ * PatternMatcher::event_types()), so an event is only matched and trained
+ * against the patterns that can react to it. The literals required by
+ * every RegexPattern are compiled into one Aho-Corasick scanner per field,
+ * and a regex only runs on events whose field contains one of its
+ * literals.
  */
 class PatternEngine {
 public:
-    PatternEngine() = default;
+    PatternEngine();
+    ~PatternEngine();
     
     /**
      * @brief Register a pattern matcher
@@ -189,7 +295,21 @@ public:
     
     std::vector<PatternMatch> match_patterns(
         const LogEvent& event,
-        const std::deque<LogEvent>& context
+        const EventHistory& context
+    );
+    
+    /**
+     * @brief Match and train a batch of events under a single engine lock
+     * 
+     * Equivalent to calling match_patterns() followed by train_all() for
+     * each event in order: every event sees @p context followed by the
+     * events before it in the batch. Those are appended to @p context while
+     * the batch runs and removed again before returning.
+     * @return One vector of matches per event
+     */
+    std::vector<std::vector<PatternMatch>> match_patterns_batch(
+        const std::vector<LogEventPtr>& events,
+        EventHistory& context
     );
     
     /**
@@ -197,6 +317,21 @@ public:
      */
     void train_all(const LogEvent& event);
     
+    /**
+     * @brief Append the learned state of every registered pattern to @p out
+     */
+    void serialize_state(std::string& out) const;
+    
+    /**
+     * @brief Restore pattern state from serialize_state()
+     * 
+     * Patterns are matched by name; ones missing from the snapshot keep
+     * their current state and snapshot entries with no registered pattern
+     * are ignored.
+     * @return false if @p data or any pattern's state is malformed
+     */
+    bool restore_state(std::string_view data);
+    
     /**
      * @brief Get all registered patterns
      */
@@ -208,7 +343,23 @@ public:
     void register_builtin_patterns();
     
 private:
+    std::vector<PatternMatch> match_locked(const LogEvent& event,
+                                           const EventHistory& context);
+    
+    // Indices of the patterns that listen to event, in registration order
+    const std::vector<size_t>& relevant_locked(const LogEvent& event);
+    
     std::vector<std::shared_ptr<PatternMatcher>> patterns_;
+    
+    // Dispatch index into patterns_: by event type, plus the patterns that
+    // see every event
+    std::unordered_map<SymbolId, std::vector<size_t>> by_type_;
+    std::vector<size_t> any_type_;
+    std::vector<size_t> relevant_;  // Scratch for relevant_locked()
+    
+    // Literal prefilter shared by every registered RegexPattern
+    struct RegexPrefilter;
+    std::unique_ptr<RegexPrefilter> prefilter_;
     mutable std::mutex mutex_;
 };
 
@@ -225,15 +376,20 @@ public:
     
     /**
      * @brief Create authentication failure pattern
-     * Multiple failed logins from same user/IP
+     * Multiple failed logins from same user/IP. SKETCH counting bounds
+     * memory when user IDs or IPs are high-cardinality.
      */
-    static std::shared_ptr<FrequencyPattern> auth_failure_pattern();
+    static std::shared_ptr<FrequencyPattern> auth_failure_pattern(
+        FrequencyPattern::Counting counting = FrequencyPattern::Counting::EXACT,
+        FrequencyPattern::SketchConfig sketch = FrequencyPattern::SketchConfig());
     
     /**
      * @brief Create retry storm pattern
      * Repeated retries of same operation
      */
-    static std::shared_ptr<FrequencyPattern> retry_storm();
+    static std::shared_ptr<FrequencyPattern> retry_storm(
+        FrequencyPattern::Counting counting = FrequencyPattern::Counting::EXACT,
+        FrequencyPattern::SketchConfig sketch = FrequencyPattern::SketchConfig());
     
     /**
      * @brief Create memory leak pattern
@@ -0,0 +1,160 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "common.h"
+#include "event.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace agentlog {
+
+/**
+ * @brief Configuration for the on-disk event store
+ */
+struct EventStoreConfig {
+    std::string path{"./agentlog_data"};       // Directory holding segment files
+    uint64_t segment_bytes{16 * 1024 * 1024};  // Size of one segment file
+    uint64_t max_total_bytes{1024ull * 1024 * 1024};  // Oldest segments dropped beyond this (0 = keep all)
+    size_t index_interval{64};                 // Records per sparse index entry
+    
+    // At max_total_bytes, fail appends instead of dropping the oldest
+    // segments; for stores drained with read_from() and release()
+    bool reject_when_full{false};
+};
+
+/**
+ * @brief Filter for EventStore range scans; unset fields match everything
+ */
+struct EventQuery {
+    std::optional<timestamp_t> from;           // Inclusive
+    std::optional<timestamp_t> to;             // Exclusive
+    std::optional<std::string> event_type;
+    std::optional<std::string> trace_id;
+    size_t limit{0};                           // Max events returned (0 = no limit)
+};
+
+/**
+ * @brief Append-only, segmented store of binary-encoded events
+ * 
+ * Events are appended (LogEvent::encode_binary) to fixed-size segment files
+ * that are memory-mapped for both writing and scanning. Each segment keeps
+ * its min/max timestamp and event_id plus a sparse index with one entry per
+ * index_interval records; each entry records the time range and small
+ * event-type and trace-id bloom filters of its block, so scans skip whole
+ * segments and blocks that cannot match. Once the store exceeds
+ * max_total_bytes the oldest segments are deleted. Segment files are fully
+ * allocated when created, so a full disk fails the append instead of
+ * faulting a write through the mapping.
+ * 
+ * Reopening a directory recovers its segments, so history survives
+ * restarts. Events created afterwards get IDs past the largest one
+ * recovered, so IDs stay unique across runs as long as the store is opened
+ * before the process creates events of its own.
+ */
+class EventStore {
+public:
+    using Config = EventStoreConfig;
+    
+    explicit EventStore(Config config = Config());
+    ~EventStore();
+    
+    EventStore(const EventStore&) = delete;
+    EventStore& operator=(const EventStore&) = delete;
+    
+    bool is_open() const { return open_; }
+    
+    /**
+     * @brief Append events; false if the store is closed or an event failed to fit
+     */
+    bool append(const LogEvent& event);
+    bool append_batch(const std::vector<LogEventPtr>& events);
+    
+    /**
+     * @brief Flush mapped pages of the active segment to disk
+     */
+    void sync();
+    
+    /**
+     * @brief Visit matching events, oldest segment first
+     * 
+     * The visitor returns false to stop early.
+     * @return Number of events visited
+     */
+    size_t scan(const EventQuery& query,
+                const std::function<bool(const LogEvent&)>& visitor) const;
+    
+    /**
+     * @brief Collect matching events, oldest segment first
+     */
+    std::vector<LogEvent> scan(const EventQuery& query) const;
+    
+    /**
+     * @brief Look up a single event by ID
+     */
+    std::optional<LogEvent> get(uint64_t event_id) const;
+    
+    /**
+     * @brief Position in append order, advanced by read_from()
+     */
+    struct Cursor {
+        uint64_t segment{0};  // Segment sequence number
+        uint64_t offset{0};   // Byte offset of the next record in it
+    };
+    
+    /**
+     * @brief Visit up to @p max_events events in the order they were
+     *        appended, starting at @p cursor and advancing it past them
+     * 
+     * Segments deleted by retention since the last call are skipped, so a
+     * reader that falls behind loses the oldest events rather than stalling.
+     * @return Number of events visited
+     */
+    size_t read_from(Cursor& cursor, size_t max_events,
+                     const std::function<void(LogEvent&&)>& visitor) const;
+    
+    /**
+     * @brief Delete the sealed segments @p cursor has read to the end of
+     * 
+     * Lets a store used as a queue free what its reader has consumed, so
+     * only unread events count against max_total_bytes.
+     * @return Number of segments deleted
+     */
+    size_t release(const Cursor& cursor);
+    
+    struct Stats {
+        size_t segments{0};
+        uint64_t events{0};
+        uint64_t bytes{0};
+        uint64_t segments_dropped{0};
+    };
+    
+    Stats get_stats() const;
+    
+private:
+    struct Segment;
+    
+    bool open_segments();
+    bool roll_segment();
+    bool append_locked(const LogEvent& event, std::string& scratch);
+    void enforce_retention();
+    uint64_t total_bytes() const;
+    
+    template<typename Visitor>
+    void scan_segment(const Segment& segment, const EventQuery& query, Visitor&& visit) const;
+    
+    Config config_;
+    bool open_{false};
+    uint64_t next_sequence_{0};
+    
+    std::vector<std::unique_ptr<Segment>> segments_;  // Oldest first; back() is active
+    uint64_t segments_dropped_{0};
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace agentlog
@@ -0,0 +1,106 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace agentlog {
+
+using SymbolId = uint32_t;
+
+/**
+ * @brief Interned string handle
+ *
+ * A Symbol is a pointer to a string owned by the global SymbolTable plus
+ * its dense integer id. Copying one never allocates, equality is an id
+ * compare, and the id can be used directly as a hash-map key. Ordering
+ * follows the underlying strings so containers keyed on Symbols iterate
+ * in the same order as if they were keyed on std::string.
+ *
+ * The default Symbol is the empty string (id 0).
+ */
+class Symbol {
+public:
+    Symbol() noexcept;
+
+    // Interns @p text (thread-safe)
+    explicit Symbol(std::string_view text);
+
+    SymbolId id() const noexcept { return id_; }
+    const std::string& str() const noexcept { return *str_; }
+    const char* c_str() const noexcept { return str_->c_str(); }
+    size_t size() const noexcept { return str_->size(); }
+    bool empty() const noexcept { return id_ == 0; }
+
+    operator const std::string&() const noexcept { return *str_; }
+
+    friend bool operator==(const Symbol& a, const Symbol& b) noexcept { return a.id_ == b.id_; }
+    friend bool operator!=(const Symbol& a, const Symbol& b) noexcept { return a.id_ != b.id_; }
+    friend bool operator<(const Symbol& a, const Symbol& b) noexcept {
+        return a.id_ != b.id_ && *a.str_ < *b.str_;
+    }
+
+    // Mixed comparisons so Symbol-keyed maps accept plain string lookups
+    friend bool operator==(const Symbol& a, std::string_view b) noexcept { return *a.str_ == b; }
+    friend bool operator!=(const Symbol& a, std::string_view b) noexcept { return *a.str_ != b; }
+    friend bool operator==(std::string_view a, const Symbol& b) noexcept { return a == *b.str_; }
+    friend bool operator!=(std::string_view a, const Symbol& b) noexcept { return a != *b.str_; }
+    friend bool operator<(const Symbol& a, std::string_view b) noexcept { return *a.str_ < b; }
+    friend bool operator<(std::string_view a, const Symbol& b) noexcept { return a < *b.str_; }
+
+    friend std::ostream& operator<<(std::ostream& os, const Symbol& s) { return os << *s.str_; }
+
+private:
+    friend class SymbolTable;
+
+    Symbol(const std::string* str, SymbolId id) noexcept : str_(str), id_(id) {}
+
+    const std::string* str_;
+    SymbolId id_;
+};
+
+/**
+ * @brief Process-wide string intern table
+ *
+ * Interned strings are never freed, so only bounded vocabularies belong
+ * here: event types, entity/metric keys and service names. High-cardinality
+ * values such as trace IDs or user IDs should stay plain strings.
+ *
+ * Lookups of already-interned strings go through a small per-thread cache
+ * first and only take the shared (reader) lock on a miss.
+ */
+class SymbolTable {
+public:
+    // Intern @p text, creating a new symbol if needed
+    static Symbol intern(std::string_view text);
+
+    // As intern(), but a new symbol is only created while the table holds
+    // fewer than @p max_size strings; otherwise returns the empty Symbol
+    static Symbol intern(std::string_view text, size_t max_size);
+
+    // Look up @p text without interning it; returns the empty Symbol if absent
+    static Symbol find(std::string_view text);
+
+    // Symbol for a previously issued id; the empty Symbol if out of range
+    static Symbol from_id(SymbolId id);
+
+    // Number of interned strings, including the empty string
+    static size_t size();
+};
+
+} // namespace agentlog
+
+namespace std {
+
+template<>
+struct hash<agentlog::Symbol> {
+    size_t operator()(const agentlog::Symbol& s) const noexcept { return s.id(); }
+};
+
+} // namespace std
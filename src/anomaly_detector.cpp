@@ -2,66 +2,305 @@
 // SPDX-License-Identifier: MIT
 
 #include "agentlog/anomaly_detector.h"
+#include "binary_codec.h"
+#include "zscore_kernel.h"
 #include <algorithm>
 #include <cmath>
 
 namespace agentlog {
 
+using namespace detail;
+
+namespace {
+
+// Leading byte of every serialized detector state
+constexpr uint8_t kStateVersion = 1;
+
+} // namespace
+
+//=============================================================================
+// Detector Shard Implementation
+//=============================================================================
+
+namespace detail {
+
+void ShardGroups::build(const std::vector<SymbolId>& keys) {
+    offsets.fill(0);
+    for (SymbolId key : keys) {
+        offsets[key % kDetectorShards + 1]++;
+    }
+    for (size_t shard = 0; shard < kDetectorShards; ++shard) {
+        offsets[shard + 1] += offsets[shard];
+    }
+    
+    std::array<uint32_t, kDetectorShards> next;
+    std::copy(offsets.begin(), offsets.end() - 1, next.begin());
+    order.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        order[next[keys[i] % kDetectorShards]++] = static_cast<uint32_t>(i);
+    }
+}
+
+void MetricBatch::gather(const std::vector<const LogEvent*>& events) {
+    metrics.clear();
+    values.clear();
+    owners.clear();
+    
+    for (size_t i = 0; i < events.size(); ++i) {
+        for (const auto& [metric_name, value] : events[i]->metrics()) {
+            metrics.push_back(SymbolTable::intern(metric_name).id());
+            values.push_back(value);
+            owners.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    groups.build(metrics);
+}
+
+} // namespace detail
+
+//=============================================================================
+// AnomalyDetector Implementation
+//=============================================================================
+
+void AnomalyDetector::score_batch(const std::vector<const LogEvent*>& events,
+                                  std::vector<double>& scores) {
+    scores.clear();
+    scores.reserve(events.size());
+    for (const LogEvent* event : events) {
+        scores.push_back(score(*event));
+    }
+}
+
+void AnomalyDetector::train_batch(const std::vector<const LogEvent*>& events) {
+    for (const LogEvent* event : events) {
+        train(*event);
+    }
+}
+
+double AnomalyDetector::score_and_train(const LogEvent& event) {
+    double result = score(event);
+    train(event);
+    return result;
+}
+
+void AnomalyDetector::score_and_train_batch(const std::vector<const LogEvent*>& events,
+                                            std::vector<double>& scores) {
+    score_batch(events, scores);
+    train_batch(events);
+}
+
 //=============================================================================
 // ZScoreDetector Implementation
 //=============================================================================
 
+namespace {
+
+// Samples a metric needs before it is scored
+constexpr double kZScoreMinSamples = 30.0;
+
+} // namespace
+
+uint32_t ZScoreDetector::Shard::slot_of(SymbolId metric) const {
+    size_t local = metric / kDetectorShards;
+    return local < slot_by_metric.size() ? slot_by_metric[local] : kNoSlot;
+}
+
+uint32_t ZScoreDetector::Shard::add_slot(SymbolId metric) {
+    uint32_t slot = slot_of(metric);
+    if (slot != kNoSlot) {
+        return slot;
+    }
+    
+    slot = static_cast<uint32_t>(means.size());
+    means.push_back(0.0);
+    m2s.push_back(0.0);
+    counts.push_back(0.0);
+    slot_metric.push_back(metric);
+    
+    size_t local = metric / kDetectorShards;
+    if (local >= slot_by_metric.size()) {
+        slot_by_metric.resize(local + 1, kNoSlot);
+    }
+    slot_by_metric[local] = slot;
+    return slot;
+}
+
+void ZScoreDetector::Shard::clear() {
+    means.assign(1, 0.0);
+    m2s.assign(1, 0.0);
+    counts.assign(1, 0.0);
+    slot_metric.assign(1, 0);
+    slot_by_metric.clear();
+}
+
 double ZScoreDetector::score(const LogEvent& event) {
     if (event.metrics().empty()) {
         return 0.0;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    // One-event batch, so single and batch scoring share the kernel
+    std::vector<const LogEvent*> events{&event};
+    std::vector<double> scores;
+    run_batch(events, &scores, false);
+    return scores[0];
+}
+
+void ZScoreDetector::train(const LogEvent& event) {
+    std::vector<const LogEvent*> events{&event};
+    run_batch(events, nullptr, true);
+}
+
+double ZScoreDetector::score_and_train(const LogEvent& event) {
+    std::vector<const LogEvent*> events{&event};
+    std::vector<double> scores;
+    run_batch(events, &scores, true);
+    return scores[0];
+}
+
+void ZScoreDetector::score_batch(const std::vector<const LogEvent*>& events,
+                                 std::vector<double>& scores) {
+    run_batch(events, &scores, false);
+}
+
+void ZScoreDetector::train_batch(const std::vector<const LogEvent*>& events) {
+    run_batch(events, nullptr, true);
+}
+
+void ZScoreDetector::score_and_train_batch(const std::vector<const LogEvent*>& events,
+                                           std::vector<double>& scores) {
+    run_batch(events, &scores, true);
+}
+
+void ZScoreDetector::run_batch(const std::vector<const LogEvent*>& events,
+                               std::vector<double>* scores, bool train) {
+    if (scores) {
+        scores->assign(events.size(), 0.0);
+    }
+    
+    thread_local Scratch scratch;
+    const MetricBatch& batch = scratch.batch;
+    scratch.batch.gather(events);
+    size_t n = batch.values.size();
+    if (n == 0) {
+        return;
+    }
     
-    double max_zscore = 0.0;
+    if (scores) {
+        scratch.means.resize(n);
+        scratch.m2s.resize(n);
+        scratch.counts.resize(n);
+        scratch.contributions.resize(n);
+    }
     
-    for (const auto& [metric_name, value] : event.metrics()) {
-        auto it = metric_stats_.find(metric_name);
-        if (it == metric_stats_.end() || it->second.count < 30) {
-            // Not enough data yet
-            continue;
-        }
+    batch.groups.for_each([&](size_t index, const uint32_t* first, const uint32_t* last) {
+        Shard& shard = shards_[index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
         
-        const auto& stats = it->second;
-        double stddev = stats.stddev();
-        
-        if (stddev < 1e-6) {
-            // No variance - constant metric
-            if (std::abs(value - stats.mean) > 1e-6) {
-                return 1.0;  // Suddenly changed
+        // Gather every observation's stats before training on any, so the
+        // batch is scored against the model as it was. Untracked metrics
+        // read the empty slot 0, whose zero count the kernel scores as 0.
+        if (scores) {
+            for (const uint32_t* k = first; k != last; ++k) {
+                uint32_t slot = shard.slot_of(batch.metrics[*k]);
+                scratch.means[*k] = shard.means[slot];
+                scratch.m2s[*k] = shard.m2s[slot];
+                scratch.counts[*k] = shard.counts[slot];
             }
-            continue;
         }
         
-        // Calculate Z-score
-        double zscore = std::abs(value - stats.mean) / stddev;
-        
-        // Normalize to 0-1 range using sigmoid-like function
-        double normalized = std::tanh(zscore / threshold_);
-        max_zscore = std::max(max_zscore, normalized);
+        if (train) {
+            for (const uint32_t* k = first; k != last; ++k) {
+                uint32_t slot = shard.add_slot(batch.metrics[*k]);
+                double value = batch.values[*k];
+                
+                // Welford's online algorithm for numerical stability
+                shard.counts[slot] += 1.0;
+                double delta = value - shard.means[slot];
+                shard.means[slot] += delta / shard.counts[slot];
+                double delta2 = value - shard.means[slot];
+                shard.m2s[slot] += delta * delta2;
+            }
+        }
+    });
+    
+    if (!scores) {
+        return;
     }
     
-    return max_zscore;
+    detail::zscore_contributions(batch.values.data(), scratch.means.data(),
+                                 scratch.m2s.data(), scratch.counts.data(), n,
+                                 kZScoreMinSamples, 1.0 / threshold_,
+                                 scratch.contributions.data());
+    
+    // An event scores as its most anomalous metric
+    for (size_t k = 0; k < n; ++k) {
+        double& event_score = (*scores)[batch.owners[k]];
+        event_score = std::max(event_score, scratch.contributions[k]);
+    }
 }
 
-void ZScoreDetector::train(const LogEvent& event) {
-    std::lock_guard<std::mutex> lock(mutex_);
+// u8 version, varint metric count, then (str metric, f64 mean, f64 m2,
+// varint count) per metric
+void ZScoreDetector::serialize_state(std::string& out) const {
+    std::string metrics;
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t slot = 1; slot < shard.means.size(); ++slot) {
+            put_str(metrics, SymbolTable::from_id(shard.slot_metric[slot]).str());
+            put_double(metrics, shard.means[slot]);
+            put_double(metrics, shard.m2s[slot]);
+            put_varint(metrics, static_cast<uint64_t>(shard.counts[slot]));
+            count++;
+        }
+    }
     
-    for (const auto& [metric_name, value] : event.metrics()) {
-        auto& stats = metric_stats_[metric_name];
-        
-        // Welford's online algorithm for numerical stability
-        stats.count++;
-        double delta = value - stats.mean;
-        stats.mean += delta / stats.count;
-        double delta2 = value - stats.mean;
-        stats.m2 += delta * delta2;
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, count);
+    out += metrics;
+}
+
+bool ZScoreDetector::restore_state(std::string_view data) {
+    struct Restored {
+        SymbolId metric;
+        double mean;
+        double m2;
+        uint64_t count;
+    };
+    
+    BinaryReader in(data);
+    std::array<std::vector<Restored>, kDetectorShards> restored;
+    
+    if (in.u8() == kStateVersion) {
+        size_t count = in.count();
+        for (size_t i = 0; i < count && in.ok; ++i) {
+            Restored stats;
+            stats.metric = SymbolTable::intern(in.str()).id();
+            stats.mean = in.f64();
+            stats.m2 = in.f64();
+            stats.count = in.varint();
+            restored[stats.metric % kDetectorShards].push_back(stats);
+        }
+    } else {
+        in.ok = false;
     }
+    
+    bool ok = in.ok && in.at_end();
+    for (size_t index = 0; index < shards_.size(); ++index) {
+        Shard& shard = shards_[index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.clear();
+        if (!ok) {
+            continue;
+        }
+        for (const auto& stats : restored[index]) {
+            uint32_t slot = shard.add_slot(stats.metric);
+            shard.means[slot] = stats.mean;
+            shard.m2s[slot] = stats.m2;
+            shard.counts[slot] = static_cast<double>(stats.count);
+        }
+    }
+    return ok;
 }
 
 //=============================================================================
@@ -73,56 +312,198 @@ double MovingAverageDetector::score(const LogEvent& event) {
         return 0.0;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const LogEvent*> events{&event};
+    std::vector<double> scores;
+    run_batch(events, &scores, false);
+    return scores[0];
+}
+
+void MovingAverageDetector::train(const LogEvent& event) {
+    std::vector<const LogEvent*> events{&event};
+    run_batch(events, nullptr, true);
+}
+
+double MovingAverageDetector::score_and_train(const LogEvent& event) {
+    std::vector<const LogEvent*> events{&event};
+    std::vector<double> scores;
+    run_batch(events, &scores, true);
+    return scores[0];
+}
+
+void MovingAverageDetector::score_batch(const std::vector<const LogEvent*>& events,
+                                        std::vector<double>& scores) {
+    run_batch(events, &scores, false);
+}
+
+void MovingAverageDetector::train_batch(const std::vector<const LogEvent*>& events) {
+    run_batch(events, nullptr, true);
+}
+
+void MovingAverageDetector::score_and_train_batch(const std::vector<const LogEvent*>& events,
+                                                  std::vector<double>& scores) {
+    run_batch(events, &scores, true);
+}
+
+void MovingAverageDetector::run_batch(const std::vector<const LogEvent*>& events,
+                                      std::vector<double>* scores, bool train) {
+    if (scores) {
+        scores->assign(events.size(), 0.0);
+    }
     
-    double max_deviation = 0.0;
+    thread_local MetricBatch batch;
+    batch.gather(events);
     
-    for (const auto& [metric_name, value] : event.metrics()) {
-        auto it = metric_history_.find(metric_name);
-        if (it == metric_history_.end() || it->second.values.size() < 10) {
-            // Not enough history
-            continue;
-        }
+    batch.groups.for_each([&](size_t index, const uint32_t* first, const uint32_t* last) {
+        Shard& shard = shards_[index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
         
-        const auto& history = it->second;
-        double avg = history.sum / history.values.size();
+        // Score the shard's observations before training on any of them
+        if (scores) {
+            for (const uint32_t* k = first; k != last; ++k) {
+                auto it = shard.histories.find(batch.metrics[*k]);
+                if (it == shard.histories.end()) {
+                    continue;
+                }
+                double& event_score = (*scores)[batch.owners[*k]];
+                event_score = std::max(event_score, metric_score(it->second, batch.values[*k]));
+            }
+        }
         
+        if (train) {
+            for (const uint32_t* k = first; k != last; ++k) {
+                shard.histories[batch.metrics[*k]].push(batch.values[*k], window_size_);
+            }
+        }
+    });
+}
+
+double MovingAverageDetector::metric_score(const History& history, double value) const {
+    // Expected mean absolute deviation of a normal distribution per unit of
+    // standard deviation, so both estimators share one threshold scale
+    constexpr double kMadPerStddev = 0.7978845608028654;  // sqrt(2 / pi)
+    
+    if (history.values.size() < 10) {
+        // Not enough history
+        return 0.0;
+    }
+    
+    double avg = history.mean;
+    
+    double mad;
+    if (dispersion_ == Dispersion::STREAMING_STDDEV) {
+        mad = std::sqrt(history.m2 / history.values.size()) * kMadPerStddev;
+    } else {
         // Calculate MAD (Mean Absolute Deviation)
-        double mad = 0.0;
+        mad = 0.0;
         for (double v : history.values) {
             mad += std::abs(v - avg);
         }
         mad /= history.values.size();
-        
-        if (mad < 1e-6) {
-            if (std::abs(value - avg) > 1e-6) {
-                return 1.0;
-            }
-            continue;
+    }
+    
+    if (mad < 1e-6) {
+        return std::abs(value - avg) > 1e-6 ? 1.0 : 0.0;
+    }
+    
+    // Deviation score
+    double deviation = std::abs(value - avg) / (threshold_ * mad);
+    return std::tanh(deviation);
+}
+
+void MovingAverageDetector::History::push(double value, size_t window_size) {
+    if (values.size() < window_size) {
+        // Still filling: plain Welford update
+        values.push_back(value);
+        double delta = value - mean;
+        mean += delta / values.size();
+        m2 += delta * (value - mean);
+        return;
+    }
+    
+    // Full: overwrite the oldest value and slide mean and m2 in one step
+    double oldest = values[head];
+    values[head] = value;
+    head = (head + 1) % values.size();
+    
+    double old_mean = mean;
+    mean += (value - oldest) / values.size();
+    m2 += (value - oldest) * (value - mean + oldest - old_mean);
+    if (m2 < 0.0) {
+        m2 = 0.0;
+    }
+    
+    if (++pushes_since_refresh >= values.size()) {
+        refresh();
+    }
+}
+
+void MovingAverageDetector::History::refresh() {
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    mean = values.empty() ? 0.0 : sum / values.size();
+    
+    m2 = 0.0;
+    for (double v : values) {
+        m2 += (v - mean) * (v - mean);
+    }
+    pushes_since_refresh = 0;
+}
+
+// u8 version, varint metric count, then (str metric, varint n, n x f64)
+// per metric, oldest value first
+void MovingAverageDetector::serialize_state(std::string& out) const {
+    std::string metrics;
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [metric, history] : shard.histories) {
+            put_str(metrics, SymbolTable::from_id(metric).str());
+            put_varint(metrics, history.values.size());
+            history.for_each([&metrics](double v) { put_double(metrics, v); });
+            count++;
         }
-        
-        // Deviation score
-        double deviation = std::abs(value - avg) / (threshold_ * mad);
-        max_deviation = std::max(max_deviation, std::tanh(deviation));
     }
     
-    return max_deviation;
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, count);
+    out += metrics;
 }
 
-void MovingAverageDetector::train(const LogEvent& event) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool MovingAverageDetector::restore_state(std::string_view data) {
+    BinaryReader in(data);
+    std::array<std::unordered_map<SymbolId, History>, kDetectorShards> restored;
     
-    for (const auto& [metric_name, value] : event.metrics()) {
-        auto& history = metric_history_[metric_name];
-        
-        history.values.push_back(value);
-        history.sum += value;
-        
-        if (history.values.size() > window_size_) {
-            history.sum -= history.values.front();
-            history.values.pop_front();
+    if (in.u8() == kStateVersion) {
+        size_t count = in.count();
+        for (size_t i = 0; i < count && in.ok; ++i) {
+            SymbolId metric = SymbolTable::intern(in.str()).id();
+            auto& history = restored[metric % kDetectorShards][metric];
+            size_t n = in.count();
+            // The window may have shrunk since the snapshot was taken
+            size_t skip = n > window_size_ ? n - window_size_ : 0;
+            for (size_t j = 0; j < n && in.ok; ++j) {
+                double v = in.f64();
+                if (j >= skip) {
+                    history.values.push_back(v);
+                }
+            }
+            history.refresh();
+        }
+    } else {
+        in.ok = false;
+    }
+    
+    bool ok = in.ok && in.at_end();
+    for (size_t index = 0; index < shards_.size(); ++index) {
+        std::lock_guard<std::mutex> lock(shards_[index].mutex);
+        shards_[index].histories.clear();
+        if (ok) {
+            shards_[index].histories = std::move(restored[index]);
         }
     }
+    return ok;
 }
 
 //=============================================================================
@@ -130,11 +511,77 @@ void MovingAverageDetector::train(const LogEvent& event) {
 //=============================================================================
 
 double RateDetector::score(const LogEvent& event) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    SymbolId type = event.event_type_symbol().id();
+    Shard& shard = shard_for(type);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return score_locked(shard.event_rates[type], event);
+}
+
+void RateDetector::train(const LogEvent& event) {
+    SymbolId type = event.event_type_symbol().id();
+    Shard& shard = shard_for(type);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    train_locked(shard.event_rates[type], event);
+}
+
+double RateDetector::score_and_train(const LogEvent& event) {
+    SymbolId type = event.event_type_symbol().id();
+    Shard& shard = shard_for(type);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& rate_stats = shard.event_rates[type];
+    double result = score_locked(rate_stats, event);
+    train_locked(rate_stats, event);
+    return result;
+}
+
+void RateDetector::score_batch(const std::vector<const LogEvent*>& events,
+                               std::vector<double>& scores) {
+    run_batch(events, &scores, false);
+}
+
+void RateDetector::train_batch(const std::vector<const LogEvent*>& events) {
+    run_batch(events, nullptr, true);
+}
+
+void RateDetector::score_and_train_batch(const std::vector<const LogEvent*>& events,
+                                         std::vector<double>& scores) {
+    run_batch(events, &scores, true);
+}
+
+void RateDetector::run_batch(const std::vector<const LogEvent*>& events,
+                             std::vector<double>* scores, bool train) {
+    if (scores) {
+        scores->assign(events.size(), 0.0);
+    }
     
-    const std::string& event_type = event.event_type();
-    auto& rate_stats = event_rates_[event_type];
+    thread_local std::vector<SymbolId> types;
+    thread_local ShardGroups groups;
+    types.clear();
+    for (const LogEvent* event : events) {
+        types.push_back(event->event_type_symbol().id());
+    }
+    groups.build(types);
     
+    groups.for_each([&](size_t index, const uint32_t* first, const uint32_t* last) {
+        Shard& shard = shards_[index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        // Score the shard's events before training on any of them
+        if (scores) {
+            for (const uint32_t* i = first; i != last; ++i) {
+                (*scores)[*i] = score_locked(shard.event_rates[types[*i]], *events[*i]);
+            }
+        }
+        
+        if (train) {
+            for (const uint32_t* i = first; i != last; ++i) {
+                train_locked(shard.event_rates[types[*i]], *events[*i]);
+            }
+        }
+    });
+}
+
+double RateDetector::score_locked(RateStats& rate_stats, const LogEvent& event) const {
     if (rate_stats.timestamps.empty()) {
         return 0.0;
     }
@@ -170,12 +617,7 @@ double RateDetector::score(const LogEvent& event) {
     return 0.0;
 }
 
-void RateDetector::train(const LogEvent& event) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    const std::string& event_type = event.event_type();
-    auto& rate_stats = event_rates_[event_type];
-    
+void RateDetector::train_locked(RateStats& rate_stats, const LogEvent& event) const {
     rate_stats.timestamps.push_back(event.timestamp());
     
     // Update baseline (exponential moving average)
@@ -196,6 +638,60 @@ void RateDetector::train(const LogEvent& event) {
     }
 }
 
+// u8 version, varint event type count, then (str event_type,
+// f64 baseline_rate, varint n, n x time) per type. Event types are written
+// by name because symbol ids differ between processes.
+void RateDetector::serialize_state(std::string& out) const {
+    std::string types;
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [type_id, rate_stats] : shard.event_rates) {
+            put_str(types, SymbolTable::from_id(type_id).str());
+            put_double(types, rate_stats.baseline_rate);
+            put_varint(types, rate_stats.timestamps.size());
+            for (const auto& ts : rate_stats.timestamps) {
+                put_time(types, ts);
+            }
+            count++;
+        }
+    }
+    
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, count);
+    out += types;
+}
+
+bool RateDetector::restore_state(std::string_view data) {
+    BinaryReader in(data);
+    std::array<std::unordered_map<SymbolId, RateStats>, kDetectorShards> restored;
+    
+    if (in.u8() == kStateVersion) {
+        size_t count = in.count();
+        for (size_t i = 0; i < count && in.ok; ++i) {
+            SymbolId type = SymbolTable::intern(in.str()).id();
+            auto& rate_stats = restored[type % kDetectorShards][type];
+            rate_stats.baseline_rate = in.f64();
+            size_t n = in.count();
+            for (size_t j = 0; j < n && in.ok; ++j) {
+                rate_stats.timestamps.push_back(in.time());
+            }
+        }
+    } else {
+        in.ok = false;
+    }
+    
+    bool ok = in.ok && in.at_end();
+    for (size_t index = 0; index < shards_.size(); ++index) {
+        std::lock_guard<std::mutex> lock(shards_[index].mutex);
+        shards_[index].event_rates.clear();
+        if (ok) {
+            shards_[index].event_rates = std::move(restored[index]);
+        }
+    }
+    return ok;
+}
+
 //=============================================================================
 // EnsembleDetector Implementation
 //=============================================================================
@@ -217,6 +713,32 @@ double EnsembleDetector::score(const LogEvent& event) {
         scores.push_back(s);
     }
     
+    return combine(scores);
+}
+
+void EnsembleDetector::score_batch(const std::vector<const LogEvent*>& events,
+                                   std::vector<double>& scores) {
+    scores.assign(events.size(), 0.0);
+    if (detectors_.empty() || events.empty()) {
+        return;
+    }
+    
+    // One virtual call (and one lock) per member detector for the whole batch
+    std::vector<std::vector<double>> member_scores(detectors_.size());
+    for (size_t d = 0; d < detectors_.size(); ++d) {
+        detectors_[d].detector->score_batch(events, member_scores[d]);
+    }
+    
+    std::vector<double> per_event(detectors_.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        for (size_t d = 0; d < detectors_.size(); ++d) {
+            per_event[d] = member_scores[d][i];
+        }
+        scores[i] = combine(per_event);
+    }
+}
+
+double EnsembleDetector::combine(const std::vector<double>& scores) const {
     switch (method_) {
         case CombineMethod::MAX:
             return *std::max_element(scores.begin(), scores.end());
@@ -255,6 +777,86 @@ void EnsembleDetector::train(const LogEvent& event) {
     }
 }
 
+void EnsembleDetector::train_batch(const std::vector<const LogEvent*>& events) {
+    for (auto& info : detectors_) {
+        info.detector->train_batch(events);
+    }
+}
+
+double EnsembleDetector::score_and_train(const LogEvent& event) {
+    if (detectors_.empty()) {
+        return 0.0;
+    }
+    
+    std::vector<double> scores;
+    scores.reserve(detectors_.size());
+    
+    for (const auto& info : detectors_) {
+        scores.push_back(info.detector->score_and_train(event));
+    }
+    
+    return combine(scores);
+}
+
+void EnsembleDetector::score_and_train_batch(const std::vector<const LogEvent*>& events,
+                                             std::vector<double>& scores) {
+    scores.assign(events.size(), 0.0);
+    if (detectors_.empty() || events.empty()) {
+        return;
+    }
+    
+    std::vector<std::vector<double>> member_scores(detectors_.size());
+    for (size_t d = 0; d < detectors_.size(); ++d) {
+        detectors_[d].detector->score_and_train_batch(events, member_scores[d]);
+    }
+    
+    std::vector<double> per_event(detectors_.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        for (size_t d = 0; d < detectors_.size(); ++d) {
+            per_event[d] = member_scores[d][i];
+        }
+        scores[i] = combine(per_event);
+    }
+}
+
+// u8 version, varint member count, then (str name, str state) per member
+void EnsembleDetector::serialize_state(std::string& out) const {
+    std::string member_state;
+    
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, detectors_.size());
+    for (const auto& info : detectors_) {
+        member_state.clear();
+        info.detector->serialize_state(member_state);
+        put_str(out, info.detector->name());
+        put_str(out, member_state);
+    }
+}
+
+// Members are matched by position and name, so a snapshot taken before a
+// detector was added or reordered restores only the members that still line
+// up; the rest start cold.
+bool EnsembleDetector::restore_state(std::string_view data) {
+    BinaryReader in(data);
+    if (in.u8() != kStateVersion) {
+        return false;
+    }
+    
+    bool ok = true;
+    size_t count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        std::string_view member_name = in.str();
+        std::string_view member_state = in.str();
+        if (!in.ok || i >= detectors_.size() ||
+            detectors_[i].detector->name() != member_name) {
+            continue;
+        }
+        ok = detectors_[i].detector->restore_state(member_state) && ok;
+    }
+    
+    return ok && in.ok && in.at_end();
+}
+
 //=============================================================================
 // DetectorFactory Implementation
 //=============================================================================
@@ -276,8 +878,9 @@ std::shared_ptr<AnomalyDetector> DetectorFactory::create_z_score(double threshol
     return std::make_shared<ZScoreDetector>(threshold);
 }
 
-std::shared_ptr<AnomalyDetector> DetectorFactory::create_moving_average(size_t window) {
-    return std::make_shared<MovingAverageDetector>(window);
+std::shared_ptr<AnomalyDetector> DetectorFactory::create_moving_average(
+    size_t window, MovingAverageDetector::Dispersion dispersion) {
+    return std::make_shared<MovingAverageDetector>(window, 2.5, dispersion);
 }
 
 std::shared_ptr<AnomalyDetector> DetectorFactory::create_rate(std::chrono::seconds window) {
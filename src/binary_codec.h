@@ -0,0 +1,148 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_BINARY_CODEC_H
+#define AGENTLOG_BINARY_CODEC_H
+
+#include "agentlog/common.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace agentlog {
+namespace detail {
+
+// Little-endian, length-prefixed encoding shared by the LogEvent record
+// format and the learned-state snapshots. A str is a varint byte length
+// followed by the bytes; f64 is the IEEE-754 bit pattern as 8 LE bytes.
+
+inline void put_varint(std::string& out, uint64_t value) {
+    char buf[10];
+    size_t n = 0;
+    while (value >= 0x80) {
+        buf[n++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buf[n++] = static_cast<char>(value);
+    out.append(buf, n);
+}
+
+// Zigzag so small negative values stay short
+inline void put_svarint(std::string& out, int64_t value) {
+    put_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+inline void put_fixed64(std::string& out, uint64_t value) {
+    char buf[8];
+    for (int i = 0; i < 8; ++i) {
+        buf[i] = static_cast<char>(value >> (8 * i));
+    }
+    out.append(buf, 8);
+}
+
+inline void put_double(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_fixed64(out, bits);
+}
+
+inline void put_str(std::string& out, std::string_view value) {
+    put_varint(out, value.size());
+    out.append(value.data(), value.size());
+}
+
+// Nanoseconds since epoch / nanoseconds, both zigzag varints
+inline void put_time(std::string& out, timestamp_t ts) {
+    put_svarint(out, std::chrono::duration_cast<std::chrono::nanoseconds>(
+        ts.time_since_epoch()).count());
+}
+
+inline void put_duration(std::string& out, duration_t d) {
+    put_svarint(out, std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+// Bounds-checked reader over one buffer; any overrun latches ok = false
+struct BinaryReader {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool ok{true};
+
+    BinaryReader(const unsigned char* begin, const unsigned char* finish)
+        : p(begin), end(finish) {}
+
+    explicit BinaryReader(std::string_view data)
+        : p(reinterpret_cast<const unsigned char*>(data.data()))
+        , end(reinterpret_cast<const unsigned char*>(data.data()) + data.size()) {}
+
+    bool at_end() const { return p == end; }
+
+    uint8_t u8() {
+        if (p >= end) { ok = false; return 0; }
+        return *p++;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) { ok = false; return 0; }
+            uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t svarint() {
+        uint64_t zigzag = varint();
+        return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    }
+
+    uint64_t fixed64() {
+        if (end - p < 8) { ok = false; return 0; }
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= uint64_t(p[i]) << (8 * i);
+        }
+        p += 8;
+        return value;
+    }
+
+    double f64() {
+        uint64_t bits = fixed64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string_view str() {
+        uint64_t size = varint();
+        if (!ok || uint64_t(end - p) < size) { ok = false; return {}; }
+        std::string_view value(reinterpret_cast<const char*>(p), size);
+        p += size;
+        return value;
+    }
+
+    timestamp_t time() {
+        return timestamp_t(std::chrono::duration_cast<timestamp_t::duration>(
+            std::chrono::nanoseconds(svarint())));
+    }
+
+    duration_t duration() {
+        return std::chrono::duration_cast<duration_t>(std::chrono::nanoseconds(svarint()));
+    }
+
+    // A count of elements at least @p min_size bytes each can never exceed
+    // the bytes left over min_size, which guards reserve()
+    size_t count(size_t min_size = 1) {
+        uint64_t n = varint();
+        if (n > uint64_t(end - p) / min_size) { ok = false; return 0; }
+        return static_cast<size_t>(n);
+    }
+};
+
+} // namespace detail
+} // namespace agentlog
+
+#endif // AGENTLOG_BINARY_CODEC_H
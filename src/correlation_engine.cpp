@@ -2,253 +2,542 @@
 // SPDX-License-Identifier: MIT
 
 #include "agentlog/correlation_engine.h"
+#include "agentlog/storage.h"
+#include "binary_codec.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <sstream>
 
 namespace agentlog {
 
+using namespace detail;
+
+namespace {
+
+// Leading byte of the serialized causality state. Version 1 carried
+// relationships only and is still accepted.
+constexpr uint8_t kStateVersion = 2;
+constexpr uint8_t kRelationshipsOnlyVersion = 1;
+
+// Pseudo-observations a relationship's prior strength counts for, so a
+// few early observations do not swing a learned strength to 0 or 1
+constexpr double kPriorWeight = 2.0;
+
+// 64-bit FNV-1a; a collision between two live keys is vanishingly unlikely
+// and at worst adds a spurious candidate to a correlation.
+uint64_t index_key(std::string_view text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Index keys of an event's entity values, each once; two entities of one
+// event (caller and callee, say) may share a value
+std::vector<uint64_t> entity_keys(const LogEvent& event) {
+    std::vector<uint64_t> keys;
+    keys.reserve(event.entities().size());
+    for (const auto& [key, value] : event.entities()) {
+        keys.push_back(index_key(value));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+} // namespace
+
 //=============================================================================
-// EventCorrelator Implementation
+// EventIdView Implementation
 //=============================================================================
 
-std::vector<Correlation> EventCorrelator::correlate(const LogEvent& event) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    std::vector<Correlation> found_correlations;
-    
-    // Try different correlation strategies
-    if (auto corr = correlate_by_trace_id(event)) {
-        found_correlations.push_back(*corr);
+EventIdView::EventIdView(const std::vector<uint64_t>& ids) {
+    if (ids.empty()) {
+        return;
+    }
+    auto chunk = std::make_shared<detail::IdChunk>(ids.size());
+    std::copy(ids.begin(), ids.end(), chunk->ids.get());
+    append({std::move(chunk), 0, ids.size()});
+}
+
+void EventIdView::append(Segment segment) {
+    if (segment.count == 0) {
+        return;
+    }
+    size_ += segment.count;
+    segments_.push_back(std::move(segment));
+}
+
+bool EventIdView::contains(uint64_t id) const {
+    return std::find(begin(), end(), id) != end();
+}
+
+std::vector<uint64_t> EventIdView::to_vector() const {
+    return std::vector<uint64_t>(begin(), end());
+}
+
+EventIdView::const_iterator::const_iterator(const EventIdView* view, size_t segment)
+    : view_(view)
+    , segment_(segment) {
+    enter_segment();
+}
+
+void EventIdView::const_iterator::enter_segment() {
+    if (segment_ < view_->segments_.size()) {
+        const Segment& segment = view_->segments_[segment_];
+        chunk_ = segment.chunk.get();
+        pos_ = segment.offset;
+        remaining_ = segment.count;
+    } else {
+        chunk_ = nullptr;
+        pos_ = 0;
+        remaining_ = 0;
+    }
+}
+
+EventIdView::const_iterator& EventIdView::const_iterator::operator++() {
+    // Only follow next while ids remain: a full chunk's next pointer may be
+    // assigned after this view was created, so it is never read speculatively
+    if (--remaining_ == 0) {
+        ++segment_;
+        enter_segment();
+    } else if (++pos_ == chunk_->capacity) {
+        chunk_ = chunk_->next.get();
+        pos_ = 0;
+    }
+    return *this;
+}
+
+//=============================================================================
+// EventCorrelator::IdList Implementation
+//=============================================================================
+
+void EventCorrelator::IdList::push_back(uint64_t id) {
+    // Chunks start small, as most traces and entity values have few
+    // members, and double up to a cap for hot keys
+    constexpr size_t kFirstChunk = 4;
+    constexpr size_t kMaxChunk = 1024;
+    
+    if (chunks_.empty() || tail_ == chunks_.back()->capacity) {
+        size_t capacity = chunks_.empty()
+            ? kFirstChunk
+            : std::min(chunks_.back()->capacity * 2, kMaxChunk);
+        auto chunk = std::make_shared<detail::IdChunk>(capacity);
+        if (!chunks_.empty()) {
+            chunks_.back()->next = chunk;
+        }
+        chunks_.push_back(std::move(chunk));
+        tail_ = 0;
     }
     
-    if (auto corr = correlate_by_entities(event)) {
-        found_correlations.push_back(*corr);
+    chunks_.back()->ids[tail_++] = id;
+    ++size_;
+}
+
+void EventCorrelator::IdList::pop_front() {
+    --size_;
+    if (size_ == 0) {
+        // Views still holding the chunks keep them alive
+        chunks_.clear();
+        head_ = 0;
+        tail_ = 0;
+        dead_ = 0;
+    } else if (++head_ == chunks_.front()->capacity) {
+        chunks_.pop_front();
+        head_ = 0;
+    }
+}
+
+void EventCorrelator::IdList::remove(uint64_t id, const EventMap& live) {
+    if (empty()) {
+        return;
+    }
+    if (front() == id) {
+        pop_front();
+    } else {
+        ++dead_;
     }
     
-    if (auto corr = correlate_by_service(event)) {
-        found_correlations.push_back(*corr);
+    // Earlier out-of-order evictions may now have reached the front
+    while (dead_ > 0 && !empty() && live.find(front()) == live.end()) {
+        pop_front();
+        --dead_;
     }
     
-    if (auto corr = correlate_by_time(event)) {
-        found_correlations.push_back(*corr);
+    // Rebuilding costs the live ids, paid for by as many evictions
+    if (dead_ > 0 && dead_ * 2 > size_) {
+        compact(live);
     }
+}
+
+void EventCorrelator::IdList::compact(const EventMap& live) {
+    EventIdView members;
+    members.append(prefix(size_));
+    
+    IdList kept;
+    for (uint64_t id : members) {
+        if (live.find(id) != live.end()) {
+            kept.push_back(id);
+        }
+    }
+    kept.latest = std::move(latest);
+    *this = std::move(kept);
+}
+
+EventIdView::Segment EventCorrelator::IdList::prefix(size_t count) const {
+    if (count == 0) {
+        return {nullptr, 0, 0};
+    }
+    return {chunks_.front(), head_, std::min(count, size_)};
+}
+
+//=============================================================================
+// EventCorrelator Implementation
+//=============================================================================
+
+std::vector<CorrelationPtr> EventCorrelator::correlate(const LogEvent& event) {
+    return correlate(std::make_shared<const LogEvent>(event));
+}
+
+std::vector<CorrelationPtr> EventCorrelator::correlate(const LogEventPtr& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return correlate_locked(event);
+}
+
+std::vector<std::vector<CorrelationPtr>> EventCorrelator::correlate_batch(
+    const std::vector<LogEventPtr>& events) {
     
-    // Store event
-    EventRecord record;
-    record.event = event;
-    events_[event.event_id()] = record;
+    std::vector<std::vector<CorrelationPtr>> results;
+    results.reserve(events.size());
     
-    // Update indices
-    if (!event.trace_id().empty()) {
-        trace_id_index_[event.trace_id()].push_back(event.event_id());
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& event : events) {
+        results.push_back(correlate_locked(event));
     }
     
-    for (const auto& [key, value] : event.entities()) {
-        entity_index_[value].push_back(event.event_id());
-    }
+    return results;
+}
+
+std::vector<CorrelationPtr> EventCorrelator::correlate_locked(const LogEventPtr& event_ptr) {
+    const LogEvent& event = *event_ptr;
     
-    if (!event.service_name().empty()) {
-        service_index_[event.service_name()].push_back(event.event_id());
+    if (event.timestamp() > newest_) {
+        newest_ = std::min(event.timestamp(),
+                           std::chrono::system_clock::now() + config_.max_clock_skew);
     }
     
-    // Store correlations
-    for (const auto& corr : found_correlations) {
-        correlations_.push_back(corr);
+    // Store and index the event first; every correlation is then a view of
+    // the lists it just joined
+    auto& record = events_[event.event_id()];
+    record.event = event_ptr;
+    record.correlations.clear();
+    index_event(event.event_id(), event);
+    
+    for (auto& corr : {correlate_by_trace_id(event), correlate_by_entities(event),
+                       correlate_by_service(event), correlate_by_time(event)}) {
+        if (corr) {
+            record.correlations.push_back(corr);
+            correlations_.push_back(corr);
+        }
     }
+    std::vector<CorrelationPtr> found_correlations = record.correlations;
+    
+    // Amortized expiry: each event pays for a bounded slice of the backlog
+    expire_locked(newest_ - config_.max_age, config_.expire_batch);
     
     return found_correlations;
 }
 
-std::optional<Correlation> EventCorrelator::correlate_by_trace_id(const LogEvent& event) {
+CorrelationPtr EventCorrelator::correlate_by_trace_id(const LogEvent& event) {
     if (event.trace_id().empty()) {
-        return std::nullopt;
+        return nullptr;
     }
     
-    auto it = trace_id_index_.find(event.trace_id());
-    if (it == trace_id_index_.end() || it->second.empty()) {
-        return std::nullopt;
+    auto it = trace_id_index_.find(index_key(event.trace_id()));
+    if (it == trace_id_index_.end() || it->second.size() < 2) {
+        return nullptr;
     }
     
-    Correlation corr;
-    corr.correlation_type = "trace_id";
-    corr.confidence = 1.0;
-    corr.reason = "Events share trace ID: " + event.trace_id();
-    corr.first_event_time = event.timestamp();
-    corr.last_event_time = event.timestamp();
+    auto corr = std::make_shared<Correlation>();
+    corr->correlation_type = "trace_id";
+    corr->confidence = 1.0;
+    corr->reason = "Events share trace ID: " + event.trace_id();
+    corr->first_event_time = event.timestamp();
+    corr->last_event_time = event.timestamp();
     
-    corr.event_ids = it->second;
-    corr.event_ids.push_back(event.event_id());
+    // Earlier members of the trace followed by this event
+    corr->event_ids.append(it->second.prefix(it->second.size()));
     
-    corr.metadata["trace_id"] = event.trace_id();
+    corr->metadata["trace_id"] = event.trace_id();
     
+    it->second.latest = corr;
     return corr;
 }
 
-std::optional<Correlation> EventCorrelator::correlate_by_entities(const LogEvent& event) {
-    std::unordered_set<uint64_t> related_events;
+CorrelationPtr EventCorrelator::correlate_by_entities(const LogEvent& event) {
+    std::vector<IdList*> shared;
     
     for (const auto& [key, value] : event.entities()) {
-        auto it = entity_index_.find(value);
-        if (it != entity_index_.end()) {
-            for (uint64_t id : it->second) {
-                if (id != event.event_id()) {
-                    related_events.insert(id);
-                }
-            }
+        auto it = entity_index_.find(index_key(value));
+        if (it != entity_index_.end() && it->second.size() > 1 &&
+            std::find(shared.begin(), shared.end(), &it->second) == shared.end()) {
+            shared.push_back(&it->second);
         }
     }
     
-    if (related_events.empty()) {
-        return std::nullopt;
+    if (shared.empty()) {
+        return nullptr;
     }
     
-    Correlation corr;
-    corr.correlation_type = "entity";
-    corr.confidence = 0.8;
-    corr.reason = "Events share common entities";
-    corr.first_event_time = event.timestamp();
-    corr.last_event_time = event.timestamp();
-    
-    corr.event_ids.assign(related_events.begin(), related_events.end());
-    corr.event_ids.push_back(event.event_id());
+    auto corr = std::make_shared<Correlation>();
+    corr->correlation_type = "entity";
+    corr->confidence = 0.8;
+    corr->reason = "Events share common entities";
+    corr->first_event_time = event.timestamp();
+    corr->last_event_time = event.timestamp();
+    
+    // Every list ends with this event; keep it only in the last segment
+    for (size_t i = 0; i < shared.size(); ++i) {
+        size_t count = shared[i]->size() - (i + 1 < shared.size() ? 1 : 0);
+        corr->event_ids.append(shared[i]->prefix(count));
+    }
     
+    for (IdList* list : shared) {
+        list->latest = corr;
+    }
     return corr;
 }
 
-std::optional<Correlation> EventCorrelator::correlate_by_service(const LogEvent& event) {
+CorrelationPtr EventCorrelator::correlate_by_service(const LogEvent& event) {
     if (event.service_name().empty()) {
-        return std::nullopt;
+        return nullptr;
     }
     
-    auto it = service_index_.find(event.service_name());
-    if (it == service_index_.end() || it->second.empty()) {
-        return std::nullopt;
+    auto it = service_index_.find(event.service_symbol().id());
+    if (it == service_index_.end()) {
+        return nullptr;
     }
     
     // Only correlate recent events from same service (last minute)
-    std::vector<uint64_t> recent_events;
+    EventIdView recent_events;
     auto cutoff = event.timestamp() - std::chrono::minutes(1);
+    it->second.window(cutoff, timestamp_t::max(), recent_events);
     
-    for (uint64_t id : it->second) {
-        auto event_it = events_.find(id);
-        if (event_it != events_.end() && 
-            event_it->second.event.timestamp() >= cutoff) {
-            recent_events.push_back(id);
-        }
+    // The event itself is one of them
+    if (recent_events.size() < 2) {
+        return nullptr;
     }
     
-    if (recent_events.empty()) {
-        return std::nullopt;
-    }
-    
-    Correlation corr;
-    corr.correlation_type = "service";
-    corr.confidence = 0.6;
-    corr.reason = "Events from same service: " + event.service_name();
-    corr.first_event_time = event.timestamp();
-    corr.last_event_time = event.timestamp();
-    corr.event_ids = recent_events;
-    corr.event_ids.push_back(event.event_id());
-    corr.metadata["service"] = event.service_name();
+    auto corr = std::make_shared<Correlation>();
+    corr->correlation_type = "service";
+    corr->confidence = 0.6;
+    corr->reason = "Events from same service: " + event.service_name();
+    corr->first_event_time = event.timestamp();
+    corr->last_event_time = event.timestamp();
+    corr->event_ids = std::move(recent_events);
+    corr->metadata["service"] = event.service_name();
     
     return corr;
 }
 
-std::optional<Correlation> EventCorrelator::correlate_by_time(const LogEvent& event) {
-    // Find events within 5 seconds
-    std::vector<uint64_t> nearby_events;
+CorrelationPtr EventCorrelator::correlate_by_time(const LogEvent& event) {
+    // Find events within 5 seconds either side
+    EventIdView nearby_events;
     auto window = std::chrono::seconds(5);
+    time_index_.window(event.timestamp() - window, event.timestamp() + window,
+                       nearby_events);
     
-    for (const auto& [id, record] : events_) {
-        auto diff = std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::abs(event.timestamp() - record.event.timestamp())
-        );
-        
-        if (diff <= window && id != event.event_id()) {
-            nearby_events.push_back(id);
-        }
-    }
-    
-    if (nearby_events.size() < 2) {
-        return std::nullopt;
+    // At least two besides the event itself
+    if (nearby_events.size() < 3) {
+        return nullptr;
     }
     
-    Correlation corr;
-    corr.correlation_type = "temporal";
-    corr.confidence = 0.4;
-    corr.reason = "Events occurred within 5 seconds";
-    corr.first_event_time = event.timestamp();
-    corr.last_event_time = event.timestamp();
-    corr.event_ids = nearby_events;
-    corr.event_ids.push_back(event.event_id());
+    auto corr = std::make_shared<Correlation>();
+    corr->correlation_type = "temporal";
+    corr->confidence = 0.4;
+    corr->reason = "Events occurred within 5 seconds";
+    corr->first_event_time = event.timestamp();
+    corr->last_event_time = event.timestamp();
+    corr->event_ids = std::move(nearby_events);
     
     return corr;
 }
 
-std::vector<Correlation> EventCorrelator::get_correlations_for_event(uint64_t event_id) const {
+std::vector<CorrelationPtr> EventCorrelator::get_correlations_for_event(uint64_t event_id) const {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    std::vector<Correlation> result;
-    for (const auto& corr : correlations_) {
-        if (std::find(corr.event_ids.begin(), corr.event_ids.end(), event_id) 
-            != corr.event_ids.end()) {
-            result.push_back(corr);
+    auto record = events_.find(event_id);
+    if (record == events_.end()) {
+        return {};
+    }
+    
+    std::vector<CorrelationPtr> result = record->second.correlations;
+    auto add_latest = [&result](const auto& index, uint64_t key) {
+        auto it = index.find(key);
+        if (it != index.end() && it->second.latest &&
+            std::find(result.begin(), result.end(), it->second.latest) == result.end()) {
+            result.push_back(it->second.latest);
         }
+    };
+    
+    const LogEvent& event = *record->second.event;
+    if (!event.trace_id().empty()) {
+        add_latest(trace_id_index_, index_key(event.trace_id()));
+    }
+    for (const auto& [key, value] : event.entities()) {
+        add_latest(entity_index_, index_key(value));
     }
     
     return result;
 }
 
-std::vector<Correlation> EventCorrelator::get_active_correlations() const {
+std::vector<CorrelationPtr> EventCorrelator::get_active_correlations() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return correlations_;
+    return std::vector<CorrelationPtr>(correlations_.begin(), correlations_.end());
 }
 
 void EventCorrelator::cleanup(duration_t max_age) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto cutoff = std::chrono::system_clock::now() - max_age;
-    
-    // Remove old events
-    for (auto it = events_.begin(); it != events_.end();) {
-        if (it->second.event.timestamp() < cutoff) {
-            it = events_.erase(it);
-        } else {
-            ++it;
+    expire_locked(std::chrono::system_clock::now() - max_age,
+                  std::numeric_limits<size_t>::max());
+}
+
+size_t EventCorrelator::event_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_.size();
+}
+
+void EventCorrelator::expire_locked(timestamp_t cutoff, size_t budget) {
+    for (size_t evicted = 0; evicted < budget && !time_index_.empty(); ++evicted) {
+        auto record = events_.find(time_index_.oldest());
+        if (record != events_.end() && record->second.event->timestamp() >= cutoff) {
+            break;
         }
+        evict_oldest_event();
     }
     
-    // Remove old correlations
-    correlations_.erase(
-        std::remove_if(correlations_.begin(), correlations_.end(),
-            [cutoff](const Correlation& corr) {
-                return corr.last_event_time < cutoff;
-            }),
-        correlations_.end()
-    );
+    while (events_.size() > config_.max_events && !time_index_.empty()) {
+        evict_oldest_event();
+    }
     
-    // Rebuild indices
-    trace_id_index_.clear();
-    entity_index_.clear();
-    service_index_.clear();
+    while (!correlations_.empty() &&
+           (correlations_.size() > config_.max_correlations ||
+            correlations_.front()->last_event_time < cutoff)) {
+        correlations_.pop_front();
+    }
+}
+
+void EventCorrelator::evict_oldest_event() {
+    uint64_t id = time_index_.oldest();
+    time_index_.pop_oldest();
     
-    for (const auto& [id, record] : events_) {
-        const auto& event = record.event;
-        
-        if (!event.trace_id().empty()) {
-            trace_id_index_[event.trace_id()].push_back(id);
+    auto record = events_.find(id);
+    if (record == events_.end()) {
+        return;
+    }
+    LogEventPtr event = std::move(record->second.event);
+    events_.erase(record);
+    
+    // Ids were appended in arrival order, so the evicted one is nearly
+    // always at the front of its lists (see IdList::remove)
+    auto unlink = [this, id](std::unordered_map<uint64_t, IdList>& index, uint64_t key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return;
         }
-        
-        for (const auto& [key, value] : event.entities()) {
-            entity_index_[value].push_back(id);
+        it->second.remove(id, events_);
+        if (it->second.empty()) {
+            index.erase(it);
         }
-        
-        if (!event.service_name().empty()) {
-            service_index_[event.service_name()].push_back(id);
+    };
+    
+    if (!event->trace_id().empty()) {
+        unlink(trace_id_index_, index_key(event->trace_id()));
+    }
+    
+    for (uint64_t key : entity_keys(*event)) {
+        unlink(entity_index_, key);
+    }
+    
+    if (!event->service_name().empty()) {
+        auto it = service_index_.find(event->service_symbol().id());
+        if (it != service_index_.end()) {
+            it->second.remove(event->timestamp(), id, events_);
+            if (it->second.empty()) {
+                service_index_.erase(it);
+            }
         }
     }
 }
 
+void EventCorrelator::index_event(uint64_t id, const LogEvent& event) {
+    if (!event.trace_id().empty()) {
+        trace_id_index_[index_key(event.trace_id())].push_back(id);
+    }
+    
+    for (uint64_t key : entity_keys(event)) {
+        entity_index_[key].push_back(id);
+    }
+    
+    if (!event.service_name().empty()) {
+        service_index_[event.service_symbol().id()].insert(event.timestamp(), id);
+    }
+    
+    time_index_.insert(event.timestamp(), id);
+}
+
+//=============================================================================
+// EventCorrelator::TimeIndex Implementation
+//=============================================================================
+
+int64_t EventCorrelator::TimeIndex::bucket_of(timestamp_t timestamp) {
+    auto since_epoch = std::chrono::duration_cast<duration_t>(timestamp.time_since_epoch());
+    int64_t bucket = since_epoch / kBucketWidth;
+    // Floor rather than truncate so pre-epoch times keep their order
+    if (since_epoch % kBucketWidth < duration_t::zero()) {
+        --bucket;
+    }
+    return bucket;
+}
+
+void EventCorrelator::TimeIndex::insert(timestamp_t timestamp, uint64_t id) {
+    buckets_[bucket_of(timestamp)].push_back(id);
+}
+
+void EventCorrelator::TimeIndex::remove(timestamp_t timestamp, uint64_t id, const EventMap& live) {
+    auto it = buckets_.find(bucket_of(timestamp));
+    if (it == buckets_.end()) {
+        return;
+    }
+    it->second.remove(id, live);
+    if (it->second.empty()) {
+        buckets_.erase(it);
+    }
+}
+
+void EventCorrelator::TimeIndex::pop_oldest() {
+    auto it = buckets_.begin();
+    it->second.pop_front();
+    if (it->second.empty()) {
+        buckets_.erase(it);
+    }
+}
+
+void EventCorrelator::TimeIndex::window(timestamp_t from, timestamp_t to, EventIdView& out) const {
+    if (from > to) {
+        return;
+    }
+    
+    int64_t last = bucket_of(to);
+    for (auto it = buckets_.lower_bound(bucket_of(from));
+         it != buckets_.end() && it->first <= last; ++it) {
+        out.append(it->second.prefix(it->second.size()));
+    }
+}
+
 //=============================================================================
 // CausalityAnalyzer Implementation
 //=============================================================================
@@ -278,58 +567,127 @@ std::string CausalityAnalyzer::CausalRelationship::description() const {
     return oss.str();
 }
 
+void CausalityAnalyzer::Decayed::add(timestamp_t now, duration_t half_life) {
+    weight = at(now, half_life) + 1.0;
+    updated = std::max(updated, now);
+}
+
+double CausalityAnalyzer::Decayed::at(timestamp_t now, duration_t half_life) const {
+    if (weight == 0.0 || now <= updated) {
+        return weight;
+    }
+    double half_lives = std::chrono::duration<double>(now - updated).count() /
+                        std::chrono::duration<double>(half_life).count();
+    return weight * std::exp2(-half_lives);
+}
+
+CausalityAnalyzer::CausalRelationship CausalityAnalyzer::current(
+    const EventPair& pair, const Learned& learned) const {
+    
+    CausalRelationship rel = learned.rel;
+    double followed = learned.followed.at(latest_, config_.half_life);
+    double occurred = 0.0;
+    auto it = occurrences_.find(pair.cause_type);
+    if (it != occurrences_.end()) {
+        occurred = it->second.at(latest_, config_.half_life);
+    }
+    
+    // Occurrences decay from when the cause happened and follow-ups from
+    // when the effect did, so the ratio can overshoot 1 by a hair
+    rel.strength = std::min(1.0, (followed + learned.prior * kPriorWeight) /
+                                 (occurred + kPriorWeight));
+    return rel;
+}
+
 std::vector<CausalityAnalyzer::CausalRelationship> CausalityAnalyzer::analyze(
     const LogEvent& event,
-    const std::deque<LogEvent>& context) {
+    const EventHistory& /*context*/) {
     
     std::lock_guard<std::mutex> lock(mutex_);
     
     std::vector<CausalRelationship> found;
+    auto cutoff = event.timestamp() - config_.window;
     
-    // Look for known causal relationships
-    for (const auto& prev_event : context) {
-        EventPair pair{prev_event.event_type(), event.event_type()};
+    // Look for known causal relationships from recently seen types
+    for (const auto& recent : recent_) {
+        if (recent.last_seen < cutoff || recent.last_event_id == event.event_id()) {
+            continue;
+        }
+        EventPair pair{recent.type.id(), event.event_type_symbol().id()};
         
         auto it = relationships_.find(pair);
         if (it != relationships_.end()) {
-            found.push_back(it->second);
+            found.push_back(current(pair, it->second));
         }
     }
     
     return found;
 }
 
-void CausalityAnalyzer::learn(const LogEvent& event, const std::deque<LogEvent>& context) {
+void CausalityAnalyzer::learn(const LogEvent& event, const EventHistory& /*context*/) {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Look at recent events (last 60 seconds)
-    auto cutoff = event.timestamp() - std::chrono::seconds(60);
-    
-    for (const auto& prev_event : context) {
-        if (prev_event.timestamp() < cutoff) {
+    learn_locked(event);
+}
+
+void CausalityAnalyzer::learn_batch(const std::vector<LogEventPtr>& events,
+                                    EventHistory& /*context*/) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& event : events) {
+        learn_locked(*event);
+    }
+}
+
+void CausalityAnalyzer::learn_locked(const LogEvent& event) {
+    auto now = event.timestamp();
+    auto cutoff = now - config_.window;
+    Symbol type = event.event_type_symbol();
+    latest_ = std::max(latest_, now);
+    
+    RecentType* own = nullptr;
+    for (size_t i = 0; i < recent_.size();) {
+        RecentType& recent = recent_[i];
+        if (recent.last_seen < cutoff) {
+            recent = recent_.back();
+            recent_.pop_back();
             continue;
         }
+        if (recent.type == type) {
+            own = &recent;
+        }
         
-        EventPair pair{prev_event.event_type(), event.event_type()};
-        
-        auto& rel = relationships_[pair];
-        if (rel.observed_count == 0) {
+        EventPair pair{recent.type.id(), type.id()};
+        auto& learned = relationships_[pair];
+        auto& rel = learned.rel;
+        if (rel.observed_count == 0 && rel.cause_event_type.empty()) {
             // New relationship
-            rel.cause_event_type = prev_event.event_type();
-            rel.effect_event_type = event.event_type();
+            rel.cause_event_type = recent.type.str();
+            rel.effect_event_type = type.str();
             rel.type = CausalityType::PRECEDES;
-            rel.strength = 0.1;
-            rel.typical_delay = event.timestamp() - prev_event.timestamp();
+            rel.strength = learned.prior;
+            rel.typical_delay = duration_t::zero();
+        }
+        
+        // One follow-up per occurrence of the cause, however many times
+        // this effect repeats after it
+        if (learned.credited != recent.last_seen) {
+            learned.followed.add(now, config_.half_life);
+            learned.credited = recent.last_seen;
         }
         
         rel.observed_count++;
         
         // Update typical delay (running average)
-        auto delay = event.timestamp() - prev_event.timestamp();
-        rel.typical_delay = (rel.typical_delay * (rel.observed_count - 1) + delay) / rel.observed_count;
-        
-        // Increase strength with more observations
-        rel.strength = std::min(1.0, rel.strength + 0.05);
+        auto delay = now - recent.last_seen;
+        rel.typical_delay += (delay - rel.typical_delay) / static_cast<int64_t>(rel.observed_count);
+        ++i;
+    }
+    
+    occurrences_[type.id()].add(now, config_.half_life);
+    if (own) {
+        own->last_seen = std::max(own->last_seen, now);
+        own->last_event_id = event.event_id();
+    } else {
+        recent_.push_back({type, now, event.event_id()});
     }
 }
 
@@ -337,8 +695,8 @@ std::vector<CausalityAnalyzer::CausalRelationship> CausalityAnalyzer::get_known_
     std::lock_guard<std::mutex> lock(mutex_);
     
     std::vector<CausalRelationship> result;
-    for (const auto& [pair, rel] : relationships_) {
-        result.push_back(rel);
+    for (const auto& [pair, learned] : relationships_) {
+        result.push_back(current(pair, learned));
     }
     
     return result;
@@ -347,8 +705,108 @@ std::vector<CausalityAnalyzer::CausalRelationship> CausalityAnalyzer::get_known_
 void CausalityAnalyzer::register_relationship(const CausalRelationship& rel) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    EventPair pair{rel.cause_event_type, rel.effect_event_type};
-    relationships_[pair] = rel;
+    EventPair pair{SymbolTable::intern(rel.cause_event_type).id(),
+                   SymbolTable::intern(rel.effect_event_type).id()};
+    Learned learned;
+    learned.rel = rel;
+    learned.prior = rel.strength;
+    relationships_[pair] = std::move(learned);
+}
+
+// u8 version, varint relationship count, then (str cause, str effect,
+// u8 type, f64 strength, duration typical_delay, varint observed_count,
+// f64 prior, f64 followed weight, time followed updated, time credited),
+// then varint type count and (str type, f64 weight, time updated) per type.
+// Version 1 has the relationship fields up to observed_count only.
+void CausalityAnalyzer::serialize_state(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, relationships_.size());
+    for (const auto& [pair, learned] : relationships_) {
+        CausalRelationship rel = current(pair, learned);
+        put_str(out, rel.cause_event_type);
+        put_str(out, rel.effect_event_type);
+        out += static_cast<char>(rel.type);
+        put_double(out, rel.strength);
+        put_duration(out, rel.typical_delay);
+        put_varint(out, rel.observed_count);
+        put_double(out, learned.prior);
+        put_double(out, learned.followed.weight);
+        put_time(out, learned.followed.updated);
+        put_time(out, learned.credited);
+    }
+    
+    put_varint(out, occurrences_.size());
+    for (const auto& [type, occurred] : occurrences_) {
+        put_str(out, SymbolTable::from_id(type).str());
+        put_double(out, occurred.weight);
+        put_time(out, occurred.updated);
+    }
+}
+
+bool CausalityAnalyzer::restore_state(std::string_view data) {
+    BinaryReader in(data);
+    std::vector<Learned> restored;
+    std::vector<std::pair<std::string, Decayed>> occurrences;
+    
+    uint8_t version = in.u8();
+    if (version == kStateVersion || version == kRelationshipsOnlyVersion) {
+        size_t count = in.count();
+        restored.reserve(count);
+        for (size_t i = 0; i < count && in.ok; ++i) {
+            Learned learned;
+            CausalRelationship& rel = learned.rel;
+            rel.cause_event_type = std::string(in.str());
+            rel.effect_event_type = std::string(in.str());
+            uint8_t type = in.u8();
+            if (type > static_cast<uint8_t>(CausalityType::PRECEDES)) {
+                in.ok = false;
+            }
+            rel.type = static_cast<CausalityType>(type);
+            rel.strength = in.f64();
+            rel.typical_delay = in.duration();
+            rel.observed_count = in.varint();
+            learned.prior = rel.strength;
+            if (version == kStateVersion) {
+                learned.prior = in.f64();
+                learned.followed.weight = in.f64();
+                learned.followed.updated = in.time();
+                learned.credited = in.time();
+            }
+            restored.push_back(std::move(learned));
+        }
+        
+        if (version == kStateVersion) {
+            count = in.count();
+            for (size_t i = 0; i < count && in.ok; ++i) {
+                std::string type(in.str());
+                Decayed occurred;
+                occurred.weight = in.f64();
+                occurred.updated = in.time();
+                occurrences.emplace_back(std::move(type), occurred);
+            }
+        }
+    } else {
+        in.ok = false;
+    }
+    
+    if (!in.ok || !in.at_end()) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& learned : restored) {
+        EventPair pair{SymbolTable::intern(learned.rel.cause_event_type).id(),
+                       SymbolTable::intern(learned.rel.effect_event_type).id()};
+        latest_ = std::max(latest_, learned.followed.updated);
+        relationships_[pair] = std::move(learned);
+    }
+    for (auto& [type, occurred] : occurrences) {
+        latest_ = std::max(latest_, occurred.updated);
+        occurrences_[SymbolTable::intern(type).id()] = occurred;
+    }
+    return true;
 }
 
 //=============================================================================
@@ -367,7 +825,7 @@ std::optional<RootCauseAnalyzer::RootCause> RootCauseAnalyzer::find_root_cause(
     
     RootCause root;
     root.root_event_id = correlation.event_ids.front();
-    root.affected_event_ids = correlation.event_ids;
+    root.affected_event_ids = correlation.event_ids.to_vector();
     root.confidence = correlation.confidence * 0.7;
     root.explanation = "Earliest event in correlation chain";
     
@@ -389,41 +847,95 @@ std::optional<RootCauseAnalyzer::RootCause> RootCauseAnalyzer::find_root_cause(
 
 std::optional<RootCauseAnalyzer::RootCause> RootCauseAnalyzer::find_root_cause_for_event(
     uint64_t event_id,
-    const std::deque<LogEvent>& context) {
+    const EventHistory& context) {
     
     // Get correlations for this event
     auto correlations = correlator_->get_correlations_for_event(event_id);
     
     if (correlations.empty()) {
-        return std::nullopt;
+        auto stored = correlate_from_store(event_id);
+        if (!stored) {
+            return std::nullopt;
+        }
+        return find_root_cause(*stored);
     }
     
     // Use the strongest correlation
-    auto best_corr = *std::max_element(correlations.begin(), correlations.end(),
-        [](const Correlation& a, const Correlation& b) {
-            return a.confidence < b.confidence;
+    const auto& best_corr = *std::max_element(correlations.begin(), correlations.end(),
+        [](const CorrelationPtr& a, const CorrelationPtr& b) {
+            return a->confidence < b->confidence;
         });
     
-    return find_root_cause(best_corr);
+    return find_root_cause(*best_corr);
+}
+
+std::optional<Correlation> RootCauseAnalyzer::correlate_from_store(uint64_t event_id) const {
+    if (!store_) {
+        return std::nullopt;
+    }
+    
+    auto event = store_->get(event_id);
+    if (!event || event->trace_id().empty()) {
+        return std::nullopt;
+    }
+    
+    EventQuery query;
+    query.trace_id = event->trace_id();
+    query.from = event->timestamp() - store_lookback_;
+    query.to = event->timestamp() + std::chrono::nanoseconds(1);
+    
+    auto related = store_->scan(query);
+    if (related.size() < 2) {
+        return std::nullopt;
+    }
+    
+    // Earliest first, which is what find_root_cause() expects
+    std::stable_sort(related.begin(), related.end(),
+        [](const LogEvent& a, const LogEvent& b) { return a.timestamp() < b.timestamp(); });
+    
+    Correlation corr;
+    corr.correlation_type = "trace_id";
+    corr.confidence = 1.0;
+    corr.reason = "Events share trace ID: " + event->trace_id() + " (from event store)";
+    corr.first_event_time = related.front().timestamp();
+    corr.last_event_time = related.back().timestamp();
+    std::vector<uint64_t> ids;
+    ids.reserve(related.size());
+    for (const auto& e : related) {
+        ids.push_back(e.event_id());
+    }
+    corr.event_ids = EventIdView(ids);
+    corr.metadata["trace_id"] = event->trace_id();
+    
+    return corr;
 }
 
 //=============================================================================
 // CorrelationEngine Implementation
 //=============================================================================
 
-void CorrelationEngine::process(const LogEvent& event, const std::deque<LogEvent>& context) {
+void CorrelationEngine::process(const LogEvent& event, const EventHistory& context) {
     // Find correlations
     correlator_->correlate(event);
     
+    // Analyze causality against the types learned before this event
+    auto causal_rels = causality_->analyze(event, context);
+    
     // Learn causal relationships
     causality_->learn(event, context);
     
-    // Analyze causality
-    auto causal_rels = causality_->analyze(event, context);
-    
     // Could trigger callbacks here for significant correlations/causality
 }
 
+std::vector<std::vector<CorrelationPtr>> CorrelationEngine::process_batch(
+    const std::vector<LogEventPtr>& events,
+    EventHistory& context) {
+    
+    auto correlations = correlator_->correlate_batch(events);
+    causality_->learn_batch(events, context);
+    return correlations;
+}
+
 void CorrelationEngine::register_builtin_relationships() {
     // Database → API causality
     CausalityAnalyzer::CausalRelationship db_api;
@@ -1,18 +1,105 @@
 #include "curl_helper.h"
 #include <cstring>
+#include <mutex>
+#include <vector>
 
 namespace agentlog {
 
+namespace {
+
+// Idle handles kept for reuse; beyond this they are cleaned up
+constexpr size_t kMaxIdleHandles = 8;
+
+/**
+ * Process-wide pool of easy handles sharing one DNS, TLS-session and
+ * connection cache. Intentionally never destroyed so that integrations
+ * running during static destruction still find it alive.
+ */
+class CurlPool {
+public:
+    static CurlPool& instance() {
+        static CurlPool* pool = new CurlPool();
+        return *pool;
+    }
+
+    CURL* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+                CURL* handle = idle_.back();
+                idle_.pop_back();
+                return handle;
+            }
+        }
+        CURL* handle = curl_easy_init();
+        if (handle && share_) {
+            curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+        }
+        return handle;
+    }
+
+    void release(CURL* handle) {
+        // Reset clears per-request options but keeps the handle's live
+        // connections, which is the point of pooling it
+        curl_easy_reset(handle);
+        if (share_) {
+            curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (idle_.size() < kMaxIdleHandles) {
+                idle_.push_back(handle);
+                return;
+            }
+        }
+        curl_easy_cleanup(handle);
+    }
+
+private:
+    CurlPool() {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        share_ = curl_share_init();
+        if (share_) {
+            curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lock_share);
+            curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlock_share);
+            curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        }
+    }
+
+    static void lock_share(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+        static_cast<CurlPool*>(userp)->share_mutex(data).lock();
+    }
+
+    static void unlock_share(CURL*, curl_lock_data data, void* userp) {
+        static_cast<CurlPool*>(userp)->share_mutex(data).unlock();
+    }
+
+    std::mutex& share_mutex(curl_lock_data data) {
+        size_t index = static_cast<size_t>(data);
+        return share_mutexes_[index < CURL_LOCK_DATA_LAST ? index : 0];
+    }
+
+    CURLSH* share_{nullptr};
+    std::mutex share_mutexes_[CURL_LOCK_DATA_LAST];
+    std::mutex mutex_;
+    std::vector<CURL*> idle_;
+};
+
+} // namespace
+
 CurlHelper::CurlHelper() {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl_ = curl_easy_init();
+    curl_ = CurlPool::instance().acquire();
 }
 
 CurlHelper::~CurlHelper() {
     if (curl_) {
-        curl_easy_cleanup(curl_);
+        CurlPool::instance().release(curl_);
     }
-    curl_global_cleanup();
 }
 
 size_t CurlHelper::write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
@@ -60,6 +147,14 @@ CurlHelper::Response CurlHelper::post(const std::string& url,
     curl_easy_setopt(curl_, CURLOPT_CONNECTTIMEOUT, 5L);
     curl_easy_setopt(curl_, CURLOPT_TIMEOUT, 10L);
     
+    // Keep pooled connections alive between incident notifications
+    curl_easy_setopt(curl_, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl_, CURLOPT_TCP_KEEPIDLE, 60L);
+    curl_easy_setopt(curl_, CURLOPT_TCP_KEEPINTVL, 30L);
+    
+    // Worker threads must not receive SIGALRM from resolver timeouts
+    curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L);
+    
     // Enable SSL verification
     curl_easy_setopt(curl_, CURLOPT_SSL_VERIFYPEER, 1L);
     curl_easy_setopt(curl_, CURLOPT_SSL_VERIFYHOST, 2L);
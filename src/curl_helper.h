@@ -7,7 +7,11 @@
 
 namespace agentlog {
 
-// Helper class for HTTPS POST requests using libcurl
+// Helper class for HTTPS POST requests using libcurl.
+//
+// Easy handles are borrowed from a process-wide pool and returned on
+// destruction, so each CurlHelper reuses warm keep-alive connections, DNS
+// entries and TLS sessions instead of handshaking from scratch.
 class CurlHelper {
 public:
     struct Response {
@@ -19,6 +23,9 @@ public:
     CurlHelper();
     ~CurlHelper();
 
+    CurlHelper(const CurlHelper&) = delete;
+    CurlHelper& operator=(const CurlHelper&) = delete;
+
     // Perform HTTPS POST request
     Response post(const std::string& url, 
                   const std::string& json_body,
@@ -3,186 +3,517 @@
 
 #include "agentlog/event.h"
 #include "agentlog/logger.h"
-#include <sstream>
-#include <iomanip>
+#include "binary_codec.h"
+#include "symbolizer.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <ctime>
 
 #ifdef __GNUC__
 #include <execinfo.h>
-#include <cxxabi.h>
 #endif
 
 namespace agentlog {
 
+// Local-time "YYYY-MM-DD HH:MM:SS" for ts. localtime() is slow and takes a
+// global lock, and consecutive events nearly always share a second, so each
+// thread caches the text for the last second it formatted.
+static const char* format_local_seconds(timestamp_t ts) {
+    thread_local std::time_t cached_second = -1;
+    thread_local char cached_text[32];
+    
+    std::time_t second = std::chrono::system_clock::to_time_t(ts);
+    if (second != cached_second) {
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &second);
+#else
+        localtime_r(&second, &tm);
+#endif
+        std::strftime(cached_text, sizeof(cached_text), "%Y-%m-%d %H:%M:%S", &tm);
+        cached_second = second;
+    }
+    return cached_text;
+}
+
 LogEvent& LogEvent::capture_stack_trace(size_t max_frames) {
 #ifdef __GNUC__
     void* buffer[256];
-    int frames = backtrace(buffer, std::min(max_frames, size_t(256)));
-    char** symbols = backtrace_symbols(buffer, frames);
-    
-    if (symbols) {
-        for (int i = 0; i < frames; ++i) {
-            std::string symbol = symbols[i];
-            
-            // Parse symbol: module(function+offset) [address]
-            StackFrame frame;
-            
-            size_t paren_start = symbol.find('(');
-            size_t paren_end = symbol.find('+');
-            
-            if (paren_start != std::string::npos && paren_end != std::string::npos) {
-                frame.module = symbol.substr(0, paren_start);
-                std::string mangled = symbol.substr(paren_start + 1, paren_end - paren_start - 1);
-                
-                // Demangle C++ names
-                int status;
-                char* demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
-                if (status == 0 && demangled) {
-                    frame.function = demangled;
-                    free(demangled);
-                } else {
-                    frame.function = mangled;
-                }
-            } else {
-                frame.function = symbol;
+    int frames = backtrace(buffer, static_cast<int>(std::min(max_frames, size_t(256))));
+    stack_addresses_.assign(reinterpret_cast<uintptr_t*>(buffer),
+                            reinterpret_cast<uintptr_t*>(buffer) + std::max(frames, 0));
+#endif
+    return *this;
+}
+
+LogEvent& LogEvent::symbolize_stack_trace() {
+    if (!stack_addresses_.empty()) {
+        detail::Symbolizer::instance().resolve(stack_addresses_, stack_trace_);
+        stack_addresses_.clear();
+        stack_addresses_.shrink_to_fit();
+    }
+    return *this;
+}
+
+//=============================================================================
+// Text and JSON serialization
+//=============================================================================
+
+namespace {
+
+void append_uint(std::string& out, uint64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void append_int(std::string& out, int64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+// Shortest representation that round-trips; JSON has no NaN/Infinity
+void append_json_double(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+// Six significant digits, matching what operator<< used to print
+void append_text_double(std::string& out, double value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6);
+    out.append(buf, result.ptr);
+}
+
+void append_json_string(std::string& out, std::string_view value) {
+    static const char* hex = "0123456789abcdef";
+    
+    out += '"';
+    size_t run_start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        
+        // Copy the clean run in one go, then the escape
+        out.append(value.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out.append(escaped, sizeof(escaped));
             }
-            
-            stack_trace_.push_back(frame);
         }
-        free(symbols);
     }
-#endif
-    return *this;
+    out.append(value.data() + run_start, value.size() - run_start);
+    out += '"';
+}
+
+template<typename Map, typename WriteValue>
+void append_json_object(std::string& out, const char* name, const Map& map, WriteValue write_value) {
+    out += '"';
+    out += name;
+    out += "\":{";
+    bool first = true;
+    for (const auto& [key, value] : map) {
+        if (!first) out += ',';
+        append_json_string(out, static_cast<const std::string&>(key));  // Symbol or string
+        out += ':';
+        write_value(value);
+        first = false;
+    }
+    out += "},";
 }
 
+} // namespace
+
 std::string LogEvent::to_json() const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"event_id\":" << event_id_ << ",";
-    oss << "\"event_type\":\"" << event_type_ << "\",";
-    oss << "\"timestamp\":" << std::chrono::duration_cast<std::chrono::milliseconds>(
-        timestamp_.time_since_epoch()).count() << ",";
-    oss << "\"severity\":\"" << severity_to_string(severity_) << "\",";
+    std::string out;
+    to_json(out);
+    return out;
+}
+
+void LogEvent::to_json(std::string& out) const {
+    out += "{\"event_id\":";
+    append_uint(out, event_id_);
+    out += ",\"event_type\":";
+    append_json_string(out, event_type_.str());
+    out += ",\"timestamp\":";
+    append_int(out, std::chrono::duration_cast<std::chrono::milliseconds>(
+        timestamp_.time_since_epoch()).count());
+    out += ",\"severity\":\"";
+    out += severity_to_string(severity_);
+    out += "\",";
     
     if (!message_.empty()) {
-        oss << "\"message\":\"" << message_ << "\",";
+        out += "\"message\":";
+        append_json_string(out, message_);
+        out += ',';
     }
     
     if (!service_name_.empty()) {
-        oss << "\"service\":\"" << service_name_ << "\",";
+        out += "\"service\":";
+        append_json_string(out, service_name_.str());
+        out += ',';
     }
     
     if (!trace_id_.empty()) {
-        oss << "\"trace_id\":\"" << trace_id_ << "\",";
+        out += "\"trace_id\":";
+        append_json_string(out, trace_id_);
+        out += ',';
     }
     
-    // Entities
+    auto write_string = [&](const std::string& value) { append_json_string(out, value); };
+    
     if (!entities_.empty()) {
-        oss << "\"entities\":{";
-        bool first = true;
-        for (const auto& [key, value] : entities_) {
-            if (!first) oss << ",";
-            oss << "\"" << key << "\":\"" << value << "\"";
-            first = false;
-        }
-        oss << "},";
+        append_json_object(out, "entities", entities_, write_string);
     }
     
-    // Metrics
     if (!metrics_.empty()) {
-        oss << "\"metrics\":{";
-        bool first = true;
-        for (const auto& [key, value] : metrics_) {
-            if (!first) oss << ",";
-            oss << "\"" << key << "\":" << value;
-            first = false;
-        }
-        oss << "},";
+        append_json_object(out, "metrics", metrics_,
+                           [&](double value) { append_json_double(out, value); });
     }
     
-    // Context
     if (!context_.empty()) {
-        oss << "\"context\":{";
-        bool first = true;
-        for (const auto& [key, value] : context_) {
-            if (!first) oss << ",";
-            oss << "\"" << key << "\":\"" << value << "\"";
-            first = false;
-        }
-        oss << "},";
+        append_json_object(out, "context", context_, write_string);
     }
     
     // AI fields
-    oss << "\"anomaly_score\":" << anomaly_score_;
+    out += "\"anomaly_score\":";
+    append_json_double(out, anomaly_score_);
     
     if (incident_id_) {
-        oss << ",\"incident_id\":\"" << *incident_id_ << "\"";
+        out += ",\"incident_id\":";
+        append_json_string(out, *incident_id_);
     }
     
-    oss << "}";
-    return oss.str();
+    out += '}';
 }
 
 std::string LogEvent::to_string() const {
-    std::ostringstream oss;
-    
+    std::string out;
+    to_string(out);
+    return out;
+}
+
+void LogEvent::to_string(std::string& out) const {
     // Timestamp
-    auto time_t = std::chrono::system_clock::to_time_t(timestamp_);
-    oss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    out += format_local_seconds(timestamp_);
     
     // Severity
-    oss << " [" << severity_to_string(severity_) << "]";
+    out += " [";
+    out += severity_to_string(severity_);
+    out += ']';
     
     // Service
     if (!service_name_.empty()) {
-        oss << " [" << service_name_;
+        out += " [";
+        out += service_name_.str();
         if (!service_instance_.empty()) {
-            oss << ":" << service_instance_;
+            out += ':';
+            out += service_instance_;
         }
-        oss << "]";
+        out += ']';
     }
     
     // Event type
-    oss << " " << event_type_;
+    out += ' ';
+    out += event_type_.str();
     
     // Message
     if (!message_.empty()) {
-        oss << " - " << message_;
+        out += " - ";
+        out += message_;
     }
     
     // Entities
     if (!entities_.empty()) {
-        oss << " {";
+        out += " {";
         bool first = true;
         for (const auto& [key, value] : entities_) {
-            if (!first) oss << ", ";
-            oss << key << "=" << value;
+            if (!first) out += ", ";
+            out += key.str();
+            out += '=';
+            out += value;
             first = false;
         }
-        oss << "}";
+        out += '}';
     }
     
     // Metrics
     if (!metrics_.empty()) {
-        oss << " [";
+        out += " [";
         bool first = true;
         for (const auto& [key, value] : metrics_) {
-            if (!first) oss << ", ";
-            oss << key << "=" << value;
+            if (!first) out += ", ";
+            out += key;
+            out += '=';
+            append_text_double(out, value);
             first = false;
         }
-        oss << "]";
+        out += ']';
     }
     
     // Anomaly indicator
     if (is_anomalous()) {
-        oss << " ⚠️ ANOMALY(" << anomaly_score_ << ")";
+        out += " ⚠️ ANOMALY(";
+        append_text_double(out, anomaly_score_);
+        out += ')';
     }
+}
+
+//=============================================================================
+// Binary serialization
+//
+// A record is a 4-byte little-endian length followed by that many bytes:
+//
+//   u8      format version (1)
+//   varint  event_id
+//   varint  timestamp, nanoseconds since epoch (zigzag)
+//   u8      severity
+//   f64     anomaly_score (IEEE-754, little-endian)
+//   str     event_type, message, service_name, service_instance,
+//           trace_id, span_id
+//   u8      has incident_id, then str incident_id if set
+//   varint  entity count, then (str key, str value) pairs
+//   varint  metric count, then (str key, f64 value) pairs
+//   varint  context count, then (str key, str value) pairs
+//   varint  tag count, then str tags
+//   varint  predicted label count, then str labels
+//   varint  frame count, then (str function, str file, varint line,
+//           str module) per frame
+//
+// where str is a varint byte length followed by the bytes.
+//=============================================================================
+
+using namespace detail;
+
+namespace {
+
+constexpr uint8_t kBinaryVersion = 1;
+
+} // namespace
+
+void LogEvent::encode_binary(std::string& out) const {
+    size_t header = out.size();
+    out.append(4, '\0');  // Length, patched below
     
-    return oss.str();
+    out += static_cast<char>(kBinaryVersion);
+    put_varint(out, event_id_);
+    put_time(out, timestamp_);
+    out += static_cast<char>(severity_);
+    put_double(out, anomaly_score_);
+    
+    put_str(out, event_type_.str());
+    put_str(out, message_);
+    put_str(out, service_name_.str());
+    put_str(out, service_instance_);
+    put_str(out, trace_id_);
+    put_str(out, span_id_);
+    
+    out += static_cast<char>(incident_id_ ? 1 : 0);
+    if (incident_id_) {
+        put_str(out, *incident_id_);
+    }
+    
+    put_varint(out, entities_.size());
+    for (const auto& [key, value] : entities_) {
+        put_str(out, key.str());
+        put_str(out, value);
+    }
+    
+    put_varint(out, metrics_.size());
+    for (const auto& [key, value] : metrics_) {
+        put_str(out, key);
+        put_double(out, value);
+    }
+    
+    put_varint(out, context_.size());
+    for (const auto& [key, value] : context_) {
+        put_str(out, key);
+        put_str(out, value);
+    }
+    
+    put_varint(out, tags_.size());
+    for (const auto& tag : tags_) {
+        put_str(out, tag);
+    }
+    
+    put_varint(out, predicted_labels_.size());
+    for (const auto& label : predicted_labels_) {
+        put_str(out, label);
+    }
+    
+    // An event encoded before the worker saw it (spilled, or encoded by
+    // the caller) resolves its frames here
+    const StackTrace* stack_trace = &stack_trace_;
+    StackTrace resolved;
+    if (!stack_addresses_.empty()) {
+        resolved = stack_trace_;
+        detail::Symbolizer::instance().resolve(stack_addresses_, resolved);
+        stack_trace = &resolved;
+    }
+    put_varint(out, stack_trace->size());
+    for (const auto& frame : *stack_trace) {
+        put_str(out, frame.function);
+        put_str(out, frame.file);
+        put_varint(out, frame.line);
+        put_str(out, frame.module);
+    }
+    
+    uint32_t length = static_cast<uint32_t>(out.size() - header - 4);
+    for (int i = 0; i < 4; ++i) {
+        out[header + i] = static_cast<char>(length >> (8 * i));
+    }
+}
+
+std::optional<LogEvent> LogEvent::decode_binary(std::string_view data, size_t* consumed,
+                                                const DecodeOptions& options, DecodeError* error) {
+    if (error) {
+        *error = DecodeError::MALFORMED;
+    }
+    if (data.size() < 4) {
+        return std::nullopt;
+    }
+    
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    uint32_t length = uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 |
+                      uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+    if (data.size() - 4 < length) {
+        return std::nullopt;
+    }
+    
+    BinaryReader in{bytes + 4, bytes + 4 + length};
+    if (in.u8() != kBinaryVersion) {
+        return std::nullopt;
+    }
+    
+    LogEvent event{DecodeTag{}};
+    event.event_id_ = in.varint();
+    if (options.fresh_id) {
+        event.event_id_ = generate_id();
+    }
+    event.timestamp_ = in.time();
+    uint8_t severity = in.u8();
+    if (severity > static_cast<uint8_t>(Severity::ALERT)) {
+        return std::nullopt;
+    }
+    event.severity_ = static_cast<Severity>(severity);
+    event.anomaly_score_ = in.f64();
+    
+    // Names are interned only once the whole record has parsed, so a
+    // truncated or refused one leaves nothing behind in the SymbolTable
+    std::string_view event_type = in.str();
+    event.message_ = std::string(in.str());
+    std::string_view service_name = in.str();
+    event.service_instance_ = std::string(in.str());
+    event.trace_id_ = std::string(in.str());
+    event.span_id_ = std::string(in.str());
+    
+    if (in.u8()) {
+        event.incident_id_ = std::string(in.str());
+    }
+    
+    // Entities are skipped now and read again below
+    BinaryReader entities = in;
+    size_t count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        in.str();
+        in.str();
+    }
+    
+    count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        std::string key(in.str());
+        event.metrics_.insert_or_assign(std::move(key), in.f64());
+    }
+    
+    count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        std::string key(in.str());
+        event.context_.insert_or_assign(std::move(key), std::string(in.str()));
+    }
+    
+    // Not reserved from the counts: a string or frame in memory is many
+    // times the byte or four it may take on the wire, so an untrusted record
+    // could ask for far more than it carries
+    count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        event.tags_.emplace_back(in.str());
+    }
+    
+    count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        event.predicted_labels_.emplace_back(in.str());
+    }
+    
+    // Three strings and a line number
+    count = in.count(4);
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        StackFrame frame;
+        frame.function = std::string(in.str());
+        frame.file = std::string(in.str());
+        frame.line = static_cast<uint32_t>(in.varint());
+        frame.module = std::string(in.str());
+        event.stack_trace_.push_back(std::move(frame));
+    }
+    
+    if (!in.ok) {
+        return std::nullopt;
+    }
+    
+    bool refused = false;
+    auto name = [&](std::string_view text) {
+        Symbol symbol = SymbolTable::intern(text, options.max_symbols);
+        refused = refused || (symbol.empty() && !text.empty());
+        return symbol;
+    };
+    event.event_type_ = name(event_type);
+    event.service_name_ = name(service_name);
+    
+    // Records were written from sorted maps, so insertion stays append-only
+    count = entities.count();
+    for (size_t i = 0; i < count && !refused; ++i) {
+        Symbol key = name(entities.str());
+        event.entities_.insert_or_assign(key, std::string(entities.str()));
+    }
+    
+    // Metric names stay strings on the event, but the anomaly detectors
+    // intern them; doing it here puts them under the same cap
+    for (auto it = event.metrics_.begin(); it != event.metrics_.end() && !refused; ++it) {
+        name(it->first);
+    }
+    
+    if (refused) {
+        if (error) {
+            *error = DecodeError::SYMBOL_LIMIT;
+        }
+        return std::nullopt;
+    }
+    
+    if (consumed) {
+        *consumed = 4 + size_t(length);
+    }
+    return event;
 }
 
 void EventBuilder::emit() {
-    Logger::instance().emit(event_);
+    Logger::instance().emit(std::move(event_));
 }
 
 } // namespace agentlog
@@ -0,0 +1,206 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_EVENT_QUEUE_H
+#define AGENTLOG_EVENT_QUEUE_H
+
+#include "agentlog/event.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace agentlog {
+namespace detail {
+
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief Bounded lock-free multi-producer/multi-consumer ring buffer
+ *
+ * Dmitry Vyukov's sequence-number design: every slot carries a sequence
+ * counter that tells producers and consumers whether it is free or full for
+ * the current lap, so a push or pop is one CAS on the shared cursor plus a
+ * release store on the slot. All slots are allocated up front; capacity is
+ * rounded up to a power of two.
+ */
+template<typename T>
+class MpmcRingBuffer {
+public:
+    explicit MpmcRingBuffer(size_t min_capacity)
+        : capacity_(round_up_pow2(min_capacity < 2 ? 2 : min_capacity))
+        , mask_(capacity_ - 1)
+        , slots_(new Slot[capacity_])
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcRingBuffer() {
+        T discarded;
+        while (try_pop(discarded)) {}
+    }
+
+    MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+    MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+    bool try_push(T&& value) {
+        return try_emplace(std::move(value));
+    }
+
+    // Constructs the element in its slot; @p args are untouched if full
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        new (slot->storage) T{std::forward<Args>(args)...};
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        T* value = std::launder(reinterpret_cast<T*>(slot->storage));
+        out = std::move(*value);
+        value->~T();
+        slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of queued elements
+    size_t size() const {
+        size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_{0};
+    alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_{0};
+};
+
+// A queued event and when it was pushed, for measuring queue wait
+struct QueuedEvent {
+    LogEvent event;
+    std::chrono::steady_clock::time_point enqueued_at;
+};
+
+} // namespace detail
+
+/**
+ * @brief Event queue between emitting threads and logger workers
+ *
+ * Producers never take a lock: push() is a single ring-buffer insert, and
+ * the only extra work is a load of the sleeper count. Workers spin briefly
+ * when the ring runs dry and then park on a condition variable, which is
+ * the only time a producer has to issue a wake-up. Likewise, producers
+ * only wait on a condition variable under the BLOCK overflow policy, and
+ * only then do workers have to wake them.
+ */
+class EventQueue {
+public:
+    explicit EventQueue(size_t capacity) : ring_(capacity) {}
+
+    // Non-blocking; returns false if the queue is full, leaving event intact
+    bool push(LogEvent&& event);
+
+    // Waits up to timeout for space; returns false, leaving event intact,
+    // if the queue is still full
+    bool push_wait(LogEvent&& event, std::chrono::microseconds timeout);
+
+    // Makes room by discarding the oldest events; returns how many were lost
+    size_t push_evicting(LogEvent&& event);
+
+    // Blocks until an event is available; returns false once shut down and drained
+    bool pop(LogEvent& event);
+
+    // Blocks for the first event, then takes up to max_events, waiting at most
+    // linger for stragglers. Appends to out, and each event's push time to
+    // enqueued_at if given; returns 0 once shut down and drained.
+    size_t pop_batch(std::vector<LogEvent>& out, size_t max_events,
+                     std::chrono::microseconds linger,
+                     std::vector<std::chrono::steady_clock::time_point>* enqueued_at = nullptr);
+
+    void shutdown();
+
+    size_t size() const { return ring_.size(); }
+    size_t capacity() const { return ring_.capacity(); }
+
+private:
+    bool pop(detail::QueuedEvent& queued);
+    bool wait_for_event(detail::QueuedEvent& event);
+    // As wait_for_event(), but gives up at deadline or shutdown
+    bool wait_until(detail::QueuedEvent& event, std::chrono::steady_clock::time_point deadline);
+    void notify_consumer();
+    void notify_producers();
+
+    detail::MpmcRingBuffer<detail::QueuedEvent> ring_;
+    std::atomic<bool> shutdown_{false};
+
+    // Only touched when a worker has run out of events
+    alignas(detail::kCacheLineSize) std::atomic<int> sleepers_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+
+    // Only touched when a producer is waiting for space
+    alignas(detail::kCacheLineSize) std::atomic<int> blocked_{0};
+    std::mutex space_mutex_;
+    std::condition_variable space_cv_;
+};
+
+} // namespace agentlog
+
+#endif // AGENTLOG_EVENT_QUEUE_H
@@ -0,0 +1,260 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "file_sink.h"
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace agentlog {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int sink_open(const std::string& path) {
+#ifdef _WIN32
+    return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+}
+
+long long sink_write(int fd, const char* data, size_t size) {
+#ifdef _WIN32
+    return ::_write(fd, data, static_cast<unsigned int>(size));
+#else
+    return ::write(fd, data, size);
+#endif
+}
+
+void sink_sync(int fd) {
+#if defined(_WIN32)
+    ::_commit(fd);
+#elif defined(__APPLE__)
+    ::fsync(fd);
+#else
+    ::fdatasync(fd);
+#endif
+}
+
+void sink_close(int fd) {
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+std::string rotated_name(const std::string& path, size_t index) {
+    return path + "." + std::to_string(index);
+}
+
+} // namespace
+
+//=============================================================================
+// FileSink Implementation
+//=============================================================================
+
+FileSink::FileSink(Config config)
+    : config_(std::move(config)) {
+    opened_ = open_file();
+    if (opened_) {
+        pending_.reserve(config_.buffer_size);
+        writer_ = std::thread(&FileSink::run, this);
+    }
+}
+
+FileSink::~FileSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    data_cv_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    close_file();
+}
+
+void FileSink::append(std::string_view data) {
+    if (!opened_ || data.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_cv_.wait(lock, [&] {
+        return pending_.empty() || pending_.size() + data.size() <= config_.max_pending;
+    });
+    pending_.append(data);
+    appended_ += data.size();
+
+    if (pending_.size() >= config_.buffer_size) {
+        data_cv_.notify_one();
+    }
+}
+
+void FileSink::flush() {
+    if (!opened_) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = appended_;
+    flush_requested_ = true;
+    data_cv_.notify_one();
+    space_cv_.wait(lock, [&] { return written_ >= target; });
+}
+
+void FileSink::run() {
+    std::string batch;
+    batch.reserve(config_.buffer_size);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        data_cv_.wait_for(lock, config_.flush_interval, [this] {
+            return stop_ || flush_requested_ || pending_.size() >= config_.buffer_size;
+        });
+        flush_requested_ = false;
+
+        if (pending_.empty()) {
+            if (stop_) {
+                break;
+            }
+            if (rotation_due()) {
+                lock.unlock();
+                rotate();
+                lock.lock();
+            }
+            continue;
+        }
+
+        // Double buffering: appenders refill the old batch's capacity
+        batch.swap(pending_);
+        space_cv_.notify_all();
+        lock.unlock();
+
+        write_all(batch);
+        if (config_.sync) {
+            sink_sync(fd_);
+        }
+        if (rotation_due()) {
+            rotate();
+        }
+
+        size_t bytes = batch.size();
+        batch.clear();
+        lock.lock();
+        written_ += bytes;
+        space_cv_.notify_all();
+    }
+}
+
+void FileSink::write_all(const std::string& data) {
+    if (fd_ < 0) {
+        return;
+    }
+
+    const char* p = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        long long n = sink_write(fd_, p, remaining);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "AgentLog: Write to " << config_.path << " failed: "
+                      << std::generic_category().message(errno) << std::endl;
+            return;
+        }
+        p += n;
+        remaining -= static_cast<size_t>(n);
+        file_bytes_ += static_cast<uint64_t>(n);
+    }
+}
+
+bool FileSink::rotation_due() const {
+    if (fd_ < 0 || file_bytes_ == 0) {
+        return false;
+    }
+    if (config_.max_file_bytes > 0 && file_bytes_ >= config_.max_file_bytes) {
+        return true;
+    }
+    return config_.rotate_interval.count() > 0 &&
+           std::chrono::steady_clock::now() - opened_at_ >= config_.rotate_interval;
+}
+
+void FileSink::rotate() {
+    close_file();
+
+    std::error_code ec;
+    size_t last = 1;
+    while (fs::exists(rotated_name(config_.path, last), ec)) {
+        ++last;
+    }
+    for (size_t i = last; i > 1; --i) {
+        fs::rename(rotated_name(config_.path, i - 1), rotated_name(config_.path, i), ec);
+    }
+    fs::rename(config_.path, rotated_name(config_.path, 1), ec);
+
+    enforce_retention();
+    open_file();
+}
+
+void FileSink::enforce_retention() {
+    if (config_.max_total_bytes == 0) {
+        return;
+    }
+
+    // Keep the newest rotated files that fit next to a full live file
+    uint64_t budget = config_.max_total_bytes;
+    uint64_t reserved = config_.max_file_bytes > 0 ? config_.max_file_bytes : 0;
+    uint64_t total = reserved;
+
+    std::error_code ec;
+    for (size_t i = 1;; ++i) {
+        std::string name = rotated_name(config_.path, i);
+        auto size = fs::file_size(name, ec);
+        if (ec) {
+            break;
+        }
+        total += size;
+        if (total > budget) {
+            fs::remove(name, ec);
+        }
+    }
+}
+
+bool FileSink::open_file() {
+    fd_ = sink_open(config_.path);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    std::error_code ec;
+    auto size = fs::file_size(config_.path, ec);
+    file_bytes_ = ec ? 0 : size;
+    opened_at_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+void FileSink::close_file() {
+    if (fd_ >= 0) {
+        sink_close(fd_);
+        fd_ = -1;
+    }
+}
+
+} // namespace agentlog
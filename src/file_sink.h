@@ -0,0 +1,86 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_FILE_SINK_H
+#define AGENTLOG_FILE_SINK_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace agentlog {
+
+/**
+ * @brief Buffered, rotating log file written by a background thread
+ *
+ * Workers format a whole batch into their own buffer and hand it over with
+ * one append(); the writer thread swaps the shared buffer out and issues a
+ * single large write() once buffer_size bytes have accumulated or
+ * flush_interval has passed (group commit). Appends only block when the
+ * writer falls more than max_pending bytes behind.
+ */
+class FileSink {
+public:
+    struct Config {
+        std::string path;
+        size_t buffer_size{64 * 1024};        // Bytes that trigger an early write
+        size_t max_pending{4 * 1024 * 1024};  // Appends block beyond this backlog
+        std::chrono::milliseconds flush_interval{200};
+        bool sync{false};                     // fdatasync() after every write
+
+        // Rotation renames path -> path.1 -> path.2 ...; the oldest files
+        // are deleted once the live and rotated files exceed max_total_bytes
+        uint64_t max_file_bytes{0};           // 0 = no size-based rotation
+        std::chrono::seconds rotate_interval{0};  // 0 = no time-based rotation
+        uint64_t max_total_bytes{0};          // 0 = keep every rotated file
+    };
+
+    explicit FileSink(Config config);
+    ~FileSink();
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    bool is_open() const { return opened_; }
+
+    // Queue bytes for writing (copied)
+    void append(std::string_view data);
+
+    // Block until everything appended so far has been written (and synced)
+    void flush();
+
+private:
+    void run();
+    void write_all(const std::string& data);
+    bool rotation_due() const;
+    void rotate();
+    void enforce_retention();
+    bool open_file();
+    void close_file();
+
+    Config config_;
+    bool opened_{false};
+    int fd_{-1};                        // Only touched by the writer after construction
+    uint64_t file_bytes_{0};
+    std::chrono::steady_clock::time_point opened_at_;
+
+    std::mutex mutex_;
+    std::condition_variable data_cv_;   // Writer waits for data
+    std::condition_variable space_cv_;  // Appenders wait for the backlog to drain
+    std::string pending_;
+    uint64_t appended_{0};              // Total bytes accepted by append()
+    uint64_t written_{0};               // Total bytes handed to the OS
+    bool flush_requested_{false};
+    bool stop_{false};
+
+    std::thread writer_;
+};
+
+} // namespace agentlog
+
+#endif // AGENTLOG_FILE_SINK_H
@@ -0,0 +1,283 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "frequency_sketch.h"
+#include "binary_codec.h"
+#include <algorithm>
+
+namespace agentlog {
+namespace detail {
+
+//=============================================================================
+// WindowBuckets Implementation
+//=============================================================================
+
+WindowBuckets::WindowBuckets(duration_t window, size_t buckets)
+    : window_(std::max(window, duration_t(1)))
+{
+    buckets = std::max<size_t>(buckets, 1);
+    bucket_ns_ = std::max<int64_t>(window_.count() / static_cast<int64_t>(buckets), 1);
+    epochs_.assign(buckets + 1, kNoEpoch);
+}
+
+int64_t WindowBuckets::epoch_of(timestamp_t ts) const {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        ts.time_since_epoch()).count();
+    int64_t epoch = ns / bucket_ns_;
+    return (ns % bucket_ns_ < 0) ? epoch - 1 : epoch;  // Floor for pre-1970 times
+}
+
+size_t WindowBuckets::slot_for(timestamp_t ts, bool& reset) {
+    int64_t epoch = epoch_of(ts);
+    int64_t count = static_cast<int64_t>(epochs_.size());
+    size_t slot = static_cast<size_t>(((epoch % count) + count) % count);
+
+    reset = false;
+    if (epochs_[slot] == epoch) {
+        return slot;
+    }
+    if (epochs_[slot] > epoch) {
+        return kDropped;  // A newer bucket already took the slot over
+    }
+    epochs_[slot] = epoch;
+    reset = true;
+    return slot;
+}
+
+void WindowBuckets::clear() {
+    std::fill(epochs_.begin(), epochs_.end(), kNoEpoch);
+}
+
+// varint slots, varint bucket ns, varint n, then n x (varint slot, svarint
+// epoch) in slot order
+void WindowBuckets::serialize(std::string& out) const {
+    put_varint(out, epochs_.size());
+    put_varint(out, static_cast<uint64_t>(bucket_ns_));
+
+    put_varint(out, std::count_if(epochs_.begin(), epochs_.end(),
+                                  [](int64_t epoch) { return epoch != kNoEpoch; }));
+    for (size_t slot = 0; slot < epochs_.size(); ++slot) {
+        if (in_use(slot)) {
+            put_varint(out, slot);
+            put_svarint(out, epochs_[slot]);
+        }
+    }
+}
+
+bool WindowBuckets::restore(BinaryReader& in, std::vector<size_t>& slots) {
+    clear();
+    slots.clear();
+
+    // A snapshot taken with another window or bucket count cannot be mapped
+    if (in.varint() != epochs_.size() || in.varint() != static_cast<uint64_t>(bucket_ns_)) {
+        in.ok = false;
+    }
+
+    size_t n = in.ok ? in.count() : 0;
+    for (size_t i = 0; i < n && in.ok; ++i) {
+        uint64_t slot = in.varint();
+        int64_t epoch = in.svarint();
+        if (slot >= epochs_.size() || in_use(slot) || epoch == kNoEpoch) {
+            in.ok = false;
+            break;
+        }
+        epochs_[slot] = epoch;
+        slots.push_back(static_cast<size_t>(slot));
+    }
+
+    if (!in.ok) {
+        clear();
+        slots.clear();
+    }
+    return in.ok;
+}
+
+//=============================================================================
+// WindowedCounter Implementation
+//=============================================================================
+
+WindowedCounter::WindowedCounter(duration_t window, size_t buckets)
+    : ring_(window, buckets)
+    , counts_(ring_.slots(), 0) {}
+
+void WindowedCounter::add(timestamp_t ts) {
+    bool reset;
+    size_t slot = ring_.slot_for(ts, reset);
+    if (slot == WindowBuckets::kDropped) {
+        return;
+    }
+    if (reset) {
+        counts_[slot] = 0;
+    }
+    ++counts_[slot];
+}
+
+uint64_t WindowedCounter::count(timestamp_t now) const {
+    uint64_t total = 0;
+    ring_.for_each_live(now, [&](size_t slot) { total += counts_[slot]; });
+    return total;
+}
+
+void WindowedCounter::clear() {
+    ring_.clear();
+    std::fill(counts_.begin(), counts_.end(), 0);
+}
+
+// Ring, then a varint count per slot in use
+void WindowedCounter::serialize(std::string& out) const {
+    ring_.serialize(out);
+    for (size_t slot = 0; slot < counts_.size(); ++slot) {
+        if (ring_.in_use(slot)) {
+            put_varint(out, counts_[slot]);
+        }
+    }
+}
+
+bool WindowedCounter::restore(BinaryReader& in) {
+    std::vector<size_t> slots;
+    std::fill(counts_.begin(), counts_.end(), 0);
+    if (!ring_.restore(in, slots)) {
+        return false;
+    }
+    for (size_t slot : slots) {
+        counts_[slot] = in.varint();
+    }
+    if (!in.ok) {
+        clear();
+    }
+    return in.ok;
+}
+
+//=============================================================================
+// WindowedCountMin Implementation
+//=============================================================================
+
+WindowedCountMin::WindowedCountMin(duration_t window, size_t buckets,
+                                   size_t width, size_t depth)
+    : ring_(window, buckets)
+    , width_(std::max<size_t>(width, 1))
+    , depth_(std::max<size_t>(depth, 1))
+    , cells_(ring_.slots() * depth_ * width_, 0) {}
+
+// FNV-1a with a final avalanche, so both halves are usable as row hashes
+uint64_t WindowedCountMin::hash(std::string_view key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Rows use h1 + row * h2 (Kirsch-Mitzenmacher) instead of depth hashes
+size_t WindowedCountMin::cell(size_t slot, size_t row, uint64_t key_hash) const {
+    uint64_t h1 = key_hash & 0xFFFFFFFFu;
+    uint64_t h2 = (key_hash >> 32) | 1;
+    return (slot * depth_ + row) * width_ + static_cast<size_t>((h1 + row * h2) % width_);
+}
+
+void WindowedCountMin::add(uint64_t key_hash, timestamp_t ts) {
+    bool reset;
+    size_t slot = ring_.slot_for(ts, reset);
+    if (slot == WindowBuckets::kDropped) {
+        return;
+    }
+    auto table = cells_.begin() + static_cast<ptrdiff_t>(slot * depth_ * width_);
+    if (reset) {
+        std::fill(table, table + static_cast<ptrdiff_t>(depth_ * width_), 0);
+    }
+
+    // Conservative update: only raise the counters at the current minimum
+    uint32_t least = UINT32_MAX;
+    for (size_t row = 0; row < depth_; ++row) {
+        least = std::min(least, cells_[cell(slot, row, key_hash)]);
+    }
+    if (least == UINT32_MAX) {
+        return;  // Saturated
+    }
+    for (size_t row = 0; row < depth_; ++row) {
+        uint32_t& counter = cells_[cell(slot, row, key_hash)];
+        counter = std::max(counter, least + 1);
+    }
+}
+
+uint64_t WindowedCountMin::estimate(uint64_t key_hash, timestamp_t now) const {
+    uint64_t best = UINT64_MAX;
+    for (size_t row = 0; row < depth_; ++row) {
+        uint64_t sum = 0;
+        ring_.for_each_live(now, [&](size_t slot) { sum += cells_[cell(slot, row, key_hash)]; });
+        best = std::min(best, sum);
+    }
+    return best;
+}
+
+void WindowedCountMin::clear() {
+    ring_.clear();
+    std::fill(cells_.begin(), cells_.end(), 0);
+}
+
+// varint width, varint depth, ring, then per slot in use varint n and n x
+// (varint cell index delta, varint counter) for its nonzero counters
+void WindowedCountMin::serialize(std::string& out) const {
+    put_varint(out, width_);
+    put_varint(out, depth_);
+    ring_.serialize(out);
+
+    size_t table = depth_ * width_;
+    for (size_t slot = 0; slot < ring_.slots(); ++slot) {
+        if (!ring_.in_use(slot)) {
+            continue;
+        }
+        auto first = cells_.begin() + static_cast<ptrdiff_t>(slot * table);
+        put_varint(out, table - std::count(first, first + static_cast<ptrdiff_t>(table), 0u));
+        size_t previous = 0;
+        for (size_t i = 0; i < table; ++i) {
+            if (uint32_t counter = first[static_cast<ptrdiff_t>(i)]) {
+                put_varint(out, i - previous);
+                put_varint(out, counter);
+                previous = i;
+            }
+        }
+    }
+}
+
+bool WindowedCountMin::restore(BinaryReader& in) {
+    std::fill(cells_.begin(), cells_.end(), 0);
+    if (in.varint() != width_ || in.varint() != depth_) {
+        in.ok = false;
+        ring_.clear();
+        return false;
+    }
+
+    std::vector<size_t> slots;
+    if (!ring_.restore(in, slots)) {
+        return false;
+    }
+
+    size_t table = depth_ * width_;
+    for (size_t slot : slots) {
+        size_t n = in.count();
+        uint64_t index = 0;
+        for (size_t i = 0; i < n && in.ok; ++i) {
+            index += in.varint();
+            uint64_t counter = in.varint();
+            if (index >= table || counter == 0 || counter > UINT32_MAX) {
+                in.ok = false;
+                break;
+            }
+            cells_[slot * table + index] = static_cast<uint32_t>(counter);
+        }
+    }
+    if (!in.ok) {
+        clear();
+    }
+    return in.ok;
+}
+
+} // namespace detail
+} // namespace agentlog
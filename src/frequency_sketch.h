@@ -0,0 +1,127 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_FREQUENCY_SKETCH_H
+#define AGENTLOG_FREQUENCY_SKETCH_H
+
+#include "agentlog/common.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agentlog {
+namespace detail {
+
+struct BinaryReader;
+
+/**
+ * @brief Fixed ring of time buckets covering a sliding window
+ *
+ * The window is split into `buckets` buckets of equal width. One more slot
+ * than that is kept, so the buckets overlapping [now - window, now] are
+ * all live. Counts therefore cover up to one bucket width more than the
+ * window, never less. A slot is reused once its bucket has aged out.
+ * Events older than every live bucket are dropped.
+ */
+class WindowBuckets {
+public:
+    static constexpr size_t kDropped = static_cast<size_t>(-1);
+
+    WindowBuckets(duration_t window, size_t buckets);
+
+    size_t slots() const { return epochs_.size(); }
+    bool in_use(size_t slot) const { return epochs_[slot] != kNoEpoch; }
+
+    // Slot that counts @p ts, or kDropped. Sets @p reset when the slot was
+    // just taken over from an expired bucket and must be zeroed.
+    size_t slot_for(timestamp_t ts, bool& reset);
+
+    // fn(slot) for every slot whose bucket overlaps [now - window, now]
+    template <typename Fn>
+    void for_each_live(timestamp_t now, Fn&& fn) const {
+        int64_t first = epoch_of(now - window_);
+        int64_t last = epoch_of(now);
+        for (size_t slot = 0; slot < epochs_.size(); ++slot) {
+            if (epochs_[slot] >= first && epochs_[slot] <= last) {
+                fn(slot);
+            }
+        }
+    }
+
+    void clear();
+
+    // Only slots in use are written; restore() reports which ones it read
+    void serialize(std::string& out) const;
+    bool restore(BinaryReader& in, std::vector<size_t>& slots);
+
+private:
+    static constexpr int64_t kNoEpoch = std::numeric_limits<int64_t>::min();  // Never held a bucket
+
+    int64_t epoch_of(timestamp_t ts) const;
+
+    duration_t window_;
+    int64_t bucket_ns_;
+    std::vector<int64_t> epochs_;  // Bucket number held by each slot
+};
+
+/**
+ * @brief Events in a sliding window, counted per time bucket
+ *
+ * Uses constant memory however many events arrive. The count covers the
+ * window plus at most one bucket width.
+ */
+class WindowedCounter {
+public:
+    WindowedCounter(duration_t window, size_t buckets);
+
+    void add(timestamp_t ts);
+    uint64_t count(timestamp_t now) const;
+    void clear();
+
+    void serialize(std::string& out) const;
+    bool restore(BinaryReader& in);
+
+private:
+    WindowBuckets ring_;
+    std::vector<uint64_t> counts_;  // Per slot
+};
+
+/**
+ * @brief Count-min sketch of key occurrences over a sliding window
+ *
+ * Each ring slot has its own depth x width table of counters, updated
+ * conservatively. A key's estimate takes the minimum over rows of that
+ * row's sum across the live slots. The estimate never undercounts; with
+ * N events in the window it overcounts by more than e * N / width with
+ * probability at most e^-depth. Memory is fixed at
+ * slots x depth x width counters.
+ */
+class WindowedCountMin {
+public:
+    WindowedCountMin(duration_t window, size_t buckets, size_t width, size_t depth);
+
+    static uint64_t hash(std::string_view key);
+
+    void add(uint64_t key_hash, timestamp_t ts);
+    uint64_t estimate(uint64_t key_hash, timestamp_t now) const;
+    void clear();
+
+    // Only nonzero counters are written
+    void serialize(std::string& out) const;
+    bool restore(BinaryReader& in);
+
+private:
+    size_t cell(size_t slot, size_t row, uint64_t key_hash) const;
+
+    WindowBuckets ring_;
+    size_t width_;
+    size_t depth_;
+    std::vector<uint32_t> cells_;  // [slot][row][column]
+};
+
+} // namespace detail
+} // namespace agentlog
+
+#endif // AGENTLOG_FREQUENCY_SKETCH_H
@@ -0,0 +1,336 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "incident_dispatcher.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+namespace agentlog {
+
+namespace {
+
+bool ends_with(const std::string& s, const char* suffix) {
+    size_t n = std::char_traits<char>::length(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// The built-in integrations report create failures in the returned ID
+bool is_retryable_id(const std::string& external_id) {
+    return ends_with(external_id, "-ERROR") || ends_with(external_id, "-EXCEPTION");
+}
+
+bool is_disabled_id(const std::string& external_id) {
+    return external_id.empty() || ends_with(external_id, "-DISABLED");
+}
+
+std::string ticket_key(const IncidentIntegration* integration, const std::string& incident_id) {
+    return std::to_string(reinterpret_cast<uintptr_t>(integration)) + '/' + incident_id;
+}
+
+} // namespace
+
+//=============================================================================
+// IncidentDispatcher Implementation
+//=============================================================================
+
+IncidentDispatcher::IncidentDispatcher(Config config, CreatedCallback on_created)
+    : config_(std::move(config))
+    , on_created_(std::move(on_created))
+    , worker_(&IncidentDispatcher::run, this) {}
+
+IncidentDispatcher::~IncidentDispatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool IncidentDispatcher::submit_create(const std::shared_ptr<IncidentIntegration>& integration,
+                                       const Incident& incident) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_ >= config_.max_pending) {
+        stats_.dropped++;
+        return false;
+    }
+
+    std::string key = ticket_key(integration.get(), incident.incident_id);
+    Ticket& ticket = ticket_for(key, integration, incident.incident_id);
+    if (!ticket.create) {
+        pending_++;
+    }
+    ticket.create = incident;
+    schedule(key, ticket);
+    return true;
+}
+
+bool IncidentDispatcher::submit_update(const std::shared_ptr<IncidentIntegration>& integration,
+                                       const Incident& incident) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string key = ticket_key(integration.get(), incident.incident_id);
+    auto it = tickets_.find(key);
+
+    // A pending resolve supersedes any update; a pending update is replaced
+    if (it != tickets_.end() && (it->second.resolution || it->second.update)) {
+        if (!it->second.resolution) {
+            it->second.update = incident;
+        }
+        stats_.coalesced++;
+        return true;
+    }
+
+    if (pending_ >= config_.max_pending) {
+        stats_.dropped++;
+        return false;
+    }
+
+    Ticket& ticket = ticket_for(key, integration, incident.incident_id);
+    pending_++;
+    ticket.update = incident;
+    schedule(key, ticket);
+    return true;
+}
+
+bool IncidentDispatcher::submit_resolve(const std::shared_ptr<IncidentIntegration>& integration,
+                                        const std::string& incident_id,
+                                        const std::string& resolution) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string key = ticket_key(integration.get(), incident_id);
+    auto it = tickets_.find(key);
+    bool has_update = it != tickets_.end() && it->second.update;
+
+    if (it != tickets_.end() && it->second.resolution) {
+        it->second.resolution = resolution;
+        stats_.coalesced++;
+        return true;
+    }
+
+    if (!has_update && pending_ >= config_.max_pending) {
+        stats_.dropped++;
+        return false;
+    }
+
+    Ticket& ticket = ticket_for(key, integration, incident_id);
+    if (has_update) {
+        // Reuse the update's slot: the resolve makes it redundant
+        ticket.update.reset();
+        stats_.coalesced++;
+    } else {
+        pending_++;
+    }
+
+    ticket.resolution = resolution;
+    schedule(key, ticket);
+    return true;
+}
+
+bool IncidentDispatcher::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return idle_cv_.wait_for(lock, timeout, [this] { return pending_ == 0; });
+}
+
+IncidentDispatcher::Stats IncidentDispatcher::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Called with work about to be added, so an idle ticket stops being one
+IncidentDispatcher::Ticket& IncidentDispatcher::ticket_for(
+    const std::string& key,
+    const std::shared_ptr<IncidentIntegration>& integration,
+    const std::string& incident_id) {
+
+    auto [it, inserted] = tickets_.try_emplace(key);
+    Ticket& ticket = it->second;
+    if (inserted) {
+        ticket.integration = integration;
+        ticket.incident_id = incident_id;
+    } else if (ticket.idle) {
+        idle_.erase(ticket.idle_pos);
+        ticket.idle = false;
+    }
+    return ticket;
+}
+
+void IncidentDispatcher::schedule(const std::string& key, Ticket& ticket) {
+    // In-flight tickets are rescheduled by the worker when their call returns
+    if (ticket.queued || ticket.in_flight) {
+        return;
+    }
+    ticket.queued = true;
+    ready_.push_back(key);
+    work_cv_.notify_one();
+}
+
+size_t IncidentDispatcher::pending_ops(const Ticket& ticket) const {
+    return (ticket.create ? 1 : 0) + (ticket.update ? 1 : 0) + (ticket.resolution ? 1 : 0);
+}
+
+void IncidentDispatcher::mark_idle(const std::string& key, Ticket& ticket) {
+    ticket.idle = true;
+    ticket.idle_since = Clock::now();
+    ticket.idle_pos = idle_.insert(idle_.end(), key);
+}
+
+void IncidentDispatcher::evict_idle(Clock::time_point now) {
+    while (!idle_.empty()) {
+        auto it = tickets_.find(idle_.front());
+        if (idle_.size() <= config_.max_idle_tickets &&
+            now - it->second.idle_since < config_.idle_ticket_timeout) {
+            break;
+        }
+        tickets_.erase(it);
+        idle_.pop_front();
+        stats_.tickets_evicted++;
+    }
+}
+
+void IncidentDispatcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stop_) {
+        // Promote tickets whose backoff has expired
+        auto now = Clock::now();
+        evict_idle(now);
+        while (!delayed_.empty() && delayed_.begin()->first <= now) {
+            ready_.push_back(std::move(delayed_.begin()->second));
+            delayed_.erase(delayed_.begin());
+        }
+
+        if (ready_.empty()) {
+            if (delayed_.empty()) {
+                work_cv_.wait(lock);
+            } else {
+                work_cv_.wait_until(lock, delayed_.begin()->first);
+            }
+            continue;
+        }
+
+        std::string key = std::move(ready_.front());
+        ready_.pop_front();
+
+        auto it = tickets_.find(key);
+        if (it == tickets_.end()) {
+            continue;
+        }
+        Ticket& ticket = it->second;
+        ticket.queued = false;
+
+        // Take the next operation out of the ticket so that submits arriving
+        // during the call queue behind it instead of being lost
+        Op op;
+        std::optional<Incident> incident;
+        std::string resolution;
+        if (ticket.create) {
+            op = Op::CREATE;
+            incident = std::move(ticket.create);
+            ticket.create.reset();
+        } else if (ticket.update) {
+            op = Op::UPDATE;
+            incident = std::move(ticket.update);
+            ticket.update.reset();
+        } else if (ticket.resolution) {
+            op = Op::RESOLVE;
+            resolution = std::move(*ticket.resolution);
+            ticket.resolution.reset();
+        } else {
+            continue;
+        }
+
+        ticket.in_flight = true;
+        auto integration = ticket.integration;
+        auto external_id = ticket.external_id;
+        std::string incident_id = ticket.incident_id;
+        lock.unlock();
+
+        // Network round-trip happens with no lock held
+        bool ok = true;
+        std::string created_id;
+        try {
+            switch (op) {
+                case Op::CREATE:
+                    created_id = integration->create_incident(*incident);
+                    ok = !is_retryable_id(created_id);
+                    break;
+                case Op::UPDATE:
+                    if (external_id) {
+                        integration->update_incident(*external_id, *incident);
+                    }
+                    break;
+                case Op::RESOLVE:
+                    if (external_id) {
+                        integration->resolve_incident(*external_id, resolution);
+                    }
+                    break;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Integration error (" << integration->name() << "): " << e.what() << std::endl;
+            ok = false;
+        }
+
+        if (ok && op == Op::CREATE && !is_disabled_id(created_id) && on_created_) {
+            on_created_(*integration, incident_id, created_id);
+        }
+
+        lock.lock();
+        ticket.in_flight = false;
+
+        bool retry = false;
+        if (ok) {
+            stats_.sent++;
+            pending_--;
+            ticket.attempts = 0;
+            if (op == Op::CREATE && !is_disabled_id(created_id)) {
+                ticket.external_id = created_id;
+            }
+        } else if (++ticket.attempts > config_.max_retries) {
+            std::cerr << "Integration " << integration->name() << " gave up on "
+                      << incident_id << " after " << ticket.attempts << " attempts" << std::endl;
+            stats_.failed++;
+            pending_--;
+            ticket.attempts = 0;
+        } else {
+            // Put the operation back unless something newer replaced it
+            stats_.retried++;
+            retry = true;
+            if (op == Op::CREATE && !ticket.create) {
+                ticket.create = std::move(incident);
+            } else if (op == Op::UPDATE && !ticket.update && !ticket.resolution) {
+                ticket.update = std::move(incident);
+            } else if (op == Op::RESOLVE && !ticket.resolution) {
+                ticket.resolution = std::move(resolution);
+            } else {
+                stats_.coalesced++;
+                pending_--;
+            }
+        }
+
+        if (pending_ops(ticket) > 0) {
+            ticket.queued = true;
+            if (retry) {
+                std::chrono::milliseconds backoff = config_.retry_backoff * (1LL << std::min<size_t>(ticket.attempts - 1, 16));
+                backoff = std::min(backoff, config_.max_retry_backoff);
+                delayed_.emplace(Clock::now() + backoff, std::move(key));
+            } else {
+                ready_.push_back(std::move(key));
+            }
+        } else if (op == Op::RESOLVE) {
+            // Nothing can follow a resolve; forget the ticket
+            tickets_.erase(key);
+        } else {
+            // Kept for the external ID later updates need
+            mark_idle(key, ticket);
+            evict_idle(Clock::now());
+        }
+
+        if (pending_ == 0) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+} // namespace agentlog
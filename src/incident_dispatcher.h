@@ -0,0 +1,137 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_INCIDENT_DISPATCHER_H
+#define AGENTLOG_INCIDENT_DISPATCHER_H
+
+#include "agentlog/incident_manager.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace agentlog {
+
+/**
+ * @brief Background delivery of incident notifications to integrations
+ *
+ * IncidentManager hands every create/update/resolve to this dispatcher and
+ * returns immediately; one worker thread talks to Jira, PagerDuty and Slack.
+ * Work is tracked per external ticket (integration + incident), so a ticket
+ * always sees create, then update, then resolve, and a burst of updates
+ * collapses into the latest snapshot. Failed calls are retried with
+ * exponential backoff without holding up other tickets.
+ *
+ * A ticket is forgotten once resolved. Tickets left idle otherwise (never
+ * resolved, or whose create failed) are evicted oldest first beyond
+ * max_idle_tickets or after idle_ticket_timeout; later updates or resolves
+ * for an evicted ticket no longer know its external ID and are skipped.
+ */
+class IncidentDispatcher {
+public:
+    struct Config {
+        size_t max_pending{1024};  // Outstanding operations across all tickets
+        size_t max_retries{3};
+        std::chrono::milliseconds retry_backoff{200};
+        std::chrono::milliseconds max_retry_backoff{10000};
+        size_t max_idle_tickets{4096};
+        std::chrono::seconds idle_ticket_timeout{std::chrono::hours(24)};
+    };
+
+    struct Stats {
+        uint64_t sent{0};
+        uint64_t coalesced{0};
+        uint64_t retried{0};
+        uint64_t failed{0};
+        uint64_t dropped{0};
+        uint64_t tickets_evicted{0};
+    };
+
+    // Called on the dispatcher thread after an integration created a ticket
+    using CreatedCallback = std::function<void(const IncidentIntegration& integration,
+                                               const std::string& incident_id,
+                                               const std::string& external_id)>;
+
+    explicit IncidentDispatcher(Config config, CreatedCallback on_created = {});
+    ~IncidentDispatcher();
+
+    IncidentDispatcher(const IncidentDispatcher&) = delete;
+    IncidentDispatcher& operator=(const IncidentDispatcher&) = delete;
+
+    // Non-blocking; each returns false if the outbound queue is full
+    bool submit_create(const std::shared_ptr<IncidentIntegration>& integration,
+                       const Incident& incident);
+    bool submit_update(const std::shared_ptr<IncidentIntegration>& integration,
+                       const Incident& incident);
+    bool submit_resolve(const std::shared_ptr<IncidentIntegration>& integration,
+                        const std::string& incident_id,
+                        const std::string& resolution);
+
+    // Waits until nothing is pending or in flight; false on timeout
+    bool flush(std::chrono::milliseconds timeout);
+
+    Stats get_stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Ticket {
+        std::shared_ptr<IncidentIntegration> integration;
+        std::string incident_id;
+        std::optional<std::string> external_id;  // Known once create succeeded
+
+        // Pending work, performed in this order
+        std::optional<Incident> create;
+        std::optional<Incident> update;
+        std::optional<std::string> resolution;
+
+        size_t attempts{0};
+        bool queued{false};     // In ready_ or delayed_
+        bool in_flight{false};
+
+        // Set while nothing is pending or in flight
+        bool idle{false};
+        Clock::time_point idle_since;
+        std::list<std::string>::iterator idle_pos;  // Into idle_
+    };
+
+    enum class Op { CREATE, UPDATE, RESOLVE };
+
+    Ticket& ticket_for(const std::string& key,
+                       const std::shared_ptr<IncidentIntegration>& integration,
+                       const std::string& incident_id);
+    void schedule(const std::string& key, Ticket& ticket);
+    size_t pending_ops(const Ticket& ticket) const;
+    void mark_idle(const std::string& key, Ticket& ticket);
+    void evict_idle(Clock::time_point now);
+    void run();
+
+    Config config_;
+    CreatedCallback on_created_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::unordered_map<std::string, Ticket> tickets_;
+    std::deque<std::string> ready_;
+    std::multimap<Clock::time_point, std::string> delayed_;
+    std::list<std::string> idle_;  // Idle ticket keys, longest idle first
+    size_t pending_{0};
+    bool stop_{false};
+    Stats stats_;
+
+    std::thread worker_;
+};
+
+} // namespace agentlog
+
+#endif // AGENTLOG_INCIDENT_DISPATCHER_H
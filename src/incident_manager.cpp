@@ -6,12 +6,15 @@
 #include <iomanip>
 #include <algorithm>
 #include <iostream>
+#include <string_view>
 
 // Include curl helper
 #include "curl_helper.h"
+#include "incident_dispatcher.h"
 #include <sstream>
 #include <cstring>
 #include <cstdlib>
+#include <stdexcept>
 
 namespace agentlog {
 
@@ -116,14 +119,38 @@ std::string Incident::summary() const {
 // IncidentManager Implementation
 //=============================================================================
 
+IncidentManager::IncidentManager(Config config)
+    : config_(std::move(config))
+    , next_incident_id_(1) {
+    IncidentDispatcher::Config dispatch_config;
+    dispatch_config.max_pending = config_.dispatch_queue_size;
+    dispatch_config.max_retries = config_.dispatch_max_retries;
+    dispatch_config.retry_backoff = config_.dispatch_retry_backoff;
+    dispatch_config.max_retry_backoff = config_.dispatch_max_retry_backoff;
+    dispatch_config.max_idle_tickets = config_.dispatch_max_idle_tickets;
+    dispatch_config.idle_ticket_timeout = config_.dispatch_idle_ticket_timeout;
+    
+    dispatcher_ = std::make_unique<IncidentDispatcher>(
+        dispatch_config,
+        [this](const IncidentIntegration& integration,
+               const std::string& incident_id,
+               const std::string& external_id) {
+            record_external_id(integration, incident_id, external_id);
+        });
+}
+
+IncidentManager::~IncidentManager() {
+    // Give in-flight notifications a chance before the dispatcher stops
+    dispatcher_->flush(config_.dispatch_flush_timeout);
+    dispatcher_.reset();
+}
+
 std::optional<Incident> IncidentManager::evaluate_event(
     const LogEvent& event,
-    const std::vector<Correlation>& correlations,
+    const std::vector<CorrelationPtr>& correlations,
     const std::vector<std::string>& matched_patterns) {
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Check if event meets thresholds
+    // Check if event meets thresholds (config_ is immutable, no lock needed)
     bool should_create = false;
     
     if (event.anomaly_score() >= config_.anomaly_threshold) {
@@ -142,9 +169,9 @@ std::optional<Incident> IncidentManager::evaluate_event(
         return std::nullopt;
     }
     
-    // Create incident
+    // Everything up to the duplicate check depends on the event alone, so
+    // it is built before taking the lock
     Incident incident;
-    incident.incident_id = generate_incident_id();
     incident.created_at = std::chrono::system_clock::now();
     incident.status = IncidentStatus::OPEN;
     incident.anomaly_score = event.anomaly_score();
@@ -180,7 +207,7 @@ std::optional<Incident> IncidentManager::evaluate_event(
     if (!correlations.empty()) {
         desc_ss << "\nCorrelated events: " << correlations.size() << "\n";
         for (const auto& corr : correlations) {
-            desc_ss << "  - " << corr.reason << " (confidence: " << corr.confidence << ")\n";
+            desc_ss << "  - " << corr->reason << " (confidence: " << corr->confidence << ")\n";
         }
     }
     
@@ -208,8 +235,8 @@ std::optional<Incident> IncidentManager::evaluate_event(
     incident.event_ids.push_back(event.event_id());
     for (const auto& corr : correlations) {
         incident.event_ids.insert(incident.event_ids.end(),
-                                 corr.event_ids.begin(),
-                                 corr.event_ids.end());
+                                 corr->event_ids.begin(),
+                                 corr->event_ids.end());
     }
     
     // Count affected services
@@ -234,7 +261,10 @@ std::optional<Incident> IncidentManager::evaluate_event(
         incident.tags.push_back("pattern:" + pattern);
     }
     
+    std::lock_guard<std::mutex> lock(mutex_);
+    
     // Check for duplicates
+    expire_dedup_index(incident.created_at);
     if (config_.enable_deduplication) {
         if (auto dup_id = find_duplicate(incident)) {
             // Found duplicate, don't create new incident
@@ -243,20 +273,13 @@ std::optional<Incident> IncidentManager::evaluate_event(
         }
     }
     
-    // Store incident
-    incidents_[incident.incident_id] = incident;
-    stats_.total_created++;
-    stats_.currently_open++;
+    // Store incident; duplicates no longer use up an ID
+    incident.incident_id = generate_incident_id();
+    store_incident(incident);
     
-    // Notify external integrations
+    // Notify external integrations (delivered by the dispatcher thread)
     for (const auto& integration : integrations_) {
-        try {
-            std::string external_id = integration->create_incident(incident);
-            // Store external ID in the incident based on integration type
-            // (You could extend Incident struct to store multiple external IDs)
-        } catch (const std::exception& e) {
-            std::cerr << "Integration error: " << e.what() << std::endl;
-        }
+        dispatcher_->submit_create(integration, incident);
     }
     
     // Trigger callbacks
@@ -287,19 +310,12 @@ Incident IncidentManager::create_incident(
     incident.affected_services_count = 0;
     incident.affected_users_count = 0;
     
-    incidents_[incident.incident_id] = incident;
-    stats_.total_created++;
-    stats_.currently_open++;
+    expire_dedup_index(incident.created_at);
+    store_incident(incident);
     
-    // Notify external integrations
+    // Notify external integrations (delivered by the dispatcher thread)
     for (const auto& integration : integrations_) {
-        try {
-            std::string external_id = integration->create_incident(incident);
-            // Store external ID in the incident based on integration type
-            // (You could extend Incident struct to store multiple external IDs)
-        } catch (const std::exception& e) {
-            std::cerr << "Integration error: " << e.what() << std::endl;
-        }
+        dispatcher_->submit_create(integration, incident);
     }
     
     for (const auto& callback : on_created_callbacks_) {
@@ -315,6 +331,16 @@ void IncidentManager::update_status(const std::string& incident_id, IncidentStat
     auto it = incidents_.find(incident_id);
     if (it != incidents_.end()) {
         it->second.status = new_status;
+        if (new_status == IncidentStatus::RESOLVED || new_status == IncidentStatus::CLOSED) {
+            unindex_incident(it->second);
+        } else if (it->second.created_at >= std::chrono::system_clock::now() - config_.deduplication_window) {
+            index_incident(it->second);  // Reopened
+        }
+        
+        // Repeated status changes coalesce into one update per ticket
+        for (const auto& integration : integrations_) {
+            dispatcher_->submit_update(integration, it->second);
+        }
     }
 }
 
@@ -326,27 +352,14 @@ void IncidentManager::resolve_incident(const std::string& incident_id, const std
         it->second.status = IncidentStatus::RESOLVED;
         it->second.resolved_at = std::chrono::system_clock::now();
         it->second.root_cause = resolution;
+        unindex_incident(it->second);
         
         stats_.currently_open--;
         stats_.resolved++;
         
-        // Notify external integrations
+        // Notify external integrations; each resolves the ticket it created
         for (const auto& integration : integrations_) {
-            try {
-                // For Jira: external_id would be ticket key
-                // For PagerDuty: external_id would be dedup_key
-                // For Slack: external_id would be "SLACK-{incident_id}"
-                if (it->second.jira_ticket_id) {
-                    integration->resolve_incident(*it->second.jira_ticket_id, resolution);
-                }
-                if (it->second.pagerduty_incident_id) {
-                    integration->resolve_incident(*it->second.pagerduty_incident_id, resolution);
-                }
-                // Slack integration will be called with "SLACK-{incident_id}" format
-                integration->resolve_incident("SLACK-" + incident_id, resolution);
-            } catch (const std::exception& e) {
-                std::cerr << "Integration error on resolve: " << e.what() << std::endl;
-            }
+            dispatcher_->submit_resolve(integration, incident_id, resolution);
         }
         
         for (const auto& callback : on_resolved_callbacks_) {
@@ -393,37 +406,33 @@ std::vector<Incident> IncidentManager::get_all_incidents() const {
 
 std::optional<std::string> IncidentManager::find_duplicate(const Incident& incident) const {
     auto cutoff = incident.created_at - config_.deduplication_window;
-    
-    for (const auto& [id, existing] : incidents_) {
-        if (existing.created_at < cutoff) {
-            continue;
+    auto in_window = [&](const std::string& id) {
+        auto it = incidents_.find(id);
+        return it != incidents_.end() && it->second.created_at >= cutoff;
+    };
+    
+    // Same title and severity
+    auto similar = by_fingerprint_.find(fingerprint(incident));
+    if (similar != by_fingerprint_.end()) {
+        for (const auto& id : similar->second) {
+            if (in_window(id)) {
+                return id;
+            }
         }
-        
-        if (existing.status == IncidentStatus::RESOLVED ||
-            existing.status == IncidentStatus::CLOSED) {
+    }
+    
+    // More than half of the event IDs already in one incident
+    std::unordered_map<std::string_view, size_t> overlap;
+    for (uint64_t event_id : incident.event_ids) {
+        auto holders = by_event_id_.find(event_id);
+        if (holders == by_event_id_.end()) {
             continue;
         }
-        
-        // Check if similar
-        if (existing.title == incident.title &&
-            existing.severity == incident.severity) {
-            return id;
-        }
-        
-        // Check if event IDs overlap significantly
-        std::unordered_set<uint64_t> existing_set(
-            existing.event_ids.begin(), existing.event_ids.end());
-        
-        size_t overlap = 0;
-        for (uint64_t id : incident.event_ids) {
-            if (existing_set.find(id) != existing_set.end()) {
-                overlap++;
+        for (const auto& id : holders->second) {
+            if (++overlap[id] > incident.event_ids.size() / 2 && in_window(id)) {
+                return id;
             }
         }
-        
-        if (overlap > incident.event_ids.size() / 2) {
-            return id;
-        }
     }
     
     return std::nullopt;
@@ -445,6 +454,7 @@ void IncidentManager::auto_resolve_stale_incidents() {
                 incident.status = IncidentStatus::RESOLVED;
                 incident.resolved_at = std::chrono::system_clock::now();
                 incident.root_cause = "Auto-resolved: no further activity";
+                unindex_incident(incident);
                 
                 stats_.currently_open--;
                 stats_.resolved++;
@@ -468,9 +478,25 @@ void IncidentManager::on_incident_resolved(IncidentCallback callback) {
     on_resolved_callbacks_.push_back(std::move(callback));
 }
 
+bool IncidentManager::flush_integrations(std::chrono::milliseconds timeout) {
+    return dispatcher_->flush(timeout);
+}
+
 IncidentManager::Stats IncidentManager::get_stats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return stats_;
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats = stats_;
+    }
+    
+    auto dispatch = dispatcher_->get_stats();
+    stats.notifications_sent = dispatch.sent;
+    stats.notifications_coalesced = dispatch.coalesced;
+    stats.notifications_retried = dispatch.retried;
+    stats.notifications_failed = dispatch.failed;
+    stats.notifications_dropped = dispatch.dropped;
+    stats.tickets_evicted = dispatch.tickets_evicted;
+    return stats;
 }
 
 IncidentSeverity IncidentManager::calculate_severity(
@@ -493,6 +519,69 @@ IncidentSeverity IncidentManager::calculate_severity(
     return IncidentSeverity::LOW;
 }
 
+void IncidentManager::store_incident(const Incident& incident) {
+    incidents_[incident.incident_id] = incident;
+    index_incident(incident);
+    stats_.total_created++;
+    stats_.currently_open++;
+}
+
+std::string IncidentManager::fingerprint(const Incident& incident) {
+    std::string key = incident.title;
+    key += '\0';
+    key += static_cast<char>(incident.severity);
+    return key;
+}
+
+void IncidentManager::index_incident(const Incident& incident) {
+    if (!indexed_.insert(incident.incident_id).second) {
+        return;
+    }
+    by_fingerprint_[fingerprint(incident)].push_back(incident.incident_id);
+    
+    // An incident counts once per event, however often it lists it
+    std::unordered_set<uint64_t> seen;
+    for (uint64_t event_id : incident.event_ids) {
+        if (seen.insert(event_id).second) {
+            by_event_id_[event_id].push_back(incident.incident_id);
+        }
+    }
+    index_order_.push_back({incident.incident_id, incident.created_at});
+}
+
+void IncidentManager::unindex_incident(const Incident& incident) {
+    if (indexed_.erase(incident.incident_id) == 0) {
+        return;
+    }
+    auto remove_from = [&](auto& index, const auto& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return;
+        }
+        auto& ids = it->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), incident.incident_id), ids.end());
+        if (ids.empty()) {
+            index.erase(it);
+        }
+    };
+    remove_from(by_fingerprint_, fingerprint(incident));
+    for (uint64_t event_id : incident.event_ids) {
+        remove_from(by_event_id_, event_id);
+    }
+    // index_order_ keeps its entry until it ages out
+}
+
+void IncidentManager::expire_dedup_index(timestamp_t now) {
+    auto cutoff = now - config_.deduplication_window;
+    while (!index_order_.empty() && index_order_.front().created_at < cutoff) {
+        auto it = incidents_.find(index_order_.front().incident_id);
+        if (it != incidents_.end()) {
+            unindex_incident(it->second);
+        }
+        index_order_.pop_front();
+    }
+}
+
 std::string IncidentManager::generate_incident_id() {
     uint64_t id = next_incident_id_.fetch_add(1);
     
@@ -502,6 +591,23 @@ std::string IncidentManager::generate_incident_id() {
     return oss.str();
 }
 
+void IncidentManager::record_external_id(const IncidentIntegration& integration,
+                                         const std::string& incident_id,
+                                         const std::string& external_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = incidents_.find(incident_id);
+    if (it == incidents_.end()) {
+        return;
+    }
+    
+    if (integration.name() == "Jira") {
+        it->second.jira_ticket_id = external_id;
+    } else if (integration.name() == "PagerDuty") {
+        it->second.pagerduty_incident_id = external_id;
+    }
+}
+
 //=============================================================================
 // Integration Implementations
 //=============================================================================
@@ -581,28 +687,28 @@ void JiraIntegration::resolve_incident(const std::string& external_id, const std
         return;
     }
     
-    try {
-        // Transition to "Done" status (transition ID may vary)
-        std::ostringstream json;
-        json << "{"
-             << "\"transition\": {\"id\": \"31\"},"  // 31 is common for "Done"
-             << "\"fields\": {\"resolution\": {\"name\": \"" << resolution << "\"}}"
-             << "}";
-        
-        std::string auth = config_.username + ":" + config_.api_token;
-        std::string auth_encoded = base64_encode(auth);
-        
-        std::map<std::string, std::string> headers;
-        headers["Authorization"] = "Basic " + auth_encoded;
-        
-        std::string url = config_.url;
-        if (url.back() == '/') url.pop_back();
-        url += "/rest/api/3/issue/" + external_id + "/transitions";
-        
-        CurlHelper curl;
-        curl.post(url, json.str(), headers);
-    } catch (...) {
-        // Silently fail
+    // Transition to "Done" status (transition ID may vary)
+    std::ostringstream json;
+    json << "{"
+         << "\"transition\": {\"id\": \"31\"},"  // 31 is common for "Done"
+         << "\"fields\": {\"resolution\": {\"name\": \"" << resolution << "\"}}"
+         << "}";
+    
+    std::string auth = config_.username + ":" + config_.api_token;
+    std::string auth_encoded = base64_encode(auth);
+    
+    std::map<std::string, std::string> headers;
+    headers["Authorization"] = "Basic " + auth_encoded;
+    
+    std::string url = config_.url;
+    if (url.back() == '/') url.pop_back();
+    url += "/rest/api/3/issue/" + external_id + "/transitions";
+    
+    CurlHelper curl;
+    auto response = curl.post(url, json.str(), headers);
+    if (!response.success) {
+        // Thrown so the dispatcher retries the call
+        throw std::runtime_error("Jira API error: " + std::to_string(response.status_code));
     }
 }
 
@@ -677,20 +783,20 @@ void PagerDutyIntegration::resolve_incident(const std::string& external_id, cons
         return;
     }
     
-    try {
-        // Send resolve event
-        std::ostringstream json;
-        json << "{"
-             << "\"routing_key\": \"" << config_.integration_key << "\","
-             << "\"event_action\": \"resolve\","
-             << "\"dedup_key\": \"" << external_id << "\""
-             << "}";
-        
-        CurlHelper curl;
-        std::string pd_url = "http://localhost:8081/v2/enqueue";
-        curl.post(pd_url, json.str());
-    } catch (...) {
-        // Silently fail
+    // Send resolve event
+    std::ostringstream json;
+    json << "{"
+         << "\"routing_key\": \"" << config_.integration_key << "\","
+         << "\"event_action\": \"resolve\","
+         << "\"dedup_key\": \"" << external_id << "\""
+         << "}";
+    
+    CurlHelper curl;
+    std::string pd_url = "http://localhost:8081/v2/enqueue";
+    auto response = curl.post(pd_url, json.str());
+    if (!response.success) {
+        // Thrown so the dispatcher retries the call
+        throw std::runtime_error("PagerDuty API error: " + std::to_string(response.status_code));
     }
 }
 
@@ -767,14 +873,14 @@ void SlackIntegration::update_incident(const std::string& external_id, const Inc
         return;
     }
     
-    try {
-        std::ostringstream json;
-        json << "{\"text\": \":arrows_counterclockwise: Incident Updated: " << incident.title << "\"}";
-        
-        CurlHelper curl;
-        curl.post(config_.webhook_url, json.str());
-    } catch (...) {
-        // Silently fail
+    std::ostringstream json;
+    json << "{\"text\": \":arrows_counterclockwise: Incident Updated: " << incident.title << "\"}";
+    
+    CurlHelper curl;
+    auto response = curl.post(config_.webhook_url, json.str());
+    if (!response.success) {
+        // Thrown so the dispatcher retries the call
+        throw std::runtime_error("Slack API error: " + std::to_string(response.status_code));
     }
 }
 
@@ -783,15 +889,15 @@ void SlackIntegration::resolve_incident(const std::string& external_id, const st
         return;
     }
     
-    try {
-        std::ostringstream json;
-        json << "{\"text\": \":white_check_mark: Incident Resolved: " << external_id 
-             << "\\nResolution: " << resolution << "\"}";
-        
-        CurlHelper curl;
-        curl.post(config_.webhook_url, json.str());
-    } catch (...) {
-        // Silently fail
+    std::ostringstream json;
+    json << "{\"text\": \":white_check_mark: Incident Resolved: " << external_id 
+         << "\\nResolution: " << resolution << "\"}";
+    
+    CurlHelper curl;
+    auto response = curl.post(config_.webhook_url, json.str());
+    if (!response.success) {
+        // Thrown so the dispatcher retries the call
+        throw std::runtime_error("Slack API error: " + std::to_string(response.status_code));
     }
 }
 
@@ -1,5 +1,219 @@
 // Copyright (c) 2025 AgentLog Contributors
 // SPDX-License-Identifier: MIT
 
-// Placeholder for ingestion layer implementation
-// TODO: Implement lock-free ring buffer and zero-copy event processing
+#include "event_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define AGENTLOG_CPU_RELAX() _mm_pause()
+#else
+#define AGENTLOG_CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace agentlog {
+
+namespace {
+    // Spins before a worker parks; keeps wake-up syscalls off the hot path
+    // while producers are keeping the queue busy.
+    constexpr int kSpinIterations = 256;
+    constexpr auto kParkTimeout = std::chrono::milliseconds(50);
+}
+
+//=============================================================================
+// EventQueue Implementation
+//=============================================================================
+
+bool EventQueue::push(LogEvent&& event) {
+    if (!ring_.try_emplace(std::move(event), std::chrono::steady_clock::now())) {
+        return false;
+    }
+    notify_consumer();
+    return true;
+}
+
+bool EventQueue::push_wait(LogEvent&& event, std::chrono::microseconds timeout) {
+    if (push(std::move(event))) {
+        return true;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(space_mutex_);
+    for (;;) {
+        // Same handshake as wait_for_event(), with the roles swapped
+        blocked_.fetch_add(1, std::memory_order_seq_cst);
+        bool pushed = ring_.try_emplace(std::move(event), std::chrono::steady_clock::now());
+        if (!pushed && !shutdown_.load(std::memory_order_acquire) &&
+            std::chrono::steady_clock::now() < deadline) {
+            space_cv_.wait_until(lock, std::min(deadline, std::chrono::steady_clock::now() + kParkTimeout));
+            pushed = ring_.try_emplace(std::move(event), std::chrono::steady_clock::now());
+        }
+        blocked_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (pushed) {
+            lock.unlock();
+            notify_consumer();
+            return true;
+        }
+        if (shutdown_.load(std::memory_order_acquire) ||
+            std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+}
+
+size_t EventQueue::push_evicting(LogEvent&& event) {
+    size_t evicted = 0;
+    detail::QueuedEvent oldest;
+    while (!ring_.try_emplace(std::move(event), std::chrono::steady_clock::now())) {
+        if (ring_.try_pop(oldest)) {
+            evicted++;
+        }
+    }
+    notify_consumer();
+    return evicted;
+}
+
+void EventQueue::notify_consumer() {
+    // Pairs with the sleeper registration in wait_for_event(): either the
+    // worker sees the new event on its re-check, or we see it sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
+
+void EventQueue::notify_producers() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (blocked_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(space_mutex_);
+        space_cv_.notify_all();
+    }
+}
+
+bool EventQueue::pop(LogEvent& event) {
+    detail::QueuedEvent queued;
+    if (!pop(queued)) {
+        return false;
+    }
+    event = std::move(queued.event);
+    return true;
+}
+
+bool EventQueue::pop(detail::QueuedEvent& queued) {
+    for (int i = 0; i < kSpinIterations; ++i) {
+        if (ring_.try_pop(queued)) {
+            notify_producers();
+            return true;
+        }
+        AGENTLOG_CPU_RELAX();
+    }
+    bool got = wait_for_event(queued);
+    if (got) {
+        notify_producers();
+    }
+    return got;
+}
+
+size_t EventQueue::pop_batch(std::vector<LogEvent>& out, size_t max_events,
+                             std::chrono::microseconds linger,
+                             std::vector<std::chrono::steady_clock::time_point>* enqueued_at) {
+    if (max_events == 0) {
+        return 0;
+    }
+
+    detail::QueuedEvent queued;
+    auto take = [&] {
+        out.push_back(std::move(queued.event));
+        if (enqueued_at) {
+            enqueued_at->push_back(queued.enqueued_at);
+        }
+    };
+
+    if (!pop(queued)) {
+        return 0;
+    }
+    take();
+    size_t count = 1;
+
+    auto deadline = std::chrono::steady_clock::now() + linger;
+    while (count < max_events) {
+        if (ring_.try_pop(queued)) {
+            take();
+            ++count;
+            continue;
+        }
+        // Park rather than spin: a quiet queue would otherwise keep the
+        // worker busy for the whole linger window
+        if (linger.count() <= 0 || !wait_until(queued, deadline)) {
+            break;
+        }
+        take();
+        ++count;
+    }
+    // pop() already woke blocked producers for the first slot it freed
+    if (count > 1) {
+        notify_producers();
+    }
+    return count;
+}
+
+bool EventQueue::wait_for_event(detail::QueuedEvent& event) {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    for (;;) {
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        bool got = ring_.try_pop(event);
+        if (!got && !shutdown_.load(std::memory_order_acquire)) {
+            sleep_cv_.wait_for(lock, kParkTimeout);
+            got = ring_.try_pop(event);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (got) {
+            return true;
+        }
+        if (shutdown_.load(std::memory_order_acquire)) {
+            // Producers may still be finishing a push that raced shutdown
+            return ring_.try_pop(event);
+        }
+    }
+}
+
+bool EventQueue::wait_until(detail::QueuedEvent& event,
+                            std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    for (;;) {
+        // Same handshake as wait_for_event(), bounded by the deadline
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        bool got = ring_.try_pop(event);
+        if (!got && !shutdown_.load(std::memory_order_acquire) &&
+            std::chrono::steady_clock::now() < deadline) {
+            sleep_cv_.wait_until(lock, deadline);
+            got = ring_.try_pop(event);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (got) {
+            return true;
+        }
+        if (shutdown_.load(std::memory_order_acquire) ||
+            std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+}
+
+void EventQueue::shutdown() {
+    shutdown_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(space_mutex_);
+    space_cv_.notify_all();
+}
+
+} // namespace agentlog
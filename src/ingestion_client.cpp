@@ -0,0 +1,265 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/ingestion.h"
+#include "socket_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+
+namespace agentlog {
+
+using namespace detail;
+
+namespace {
+
+constexpr size_t kMaxUdpPayload = 65507;
+constexpr size_t kMaxUnixDatagram = 64 * 1024;  // What IngestionServer reads
+constexpr std::chrono::seconds kSendTimeout{5};
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+size_t record_size(const char* p) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(p);
+    return 4 + (size_t(bytes[0]) | size_t(bytes[1]) << 8 |
+                size_t(bytes[2]) << 16 | size_t(bytes[3]) << 24);
+}
+
+} // namespace
+
+//=============================================================================
+// IngestionClient Implementation
+//=============================================================================
+
+IngestionClient::IngestionClient(Config config)
+    : config_(std::move(config)) {
+    auto endpoint = parse_endpoint(config_.address);
+    if (!endpoint) {
+        std::cerr << "Invalid ingestion address: " << config_.address << std::endl;
+        return;
+    }
+    valid_ = true;
+    stream_ = endpoint->is_stream();
+    udp_ = endpoint->transport == Endpoint::Transport::UDP;
+    if (!stream_) {
+        datagram_limit_ = std::min(config_.batch_bytes, udp_ ? kMaxUdpPayload : kMaxUnixDatagram);
+        config_.batch_bytes = datagram_limit_;
+    }
+    config_.batch_bytes = std::max<size_t>(config_.batch_bytes, 1);
+    config_.max_pending_bytes = std::max(config_.max_pending_bytes, config_.batch_bytes);
+    pending_.reserve(config_.batch_bytes * 2);
+    thread_ = std::thread(&IngestionClient::run, this);
+}
+
+IngestionClient::~IngestionClient() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        data_cv_.notify_all();
+        thread_.join();
+    }
+    disconnect();
+}
+
+void IngestionClient::send(const LogEvent& event) {
+    if (!valid_) {
+        events_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t before = pending_.size();
+        event.encode_binary(pending_);
+        if (pending_.size() > config_.max_pending_bytes) {
+            pending_.resize(before);
+            events_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pending_records_++;
+        accepted_++;
+        wake = before < config_.batch_bytes && pending_.size() >= config_.batch_bytes;
+    }
+    if (wake) {
+        data_cv_.notify_one();
+    }
+}
+
+bool IngestionClient::flush(std::chrono::milliseconds timeout) {
+    if (!valid_) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = accepted_;
+    flush_requested_ = true;
+    data_cv_.notify_one();
+    return done_cv_.wait_for(lock, timeout, [&] { return settled_ >= target; });
+}
+
+IngestionClient::Stats IngestionClient::get_stats() const {
+    Stats stats;
+    stats.events_sent = events_sent_.load(std::memory_order_relaxed);
+    stats.events_dropped = events_dropped_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    stats.reconnects = reconnects_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void IngestionClient::run() {
+    std::string batch;
+    batch.reserve(config_.batch_bytes * 2);
+    bool ever_connected = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        data_cv_.wait_for(lock, config_.flush_interval, [this] {
+            return stop_ || flush_requested_ || pending_.size() >= config_.batch_bytes;
+        });
+        if (pending_.empty()) {
+            flush_requested_ = false;
+            if (stop_) {
+                return;
+            }
+            continue;
+        }
+
+        if (fd_ < 0) {
+            lock.unlock();
+            bool connected = connect();
+            lock.lock();
+            if (connected) {
+                if (ever_connected) {
+                    reconnects_.fetch_add(1, std::memory_order_relaxed);
+                }
+                ever_connected = true;
+            } else if (stop_) {
+                // Last chance gone: account for what is left so flush() returns
+                events_dropped_.fetch_add(pending_records_, std::memory_order_relaxed);
+                settled_ += pending_records_;
+                pending_.clear();
+                pending_records_ = 0;
+                done_cv_.notify_all();
+                return;
+            } else {
+                // Keep buffering; send() drops once max_pending_bytes is reached
+                data_cv_.wait_for(lock, config_.reconnect_interval, [this] { return stop_; });
+                continue;
+            }
+        }
+
+        batch.swap(pending_);
+        size_t records = pending_records_;
+        pending_records_ = 0;
+        flush_requested_ = false;
+        lock.unlock();
+
+        size_t written = 0;
+        if (!write_out(batch, written)) {
+            disconnect();
+        }
+        events_sent_.fetch_add(written, std::memory_order_relaxed);
+        events_dropped_.fetch_add(records - written, std::memory_order_relaxed);
+        batch.clear();
+
+        lock.lock();
+        settled_ += records;
+        done_cv_.notify_all();
+    }
+}
+
+bool IngestionClient::connect() {
+    auto endpoint = parse_endpoint(config_.address);
+    fd_ = open_connection(*endpoint);
+    if (fd_ < 0) {
+        return false;
+    }
+#ifndef _WIN32
+    // A stalled server costs one batch, not the writer thread
+    timeval timeout{};
+    timeout.tv_sec = kSendTimeout.count();
+    ::setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#endif
+    return true;
+}
+
+void IngestionClient::disconnect() {
+    close_socket(fd_);
+    fd_ = -1;
+}
+
+// Sets records_written to the whole records handed to the OS; false if the
+// connection broke
+bool IngestionClient::write_out(const std::string& data, size_t& records_written) {
+#ifndef _WIN32
+    records_written = 0;
+    if (stream_) {
+        size_t offset = 0;
+        size_t record_end = 0;
+        while (offset < data.size()) {
+            ssize_t n = ::send(fd_, data.data() + offset, data.size() - offset, kSendFlags);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            offset += static_cast<size_t>(n);
+            bytes_sent_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            while (record_end < data.size() && record_end + record_size(&data[record_end]) <= offset) {
+                record_end += record_size(&data[record_end]);
+                records_written++;
+            }
+        }
+        return true;
+    }
+
+    // Pack whole records into datagrams; a record too large for one is dropped
+    size_t offset = 0;
+    while (offset < data.size()) {
+        size_t begin = offset;
+        size_t records = 0;
+        while (offset < data.size() && offset - begin + record_size(&data[offset]) <= datagram_limit_) {
+            offset += record_size(&data[offset]);
+            records++;
+        }
+        if (records == 0) {
+            offset += record_size(&data[offset]);
+            continue;
+        }
+
+        ssize_t n;
+        do {
+            n = ::send(fd_, data.data() + begin, offset - begin, kSendFlags);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) {
+            // ECONNREFUSED on UDP reports an earlier datagram; the socket
+            // itself is fine. Anything else gets a fresh socket.
+            if (errno != ECONNREFUSED || !udp_) {
+                return false;
+            }
+            continue;
+        }
+        bytes_sent_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        records_written += records;
+    }
+    return true;
+#else
+    (void)data;
+    records_written = 0;
+    return false;
+#endif
+}
+
+} // namespace agentlog
@@ -0,0 +1,400 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/ingestion.h"
+#include "agentlog/logger.h"
+#include "socket_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace agentlog {
+
+using namespace detail;
+
+namespace {
+
+constexpr int kMaxEpollEvents = 64;
+constexpr size_t kReadsPerWakeup = 16;      // Then other sockets get a turn
+constexpr size_t kDatagramBatch = 32;       // Datagrams per recvmmsg()
+constexpr size_t kMaxDatagram = 64 * 1024;
+constexpr size_t kMinReadBuffer = 4096;
+constexpr size_t kDesync = static_cast<size_t>(-1);
+
+// epoll user data: what the descriptor is, and its listener index or fd
+enum : uint64_t { kWakeTag = 1, kListenerTag = 2, kConnectionTag = 3 };
+
+uint64_t tag(uint64_t kind, uint32_t value) {
+    return kind << 32 | value;
+}
+
+uint32_t read_le32(const char* p) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(p);
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 |
+           uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+} // namespace
+
+//=============================================================================
+// IngestionServer Implementation
+//=============================================================================
+
+IngestionServer::IngestionServer(Config config, Handler handler)
+    : config_(std::move(config)), handler_(std::move(handler)) {
+    if (!handler_) {
+        handler_ = [](LogEvent&& event) { Logger::instance().emit(std::move(event)); };
+    }
+    config_.read_buffer_bytes = std::max(config_.read_buffer_bytes, kMinReadBuffer);
+}
+
+IngestionServer::~IngestionServer() {
+    stop();
+}
+
+uint16_t IngestionServer::port(size_t index) const {
+    return index < listeners_.size() ? listeners_[index].port : 0;
+}
+
+IngestionServer::Stats IngestionServer::get_stats() const {
+    Stats stats;
+    stats.events_received = events_received_.load(std::memory_order_relaxed);
+    stats.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    stats.records_malformed = records_malformed_.load(std::memory_order_relaxed);
+    stats.records_refused = records_refused_.load(std::memory_order_relaxed);
+    stats.connections_accepted = connections_accepted_.load(std::memory_order_relaxed);
+    stats.connections_refused = connections_refused_.load(std::memory_order_relaxed);
+    stats.connections_open = connections_open_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Hands every complete record at the front of data to the handler. Returns
+// the bytes consumed, or kDesync once a length prefix is out of bounds.
+size_t IngestionServer::decode_records(const char* data, size_t size, bool stream) {
+    DecodeOptions options;
+    options.fresh_id = true;
+    options.max_symbols = config_.max_symbols;
+    
+    size_t offset = 0;
+    uint64_t events = 0;
+    uint64_t malformed = 0;
+    uint64_t refused = 0;
+    while (size - offset >= 4) {
+        uint32_t length = read_le32(data + offset);
+        if (length > config_.max_record_bytes) {
+            offset = kDesync;
+            malformed++;
+            break;
+        }
+        if (size - offset - 4 < length) {
+            break;
+        }
+        DecodeError error{};
+        auto event = LogEvent::decode_binary(std::string_view(data + offset, 4 + size_t(length)),
+                                             nullptr, options, &error);
+        if (event) {
+            handler_(std::move(*event));
+            events++;
+        } else if (error == DecodeError::SYMBOL_LIMIT) {
+            refused++;
+        } else {
+            malformed++;
+        }
+        offset += 4 + size_t(length);
+    }
+    if (!stream && offset != size && offset != kDesync) {
+        malformed++;  // Datagrams hold whole records only
+    }
+
+    events_received_.fetch_add(events, std::memory_order_relaxed);
+    if (malformed > 0) {
+        records_malformed_.fetch_add(malformed, std::memory_order_relaxed);
+    }
+    if (refused > 0) {
+        records_refused_.fetch_add(refused, std::memory_order_relaxed);
+    }
+    return offset;
+}
+
+#ifdef __linux__
+
+bool IngestionServer::start() {
+    if (is_running()) {
+        return true;
+    }
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "Failed to create ingestion event loop: " << std::strerror(errno) << std::endl;
+        close_all();
+        return false;
+    }
+    epoll_event wake{};
+    wake.events = EPOLLIN;
+    wake.data.u64 = tag(kWakeTag, 0);
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake);
+
+    for (const auto& spec : config_.listen) {
+        auto endpoint = parse_endpoint(spec);
+        if (!endpoint) {
+            std::cerr << "Invalid ingestion endpoint: " << spec << std::endl;
+            close_all();
+            return false;
+        }
+        int fd = open_listener(*endpoint, config_.backlog);
+        if (fd < 0) {
+            std::cerr << "Failed to listen on " << spec << ": " << std::strerror(errno) << std::endl;
+            close_all();
+            return false;
+        }
+
+        Listener listener;
+        listener.fd = fd;
+        listener.stream = endpoint->is_stream();
+        if (endpoint->is_unix()) {
+            listener.unix_path = endpoint->path;
+        } else {
+            listener.port = bound_port(fd);
+        }
+        if (!listener.stream && datagram_buffer_.empty()) {
+            datagram_buffer_.resize(kDatagramBatch * kMaxDatagram);
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = tag(kListenerTag, static_cast<uint32_t>(listeners_.size()));
+        listeners_.push_back(std::move(listener));
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    thread_ = std::thread(&IngestionServer::run, this);
+    return true;
+}
+
+void IngestionServer::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+    (void)written;
+    thread_.join();
+    close_all();
+}
+
+void IngestionServer::close_all() {
+    for (auto& [fd, connection] : connections_) {
+        close_socket(fd);
+    }
+    connections_.clear();
+    connections_open_.store(0, std::memory_order_relaxed);
+
+    for (const auto& listener : listeners_) {
+        close_socket(listener.fd);
+        if (!listener.unix_path.empty()) {
+            ::unlink(listener.unix_path.c_str());
+        }
+    }
+    listeners_.clear();
+
+    close_socket(epoll_fd_);
+    close_socket(wake_fd_);
+    epoll_fd_ = -1;
+    wake_fd_ = -1;
+}
+
+void IngestionServer::run() {
+    epoll_event events[kMaxEpollEvents];
+    for (;;) {
+        int n = ::epoll_wait(epoll_fd_, events, kMaxEpollEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Ingestion event loop failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            uint64_t kind = events[i].data.u64 >> 32;
+            uint32_t value = static_cast<uint32_t>(events[i].data.u64);
+            if (kind == kWakeTag) {
+                return;
+            }
+            if (kind == kListenerTag) {
+                const Listener& listener = listeners_[value];
+                if (listener.stream) {
+                    accept_all(listener);
+                } else {
+                    read_datagrams(listener.fd);
+                }
+                continue;
+            }
+
+            auto it = connections_.find(static_cast<int>(value));
+            if (it != connections_.end() && !read_stream(*it->second)) {
+                close_connection(it->first);
+            }
+        }
+    }
+}
+
+void IngestionServer::accept_all(const Listener& listener) {
+    for (;;) {
+        int fd = ::accept4(listener.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;  // EAGAIN, or out of descriptors until some close
+        }
+        if (connections_.size() >= config_.max_connections) {
+            close_socket(fd);
+            connections_refused_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = tag(kConnectionTag, static_cast<uint32_t>(fd));
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close_socket(fd);
+            continue;
+        }
+        connections_.emplace(fd, std::move(connection));
+        connections_accepted_.fetch_add(1, std::memory_order_relaxed);
+        connections_open_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Returns false once the connection should be closed
+bool IngestionServer::read_stream(Connection& connection) {
+    // Buffers are allocated on first read and start small, so idle and
+    // slow clients cost little. A client filling its buffer on every read
+    // grows it to read_buffer_bytes; one record larger than that grows it
+    // further, to max_record_bytes + 4, until the record is consumed.
+    std::string& buffer = connection.buffer;
+    if (buffer.empty()) {
+        buffer.resize(kMinReadBuffer);
+    }
+    for (size_t reads = 0; reads < kReadsPerWakeup; ++reads) {
+        if (connection.used == buffer.size()) {
+            // decode_records() has already checked the record against
+            // max_record_bytes
+            buffer.resize(std::min(buffer.size() * 2, config_.max_record_bytes + 4));
+        }
+
+        size_t space = buffer.size() - connection.used;
+        ssize_t n = ::recv(connection.fd, &buffer[connection.used], space, 0);
+        if (n == 0) {
+            if (connection.used > 0) {
+                records_malformed_.fetch_add(1, std::memory_order_relaxed);  // Truncated
+            }
+            return false;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        bytes_received_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        connection.used += static_cast<size_t>(n);
+
+        size_t consumed = decode_records(buffer.data(), connection.used, true);
+        if (consumed == kDesync) {
+            return false;
+        }
+        if (consumed > 0) {
+            std::memmove(&buffer[0], &buffer[consumed], connection.used - consumed);
+            connection.used -= consumed;
+        }
+        if (buffer.size() > config_.read_buffer_bytes &&
+            connection.used <= config_.read_buffer_bytes) {
+            // The oversized record was consumed; give the memory back
+            std::string smaller(config_.read_buffer_bytes, '\0');
+            std::memcpy(&smaller[0], buffer.data(), connection.used);
+            buffer.swap(smaller);
+        }
+        if (static_cast<size_t>(n) < space) {
+            return true;  // Socket drained; skip the read that would say so
+        }
+        if (buffer.size() < config_.read_buffer_bytes) {
+            buffer.resize(std::min(buffer.size() * 2, config_.read_buffer_bytes));
+        }
+    }
+    return true;
+}
+
+void IngestionServer::read_datagrams(int fd) {
+    mmsghdr messages[kDatagramBatch];
+    iovec vectors[kDatagramBatch];
+    for (size_t reads = 0; reads < kReadsPerWakeup; ++reads) {
+        std::memset(messages, 0, sizeof(messages));
+        for (size_t i = 0; i < kDatagramBatch; ++i) {
+            vectors[i].iov_base = datagram_buffer_.data() + i * kMaxDatagram;
+            vectors[i].iov_len = kMaxDatagram;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int n = ::recvmmsg(fd, messages, kDatagramBatch, MSG_DONTWAIT, nullptr);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            size_t length = messages[i].msg_len;
+            bytes_received_.fetch_add(length, std::memory_order_relaxed);
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                records_malformed_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            decode_records(datagram_buffer_.data() + i * kMaxDatagram, length, false);
+        }
+        if (static_cast<size_t>(n) < kDatagramBatch) {
+            return;
+        }
+    }
+}
+
+void IngestionServer::close_connection(int fd) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close_socket(fd);
+    connections_.erase(fd);
+    connections_open_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+#else
+
+bool IngestionServer::start() {
+    std::cerr << "AgentLog: Network ingestion needs epoll and is Linux-only" << std::endl;
+    return false;
+}
+
+void IngestionServer::stop() {}
+void IngestionServer::close_all() {}
+void IngestionServer::run() {}
+void IngestionServer::accept_all(const Listener&) {}
+bool IngestionServer::read_stream(Connection&) { return false; }
+void IngestionServer::read_datagrams(int) {}
+void IngestionServer::close_connection(int) {}
+
+#endif
+
+} // namespace agentlog
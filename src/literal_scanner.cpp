@@ -0,0 +1,231 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "literal_scanner.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+
+namespace agentlog {
+namespace detail {
+
+namespace {
+
+bool is_quantifier(char c) {
+    return c == '*' || c == '+' || c == '?' || c == '{';
+}
+
+// Index just past the group or class opening at regex[pos]
+size_t skip_bracketed(std::string_view regex, size_t pos) {
+    if (regex[pos] == '[') {
+        size_t i = pos + 1;
+        if (i < regex.size() && regex[i] == '^') ++i;
+        if (i < regex.size() && regex[i] == ']') ++i;  // Leading ] is literal
+        for (; i < regex.size() && regex[i] != ']'; ++i) {
+            if (regex[i] == '\\') ++i;
+        }
+        return std::min(i + 1, regex.size());
+    }
+
+    int depth = 0;
+    for (size_t i = pos; i < regex.size(); ++i) {
+        char c = regex[i];
+        if (c == '\\') {
+            ++i;
+        } else if (c == '[') {
+            i = skip_bracketed(regex, i) - 1;
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')' && --depth == 0) {
+            return i + 1;
+        }
+    }
+    return regex.size();
+}
+
+// Index just past a quantifier starting at regex[pos], lazy suffix included
+size_t skip_quantifier(std::string_view regex, size_t pos) {
+    size_t i = pos;
+    if (regex[i] == '{') {
+        while (i < regex.size() && regex[i] != '}') ++i;
+    }
+    ++i;
+    if (i < regex.size() && regex[i] == '?') ++i;
+    return i;
+}
+
+// Longest run of characters one top-level alternative always matches
+std::string longest_run(std::string_view branch) {
+    std::string best;
+    std::string run;
+    auto end_run = [&] {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+
+    size_t i = 0;
+    while (i < branch.size()) {
+        char c = branch[i];
+        std::optional<char> literal;
+        size_t next = i + 1;
+
+        if (c == '\\' && i + 1 < branch.size()) {
+            char e = branch[i + 1];
+            next = i + 2;
+            if (std::strchr("nrtfv", e)) {
+                literal = e == 'n' ? '\n' : e == 'r' ? '\r' : e == 't' ? '\t'
+                        : e == 'f' ? '\f' : '\v';
+            } else if (!std::isalnum(static_cast<unsigned char>(e))) {
+                literal = e;  // Escaped punctuation stands for itself
+            } else if (e == 'x' || e == 'u' || e == 'c') {
+                // Operands of \x41, \u0041 and \cJ are not literals either
+                next = std::min(next + (e == 'x' ? 2 : e == 'u' ? 4 : 1), branch.size());
+            } else if (std::isdigit(static_cast<unsigned char>(e))) {
+                while (next < branch.size() && std::isdigit(static_cast<unsigned char>(branch[next]))) {
+                    ++next;  // Back-reference number
+                }
+            }
+            // Anything else (\d, \w, \b, \x41, back-references...) ends the run
+        } else if (c == '[' || c == '(') {
+            next = skip_bracketed(branch, i);
+        } else if (!std::strchr(".^$|)*+?{}", c)) {
+            literal = c;
+        }
+
+        bool quantified = next < branch.size() && is_quantifier(branch[next]);
+        if (literal && !quantified) {
+            run += *literal;
+        } else if (literal && branch[next] == '+') {
+            // Present at least once, but what follows need not be adjacent
+            run += *literal;
+            end_run();
+        } else {
+            end_run();
+        }
+
+        i = quantified ? skip_quantifier(branch, next) : next;
+    }
+    end_run();
+    return best;
+}
+
+} // namespace
+
+std::optional<std::vector<std::string>> required_literals(std::string_view regex) {
+    std::vector<std::string> literals;
+
+    // Split on top-level '|'
+    size_t start = 0;
+    for (size_t i = 0; i <= regex.size(); ++i) {
+        if (i < regex.size()) {
+            char c = regex[i];
+            if (c == '\\') {
+                ++i;
+                continue;
+            }
+            if (c == '[' || c == '(') {
+                i = skip_bracketed(regex, i) - 1;
+                continue;
+            }
+            if (c != '|') {
+                continue;
+            }
+        }
+
+        std::string literal = longest_run(regex.substr(start, i - start));
+        if (literal.empty()) {
+            return std::nullopt;
+        }
+        literals.push_back(std::move(literal));
+        start = i + 1;
+    }
+
+    return literals;
+}
+
+//=============================================================================
+// LiteralScanner Implementation
+//=============================================================================
+
+void LiteralScanner::add(std::string_view literal, uint32_t owner) {
+    if (!literal.empty()) {
+        literals_.emplace_back(std::string(literal), owner);
+    }
+}
+
+void LiteralScanner::build() {
+    next_.clear();
+    output_begin_.clear();
+    outputs_.clear();
+    if (literals_.empty()) {
+        return;
+    }
+
+    // Byte classes: every byte used by a literal gets its own
+    byte_class_.fill(0);
+    classes_ = 1;
+    for (const auto& [literal, owner] : literals_) {
+        for (unsigned char c : literal) {
+            if (byte_class_[c] == 0) {
+                byte_class_[c] = static_cast<uint16_t>(classes_++);
+            }
+        }
+    }
+
+    // Trie; 0 in next_ doubles as "no edge" since nothing links to the root
+    std::vector<std::vector<uint32_t>> state_owners(1);
+    next_.assign(classes_, 0);
+    for (const auto& [literal, owner] : literals_) {
+        uint32_t state = 0;
+        for (unsigned char c : literal) {
+            uint32_t& edge = next_[state * classes_ + byte_class_[c]];
+            if (edge == 0) {
+                edge = static_cast<uint32_t>(state_owners.size());
+                state_owners.emplace_back();
+                next_.resize(next_.size() + classes_, 0);
+            }
+            state = next_[state * classes_ + byte_class_[c]];
+        }
+        state_owners[state].push_back(owner);
+    }
+
+    // Breadth-first failure links, folded into a complete transition table
+    std::vector<uint32_t> fail(state_owners.size(), 0);
+    std::deque<uint32_t> queue;
+    for (size_t cls = 0; cls < classes_; ++cls) {
+        if (uint32_t child = next_[cls]) {
+            queue.push_back(child);
+        }
+    }
+    while (!queue.empty()) {
+        uint32_t state = queue.front();
+        queue.pop_front();
+
+        const auto& inherited = state_owners[fail[state]];
+        state_owners[state].insert(state_owners[state].end(), inherited.begin(), inherited.end());
+
+        for (size_t cls = 0; cls < classes_; ++cls) {
+            uint32_t& edge = next_[state * classes_ + cls];
+            uint32_t via_fail = next_[fail[state] * classes_ + cls];
+            if (edge) {
+                fail[edge] = via_fail;
+                queue.push_back(edge);
+            } else {
+                edge = via_fail;
+            }
+        }
+    }
+
+    output_begin_.reserve(state_owners.size() + 1);
+    for (auto& owners : state_owners) {
+        std::sort(owners.begin(), owners.end());
+        owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+        output_begin_.push_back(static_cast<uint32_t>(outputs_.size()));
+        outputs_.insert(outputs_.end(), owners.begin(), owners.end());
+    }
+    output_begin_.push_back(static_cast<uint32_t>(outputs_.size()));
+}
+
+} // namespace detail
+} // namespace agentlog
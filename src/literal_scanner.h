@@ -0,0 +1,76 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_LITERAL_SCANNER_H
+#define AGENTLOG_LITERAL_SCANNER_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace agentlog {
+namespace detail {
+
+/**
+ * @brief Literals one of which every match of an ECMAScript regex contains
+ *
+ * One literal per top-level alternative: the longest run of characters
+ * that alternative always matches verbatim. Returns nullopt when some
+ * alternative has no such run (e.g. "\\d+" or "[a-z]+"), in which case
+ * the regex cannot be prefiltered. The analysis is conservative: classes,
+ * groups, escapes with special meaning and quantified characters all end
+ * a run rather than being interpreted.
+ */
+std::optional<std::vector<std::string>> required_literals(std::string_view regex);
+
+/**
+ * @brief Aho-Corasick scanner reporting which owners' literals occur in a text
+ *
+ * Literals are added with an owner id and compiled by build() into a dense
+ * transition table over byte classes (bytes that occur in no literal share
+ * one class), so a scan costs one table lookup per input byte however
+ * many literals are registered.
+ */
+class LiteralScanner {
+public:
+    void add(std::string_view literal, uint32_t owner);
+
+    // Compile everything added so far; needed before scan() after any add()
+    void build();
+
+    bool empty() const { return literals_.empty(); }
+
+    // Calls on_match(owner) for every occurrence of an owner's literal;
+    // an owner may be reported more than once
+    template <typename Fn>
+    void scan(std::string_view text, Fn&& on_match) const {
+        if (next_.empty()) {
+            return;
+        }
+        uint32_t state = 0;
+        for (unsigned char c : text) {
+            state = next_[state * classes_ + byte_class_[c]];
+            for (uint32_t i = output_begin_[state]; i < output_begin_[state + 1]; ++i) {
+                on_match(outputs_[i]);
+            }
+        }
+    }
+
+private:
+    std::vector<std::pair<std::string, uint32_t>> literals_;
+
+    std::array<uint16_t, 256> byte_class_{};  // Class 0 is "in no literal"
+    size_t classes_{1};
+    std::vector<uint32_t> next_;          // state * classes_ + class -> state
+    std::vector<uint32_t> output_begin_;  // Owners of state s: outputs_[begin[s], begin[s + 1])
+    std::vector<uint32_t> outputs_;
+};
+
+} // namespace detail
+} // namespace agentlog
+
+#endif // AGENTLOG_LITERAL_SCANNER_H
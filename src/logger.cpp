@@ -6,71 +6,65 @@
 #include "agentlog/pattern_engine.h"
 #include "agentlog/correlation_engine.h"
 #include "agentlog/incident_manager.h"
+#include "agentlog/storage.h"
+#include "event_queue.h"
+#include "file_sink.h"
+#include "pipeline_metrics.h"
+#include "sampler.h"
+#include "subscriber_hub.h"
+#include "state_snapshot.h"
 #include <iostream>
-#include <fstream>
-#include <random>
-#include <condition_variable>
-#include <queue>
+#include <algorithm>
+#include <filesystem>
 
 namespace agentlog {
 
-namespace {
-    // Thread-safe event queue
-    class EventQueue {
-    public:
-        explicit EventQueue(size_t max_size) : max_size_(max_size), shutdown_(false) {}
-        
-        bool push(const LogEvent& event) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            if (queue_.size() >= max_size_) {
-                return false;  // Queue full
-            }
-            queue_.push(event);
-            cv_.notify_one();
-            return true;
-        }
-        
-        bool pop(LogEvent& event) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [this] { return !queue_.empty() || shutdown_; });
-            
-            if (shutdown_ && queue_.empty()) {
-                return false;
-            }
-            
-            if (!queue_.empty()) {
-                event = std::move(queue_.front());
-                queue_.pop();
-                return true;
-            }
-            
-            return false;
-        }
-        
-        void shutdown() {
-            {
-                std::lock_guard<std::mutex> lock(mutex_);
-                shutdown_ = true;
-            }
-            cv_.notify_all();
-        }
-        
-        size_t size() const {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return queue_.size();
-        }
-        
-    private:
-        mutable std::mutex mutex_;
-        std::condition_variable cv_;
-        std::queue<LogEvent> queue_;
-        size_t max_size_;
-        bool shutdown_;
-    };
-}
+// One lane of the pipeline: a queue and the analysis state its workers
+// fill. An unpartitioned logger has a single partition served by every
+// worker; a partitioned one gives each worker its own.
+struct Logger::Partition {
+    std::unique_ptr<EventQueue> queue;
+    PatternEnginePtr pattern_engine;
+    CorrelationEnginePtr correlation_engine;
+    std::mutex history_mutex;  // Guards history
+    EventHistory history;
+    
+    // SPILL_TO_DISK overflow; the cursor is only moved under spill_mutex
+    std::unique_ptr<EventStore> spill;
+    EventStore::Cursor spill_cursor;
+    std::atomic<bool> spill_pending{false};
+    std::mutex spill_mutex;
+};
+
+struct Logger::Metrics {
+    // Emit path
+    detail::ShardedCounter events_total;
+    detail::ShardedCounter dropped_newest;
+    detail::ShardedCounter dropped_oldest;
+    detail::ShardedCounter shed;
+    detail::ShardedCounter blocked;
+    detail::ShardedCounter spilled;
+    
+    // Workers
+    detail::ShardedCounter replayed;
+    detail::ShardedCounter anomalies;
+    detail::ShardedCounter patterns_matched;
+    detail::ShardedCounter correlations_found;
+    detail::ShardedCounter incidents_created;
+    
+    detail::LatencyHistogram queue_wait;
+    detail::LatencyHistogram anomaly_stage;
+    detail::LatencyHistogram storage_stage;
+    detail::LatencyHistogram pattern_stage;
+    detail::LatencyHistogram correlation_stage;
+    detail::LatencyHistogram incident_stage;
+    detail::LatencyHistogram callback_stage;
+    detail::LatencyHistogram sink_stage;
+};
 
-// Global event queue
-static std::unique_ptr<EventQueue> g_event_queue;
+Logger::Logger()
+    : subscribers_(std::make_unique<SubscriberHub>()),
+      metrics_(std::make_unique<Metrics>()) {}
 
 Logger& Logger::instance() {
     static Logger logger;
@@ -86,33 +80,104 @@ void Logger::init(const Config& config) {
     }
     
     config_ = config;
+    min_severity_.store(static_cast<int>(config.min_severity), std::memory_order_relaxed);
+    
+    Sampler::Config sampler_config;
+    sampler_config.rate = config.sampling_rate;
+    sampler_config.keep_anomalies = config.sample_anomalies_always;
+    sampler_config.by_trace_id = config.sample_by_trace_id;
+    sampler_config.target_per_second = config.sampling_target_per_sec;
+    sampler_ = std::make_unique<Sampler>(sampler_config);
     
     // Open log file if configured
     if (!config.log_file_path.empty()) {
-        log_file_.open(config.log_file_path, std::ios::out | std::ios::app);
-        if (!log_file_.is_open()) {
+        FileSink::Config sink_config;
+        sink_config.path = config.log_file_path;
+        sink_config.buffer_size = config.log_buffer_size;
+        sink_config.max_pending = std::max<size_t>(config.log_buffer_size * 64, 1024 * 1024);
+        sink_config.flush_interval = config.log_flush_interval;
+        sink_config.sync = config.log_fdatasync;
+        sink_config.max_file_bytes = uint64_t(config.log_max_file_mb) * 1024 * 1024;
+        sink_config.rotate_interval = config.log_rotate_interval;
+        sink_config.max_total_bytes = uint64_t(config.log_max_total_mb) * 1024 * 1024;
+        
+        file_sink_ = std::make_unique<FileSink>(sink_config);
+        if (!file_sink_->is_open()) {
             std::cerr << "Failed to open log file: " << config.log_file_path << std::endl;
+            file_sink_.reset();
         } else {
             std::cout << "Logging to file: " << config.log_file_path << std::endl;
         }
     }
     
-    // Create event queue
-    g_event_queue = std::make_unique<EventQueue>(config.async_queue_size);
-    
     // Initialize AI components
     if (config.enable_anomaly_detection) {
         anomaly_detector_ = DetectorFactory::create_default();
     }
     
-    if (config.enable_pattern_matching) {
-        pattern_engine_ = std::make_shared<PatternEngine>();
-        pattern_engine_->register_builtin_patterns();
+    if (config.enable_storage) {
+        EventStore::Config store_config;
+        store_config.path = config.storage_path;
+        store_config.segment_bytes = uint64_t(std::max<size_t>(config.storage_segment_mb, 1)) * 1024 * 1024;
+        store_config.max_total_bytes = uint64_t(config.max_storage_mb) * 1024 * 1024;
+        
+        event_store_ = std::make_shared<EventStore>(store_config);
+        if (!event_store_->is_open()) {
+            std::cerr << "Failed to open event store: " << config.storage_path << std::endl;
+            event_store_.reset();
+        }
     }
     
-    if (config.enable_correlation) {
-        correlation_engine_ = std::make_shared<CorrelationEngine>();
-        correlation_engine_->register_builtin_relationships();
+    // Partitions split the queue capacity and correlator budget between them
+    bool partitioned = config.partition_key != Config::PartitionKey::NONE;
+    size_t partition_count = partitioned ? std::max<size_t>(config.worker_threads, 1) : 1;
+    partition_entity_ = SymbolTable::intern(config.partition_entity);
+    partitions_.clear();
+    for (size_t i = 0; i < partition_count; ++i) {
+        auto partition = std::make_unique<Partition>();
+        partition->queue = std::make_unique<EventQueue>(
+            std::max<size_t>(config.async_queue_size / partition_count, 1));
+        
+        // Spilled events only live until replayed, so a restart starts empty
+        if (config.overflow_policy == Config::OverflowPolicy::SPILL_TO_DISK) {
+            uint64_t spill_bytes = std::max<uint64_t>(
+                uint64_t(config.spill_max_mb) * 1024 * 1024 / partition_count, 1024 * 1024);
+            EventStore::Config spill_config;
+            spill_config.path = config.storage_path + "/spill/" + std::to_string(i);
+            spill_config.segment_bytes = std::min<uint64_t>(
+                uint64_t(std::max<size_t>(config.storage_segment_mb, 1)) * 1024 * 1024,
+                std::max<uint64_t>(spill_bytes / 4, 1024 * 1024));
+            spill_config.max_total_bytes = spill_bytes;
+            spill_config.reject_when_full = true;  // Never lose events already counted as spilled
+            
+            std::error_code ec;
+            std::filesystem::remove_all(spill_config.path, ec);
+            partition->spill = std::make_unique<EventStore>(spill_config);
+            if (!partition->spill->is_open()) {
+                std::cerr << "Failed to open spill directory: " << spill_config.path << std::endl;
+                partition->spill.reset();
+            }
+        }
+        
+        if (config.enable_pattern_matching) {
+            partition->pattern_engine = std::make_shared<PatternEngine>();
+            partition->pattern_engine->register_builtin_patterns();
+        }
+        
+        if (config.enable_correlation) {
+            EventCorrelator::Config correlator_config;
+            correlator_config.max_age = config.correlation_max_age;
+            correlator_config.max_events =
+                std::max<size_t>(config.correlation_max_events / partition_count, 1);
+            correlator_config.max_correlations = correlator_config.max_events;
+            partition->correlation_engine = std::make_shared<CorrelationEngine>(correlator_config);
+            partition->correlation_engine->register_builtin_relationships();
+            if (event_store_) {
+                partition->correlation_engine->root_cause()->set_event_store(event_store_);
+            }
+        }
+        
+        partitions_.push_back(std::move(partition));
     }
     
     if (config.enable_auto_incidents) {
@@ -156,16 +221,32 @@ void Logger::init(const Config& config) {
         });
     }
     
-    // Start worker threads
+    // Warm-start the learned state before any event reaches the components
+    if (config.enable_state_snapshots) {
+        std::string path = snapshot_path();
+        if (load_state_snapshot(path)) {
+            std::cout << "Restored learned state from: " << path << std::endl;
+        }
+        if (config.snapshot_interval.count() > 0) {
+            snapshot_stop_ = false;
+            snapshot_thread_ = std::thread(&Logger::snapshot_worker, this);
+        }
+    }
+    
+    // Start worker threads; partitioned loggers run one per partition
     shutdown_requested_ = false;
     for (size_t i = 0; i < config.worker_threads; ++i) {
-        workers_.emplace_back(&Logger::async_worker, this);
+        workers_.emplace_back(&Logger::async_worker, this,
+                              std::ref(*partitions_[i % partitions_.size()]));
     }
     
     initialized_ = true;
     
     std::cout << "AgentLog v0.1.0 initialized for service: " 
               << config.service_name << std::endl;
+    if (partitioned) {
+        std::cout << "Pipeline partitioned " << partitions_.size() << " ways" << std::endl;
+    }
     std::cout << "AI Features: "
               << (config.enable_anomaly_detection ? "Anomaly " : "")
               << (config.enable_pattern_matching ? "Pattern " : "")
@@ -182,8 +263,8 @@ void Logger::shutdown() {
     }
     
     // Signal queue shutdown
-    if (g_event_queue) {
-        g_event_queue->shutdown();
+    for (auto& partition : partitions_) {
+        partition->queue->shutdown();
     }
     
     // Wait for workers to finish
@@ -194,15 +275,50 @@ void Logger::shutdown() {
     }
     
     workers_.clear();
-    g_event_queue.reset();
+    for (auto& partition : partitions_) {
+        partition->queue.reset();
+    }
+    
+    // Let async subscribers catch up with the last batches
+    if (!subscribers_->drain(std::chrono::seconds(5))) {
+        std::cerr << "AgentLog: Some async subscribers had not caught up at shutdown" << std::endl;
+    }
+    
+    // Stop periodic snapshots and save what the workers learned last
+    if (snapshot_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+            snapshot_stop_ = true;
+        }
+        snapshot_cv_.notify_all();
+        snapshot_thread_.join();
+    }
+    if (config_.enable_state_snapshots) {
+        save_state_snapshot(snapshot_path());
+    }
+    
+    // Writes out whatever the workers buffered and closes the file
+    file_sink_.reset();
+    
+    if (event_store_) {
+        event_store_->sync();
+    }
+    
+    // Let queued Jira/PagerDuty/Slack notifications go out before exit
+    if (incident_manager_) {
+        if (!incident_manager_->flush_integrations(std::chrono::seconds(5))) {
+            std::cerr << "AgentLog: Some incident notifications were not delivered" << std::endl;
+        }
+    }
     
     std::lock_guard<std::mutex> lock(mutex_);
     initialized_ = false;
     
+    auto stats = get_stats();
     std::cout << "AgentLog: Shutdown complete. Stats: "
-              << stats_.events_total << " events, "
-              << stats_.anomalies_detected << " anomalies, "
-              << stats_.events_dropped << " dropped" << std::endl;
+              << stats.events_total << " events, "
+              << stats.anomalies_detected << " anomalies, "
+              << stats.events_dropped << " dropped" << std::endl;
 }
 
 Logger::~Logger() {
@@ -211,6 +327,101 @@ Logger::~Logger() {
     }
 }
 
+//=============================================================================
+// State snapshots
+//=============================================================================
+
+std::string Logger::snapshot_path() const {
+    return config_.storage_path + "/state.snapshot";
+}
+
+namespace {
+
+// Partitions keep their own pattern and causality state, saved as
+// "<section>/<index>"; an unpartitioned logger uses the bare name
+std::string partition_section(const char* section, size_t index, size_t count) {
+    return count == 1 ? section : section + ("/" + std::to_string(index));
+}
+
+} // namespace
+
+bool Logger::save_state_snapshot(const std::string& path) const {
+    StateSnapshot snapshot;
+    
+    if (anomaly_detector_) {
+        std::string payload;
+        anomaly_detector_->serialize_state(payload);
+        snapshot.add("anomaly", std::move(payload));
+    }
+    
+    for (size_t i = 0; i < partitions_.size(); ++i) {
+        const Partition& partition = *partitions_[i];
+        
+        if (partition.pattern_engine) {
+            std::string payload;
+            partition.pattern_engine->serialize_state(payload);
+            snapshot.add(partition_section("patterns", i, partitions_.size()), std::move(payload));
+        }
+        
+        if (partition.correlation_engine) {
+            std::string payload;
+            partition.correlation_engine->causality()->serialize_state(payload);
+            snapshot.add(partition_section("causality", i, partitions_.size()), std::move(payload));
+        }
+    }
+    
+    return snapshot.save(path);
+}
+
+bool Logger::load_state_snapshot(const std::string& path) {
+    StateSnapshot snapshot;
+    if (!snapshot.load(path)) {
+        return false;
+    }
+    
+    // A bad section only costs that component its warm start. A partition
+    // with no section of its own starts from an unpartitioned snapshot
+    bool ok = true;
+    auto restore = [&](const std::string& section, const char* fallback, auto&& component) {
+        const std::string* payload = snapshot.find(section);
+        if (!payload) {
+            payload = snapshot.find(fallback);
+        }
+        if (payload && !component->restore_state(*payload)) {
+            std::cerr << "AgentLog: Discarding invalid '" << section
+                      << "' state in " << path << std::endl;
+            ok = false;
+        }
+    };
+    
+    if (anomaly_detector_) {
+        restore("anomaly", "anomaly", anomaly_detector_);
+    }
+    for (size_t i = 0; i < partitions_.size(); ++i) {
+        Partition& partition = *partitions_[i];
+        if (partition.pattern_engine) {
+            restore(partition_section("patterns", i, partitions_.size()), "patterns",
+                    partition.pattern_engine);
+        }
+        if (partition.correlation_engine) {
+            restore(partition_section("causality", i, partitions_.size()), "causality",
+                    partition.correlation_engine->causality());
+        }
+    }
+    
+    return ok;
+}
+
+void Logger::snapshot_worker() {
+    std::unique_lock<std::mutex> lock(snapshot_mutex_);
+    while (!snapshot_cv_.wait_for(lock, config_.snapshot_interval,
+                                  [this] { return snapshot_stop_; })) {
+        lock.unlock();
+        save_state_snapshot(snapshot_path());
+        lock.lock();
+    }
+}
+
 EventBuilder Logger::event(const std::string& event_type) {
     EventBuilder builder(event_type);
     return builder;
@@ -222,220 +433,576 @@ EventBuilder Logger::observe(const std::string& metric_name) {
     return builder;
 }
 
+LogEvent Logger::make_message(Severity severity) {
+    static const Symbol message_type = SymbolTable::intern("log.message");
+    LogEvent event;
+    event.event_type(message_type).severity(severity);
+    return event;
+}
+
 void Logger::trace(const std::string& msg) {
-    LogEvent event("log.message");
-    event.severity(Severity::TRACE).message(msg);
-    emit(event);
+    if (!is_enabled(Severity::TRACE)) return;
+    LogEvent event = make_message(Severity::TRACE);
+    event.message(msg);
+    emit(std::move(event));
 }
 
 void Logger::debug(const std::string& msg) {
-    LogEvent event("log.message");
-    event.severity(Severity::DEBUG).message(msg);
-    emit(event);
+    if (!is_enabled(Severity::DEBUG)) return;
+    LogEvent event = make_message(Severity::DEBUG);
+    event.message(msg);
+    emit(std::move(event));
 }
 
 void Logger::info(const std::string& msg) {
-    LogEvent event("log.message");
-    event.severity(Severity::INFO).message(msg);
-    emit(event);
+    if (!is_enabled(Severity::INFO)) return;
+    LogEvent event = make_message(Severity::INFO);
+    event.message(msg);
+    emit(std::move(event));
 }
 
 void Logger::warn(const std::string& msg) {
-    LogEvent event("log.message");
-    event.severity(Severity::WARNING).message(msg);
-    emit(event);
+    if (!is_enabled(Severity::WARNING)) return;
+    LogEvent event = make_message(Severity::WARNING);
+    event.message(msg);
+    emit(std::move(event));
 }
 
 void Logger::error(const std::string& msg) {
-    LogEvent event("log.message");
-    event.severity(Severity::ERROR).message(msg);
-    emit(event);
+    if (!is_enabled(Severity::ERROR)) return;
+    LogEvent event = make_message(Severity::ERROR);
+    event.message(msg);
+    emit(std::move(event));
 }
 
 void Logger::critical(const std::string& msg) {
-    LogEvent event("log.message");
-    event.severity(Severity::CRITICAL).message(msg).capture_stack_trace();
-    emit(event);
+    if (!is_enabled(Severity::CRITICAL)) return;
+    LogEvent event = make_message(Severity::CRITICAL);
+    event.message(msg).capture_stack_trace();
+    emit(std::move(event));
 }
 
 void Logger::emit(const LogEvent& event) {
+    // Callers that keep their event pay for one copy here
+    emit(LogEvent(event));
+}
+
+void Logger::emit(LogEvent&& event) {
+    // Apply sampling
+    if (initialized_ && !should_sample(event)) {
+        return;
+    }
+    emit_sampled(std::move(event));
+}
+
+void Logger::emit_sampled(LogEvent&& event) {
     if (!initialized_) {
         // Fallback: print to stderr if not initialized
         std::cerr << event.to_string() << std::endl;
         return;
     }
     
-    // Apply sampling
-    if (!should_sample(event)) {
+    // Update stats (sharded counters keep emitting threads off shared lines)
+    metrics_->events_total.add();
+    
+    // Push to queue for async processing
+    enqueue(*partitions_[partition_of(event)], std::move(event));
+}
+
+void Logger::enqueue(Partition& partition, LogEvent&& event) {
+    auto& queue = partition.queue;
+    if (!queue) {
         return;
     }
     
-    // Update stats
-    {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.events_total++;
+    switch (config_.overflow_policy) {
+        case Config::OverflowPolicy::DROP_NEWEST:
+            break;
+        
+        case Config::OverflowPolicy::BLOCK:
+            if (queue->push(std::move(event))) {
+                return;
+            }
+            metrics_->blocked.add();
+            if (queue->push_wait(std::move(event), config_.overflow_block_timeout)) {
+                return;
+            }
+            break;
+        
+        case Config::OverflowPolicy::DROP_OLDEST:
+            if (size_t evicted = queue->push_evicting(std::move(event))) {
+                metrics_->dropped_oldest.add(evicted);
+            }
+            return;
+        
+        case Config::OverflowPolicy::SHED_BY_SEVERITY: {
+            // Admission tightens as the queue fills, keeping headroom for
+            // the events that matter most
+            size_t capacity = queue->capacity();
+            size_t used = queue->size();
+            Severity severity = event.severity();
+            bool shed = severity <= Severity::DEBUG ? used * 2 >= capacity
+                      : severity == Severity::INFO ? used * 4 >= capacity * 3
+                      : severity == Severity::WARNING ? used * 10 >= capacity * 9
+                      : false;
+            if (shed) {
+                metrics_->shed.add();
+                return;
+            }
+            if (severity >= Severity::ERROR) {
+                if (size_t evicted = queue->push_evicting(std::move(event))) {
+                    metrics_->dropped_oldest.add(evicted);
+                }
+                return;
+            }
+            break;
+        }
+        
+        case Config::OverflowPolicy::SPILL_TO_DISK:
+            if (queue->push(std::move(event))) {
+                return;
+            }
+            if (partition.spill && partition.spill->append(event)) {
+                metrics_->spilled.add();
+                partition.spill_pending.store(true, std::memory_order_release);
+                return;
+            }
+            break;
     }
     
-    // Push to queue for async processing
-    if (g_event_queue && !g_event_queue->push(event)) {
-        // Queue full - drop event
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.events_dropped++;
+    // push() leaves the event intact when the queue is full
+    if (!queue->push(std::move(event))) {
+        metrics_->dropped_newest.add();
     }
 }
 
-void Logger::async_worker() {
-    while (!shutdown_requested_) {
-        LogEvent event;
-        if (g_event_queue && g_event_queue->pop(event)) {
-            process_event(event);
+size_t Logger::partition_of(const LogEvent& event) const {
+    if (partitions_.size() == 1) {
+        return 0;
+    }
+    
+    std::string_view key;
+    switch (config_.partition_key) {
+        case Config::PartitionKey::SERVICE_NAME:
+            key = event.service_name();
+            break;
+        case Config::PartitionKey::TRACE_ID:
+            key = event.trace_id();
+            break;
+        case Config::PartitionKey::ENTITY: {
+            auto it = event.entities().find(partition_entity_);
+            if (it != event.entities().end()) {
+                key = it->second;
+            }
+            break;
         }
+        case Config::PartitionKey::NONE:
+            break;
     }
     
-    // Drain remaining events
-    LogEvent event;
-    while (g_event_queue && g_event_queue->pop(event)) {
-        process_event(event);
+    if (key.empty()) {
+        return event.event_type_symbol().id() % partitions_.size();
     }
+    return std::hash<std::string_view>()(key) % partitions_.size();
 }
 
-void Logger::process_event(const LogEvent& event) {
-    LogEvent processed_event = event;
+void Logger::async_worker(Partition& partition) {
+    std::vector<LogEvent> batch;
+    std::vector<std::chrono::steady_clock::time_point> enqueued_at;
+    batch.reserve(std::max<size_t>(config_.max_batch_size, 1));
+    enqueued_at.reserve(batch.capacity());
     
-    // Apply anomaly detection
-    if (anomaly_detector_ && !processed_event.metrics().empty()) {
-        double score = anomaly_detector_->score(processed_event);
-        processed_event.anomaly_score(score);
+    // pop_batch() only returns 0 once the queue has been shut down and drained
+    for (;;) {
+        // Spilled events are replayed once the queue has room to absorb
+        // new ones while the batch is processed
+        if (partition.spill_pending.load(std::memory_order_acquire) && partition.queue &&
+            partition.queue->size() < partition.queue->capacity() / 2) {
+            replay_spill(partition, batch, false);
+        }
         
-        // Train detector
-        anomaly_detector_->train(processed_event);
+        if (!partition.queue ||
+            partition.queue->pop_batch(batch, std::max<size_t>(config_.max_batch_size, 1),
+                                       config_.max_batch_linger, &enqueued_at) == 0) {
+            break;
+        }
         
-        if (score >= 0.7) {
-            std::lock_guard<std::mutex> lock(stats_mutex_);
-            stats_.anomalies_detected++;
-            
-            // Trigger anomaly callbacks
-            std::lock_guard<std::mutex> cb_lock(mutex_);
-            for (const auto& callback : anomaly_callbacks_) {
-                callback(processed_event);
-            }
+        // Replayed spill never went through the queue, so only these count
+        auto picked_up = std::chrono::steady_clock::now();
+        for (auto pushed : enqueued_at) {
+            metrics_->queue_wait.record(picked_up - pushed);
         }
+        enqueued_at.clear();
+        
+        process_batch(partition, batch);
+        batch.clear();
     }
     
-    // Pattern matching
-    std::vector<std::string> matched_patterns;
-    if (pattern_engine_) {
-        auto matches = pattern_engine_->match_patterns(processed_event, event_history_);
-        if (!matches.empty()) {
-            std::lock_guard<std::mutex> lock(stats_mutex_);
-            stats_.patterns_matched += matches.size();
-            
-            for (const auto& match : matches) {
-                matched_patterns.push_back(match.pattern->name());
-            }
-        }
-        pattern_engine_->train_all(processed_event);
+    // Nothing is left to queue behind, so finish the spill in one go
+    while (replay_spill(partition, batch, true)) {}
+}
+
+bool Logger::replay_spill(Partition& partition, std::vector<LogEvent>& batch, bool drain) {
+    if (!partition.spill) {
+        return false;
     }
     
-    // Correlation analysis
-    std::vector<Correlation> correlations;
-    if (correlation_engine_) {
-        correlation_engine_->process(processed_event, event_history_);
-        correlations = correlation_engine_->correlator()->correlate(processed_event);
-        
-        if (!correlations.empty()) {
-            std::lock_guard<std::mutex> lock(stats_mutex_);
-            stats_.correlations_found += correlations.size();
+    // Workers sharing a partition take turns; the others go back to the queue
+    std::unique_lock<std::mutex> lock(partition.spill_mutex, std::defer_lock);
+    if (drain) {
+        lock.lock();
+    } else if (!lock.try_lock()) {
+        return false;
+    }
+    
+    // Cleared before reading, so an event spilled meanwhile sets it again
+    partition.spill_pending.store(false, std::memory_order_relaxed);
+    size_t max_events = std::max<size_t>(config_.max_batch_size, 1);
+    size_t read = partition.spill->read_from(partition.spill_cursor, max_events,
+                                             [&](LogEvent&& event) { batch.push_back(std::move(event)); });
+    if (read == max_events) {
+        partition.spill_pending.store(true, std::memory_order_relaxed);
+    }
+    if (read == 0) {
+        return false;
+    }
+    partition.spill->release(partition.spill_cursor);
+    
+    process_batch(partition, batch);
+    batch.clear();
+    metrics_->replayed.add(read);
+    return true;
+}
+
+void Logger::process_batch(Partition& partition, std::vector<LogEvent>& batch) {
+    uint64_t anomalies = 0;
+    uint64_t patterns_matched = 0;
+    uint64_t correlations_found = 0;
+    uint64_t incidents_created = 0;
+    
+    using clock = std::chrono::steady_clock;
+    Metrics& metrics = *metrics_;
+    
+    // Captured stack traces are symbolized here rather than on the
+    // emitting thread; events are still unshared, so this is safe
+    for (auto& event : batch) {
+        if (event.has_unresolved_stack_trace()) {
+            event.symbolize_stack_trace();
         }
     }
     
-    // Incident management
-    if (incident_manager_) {
-        auto incident = incident_manager_->evaluate_event(
-            processed_event, 
-            correlations,
-            matched_patterns
-        );
+    // Apply anomaly detection to events carrying metrics. This and
+    // symbolization are the only stages that modify events, so they run
+    // before the events are shared.
+    auto stage_start = clock::now();
+    if (anomaly_detector_) {
+        std::vector<const LogEvent*> scored;
+        std::vector<size_t> targets;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!batch[i].metrics().empty()) {
+                scored.push_back(&batch[i]);
+                targets.push_back(i);
+            }
+        }
         
-        if (incident) {
-            std::lock_guard<std::mutex> lock(stats_mutex_);
-            stats_.incidents_created++;
+        if (!scored.empty()) {
+            // Score against the model as it was, then train, in one pass
+            std::vector<double> scores;
+            anomaly_detector_->score_and_train_batch(scored, scores);
+            for (size_t i = 0; i < targets.size(); ++i) {
+                batch[targets[i]].anomaly_score(scores[i]);
+            }
+            
+            anomalies += std::count_if(scores.begin(), scores.end(),
+                                       [](double score) { return score >= 0.7; });
         }
     }
     
-    // Add to event history
+    auto stage_end = clock::now();
+    if (anomaly_detector_) {
+        metrics.anomaly_stage.record(stage_end - stage_start);
+    }
+    
+    // Publish: from here on every stage shares the same immutable event
+    std::vector<LogEventPtr> events;
+    events.reserve(batch.size());
+    for (auto& event : batch) {
+        events.push_back(std::make_shared<const LogEvent>(std::move(event)));
+    }
+    
+    // Persist before analysis so the store also covers evicted history
+    if (event_store_) {
+        stage_start = clock::now();
+        event_store_->append_batch(events);
+        metrics.storage_stage.record(clock::now() - stage_start);
+    }
+    
+    // Pattern matching and correlation need the history as it was before
+    // each event, so they run under one history lock for the whole batch.
+    // In a partitioned logger only this partition's worker takes it.
+    std::vector<std::vector<std::string>> matched_patterns(events.size());
+    std::vector<std::vector<CorrelationPtr>> correlations(events.size());
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        event_history_.push_back(processed_event);
-        if (event_history_.size() > max_history_size_) {
-            event_history_.pop_front();
+        std::lock_guard<std::mutex> lock(partition.history_mutex);
+        EventHistory& history = partition.history;
+        
+        if (partition.pattern_engine) {
+            stage_start = clock::now();
+            auto matches = partition.pattern_engine->match_patterns_batch(events, history);
+            for (size_t i = 0; i < matches.size(); ++i) {
+                patterns_matched += matches[i].size();
+                for (const auto& match : matches[i]) {
+                    matched_patterns[i].push_back(match.pattern->name());
+                }
+            }
+            metrics.pattern_stage.record(clock::now() - stage_start);
+        }
+        
+        if (partition.correlation_engine) {
+            stage_start = clock::now();
+            correlations = partition.correlation_engine->process_batch(events, history);
+            for (const auto& found : correlations) {
+                correlations_found += found.size();
+            }
+            metrics.correlation_stage.record(clock::now() - stage_start);
+        }
+        
+        // Add to event history
+        history.insert(history.end(), events.begin(), events.end());
+        while (history.size() > max_history_size_) {
+            history.pop_front();
         }
     }
     
-    // Trigger event callbacks
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (const auto& callback : event_callbacks_) {
-            callback(processed_event);
+    // Incident management
+    if (incident_manager_) {
+        stage_start = clock::now();
+        for (size_t i = 0; i < events.size(); ++i) {
+            auto incident = incident_manager_->evaluate_event(
+                *events[i],
+                correlations[i],
+                matched_patterns[i]
+            );
+            
+            if (incident) {
+                incidents_created++;
+            }
         }
+        metrics.incident_stage.record(clock::now() - stage_start);
     }
     
-    // Write to file if configured
-    if (log_file_.is_open()) {
-        std::lock_guard<std::mutex> file_lock(file_mutex_);
-        if (!matched_patterns.empty()) {
-            log_file_ << "[PATTERN:" << matched_patterns.front() << "] ";
+    metrics.anomalies.add(anomalies);
+    metrics.patterns_matched.add(patterns_matched);
+    metrics.correlations_found.add(correlations_found);
+    metrics.incidents_created.add(incidents_created);
+    
+    // Deliver to subscribers once the batch is fully analyzed
+    stage_start = clock::now();
+    subscribers_->publish(events);
+    metrics.callback_stage.record(clock::now() - stage_start);
+    
+    stage_start = clock::now();
+    
+    // Write to file if configured: the batch is formatted into this worker's
+    // buffer and handed to the sink in one append
+    if (file_sink_) {
+        thread_local std::string file_buffer;
+        file_buffer.clear();
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (!matched_patterns[i].empty()) {
+                file_buffer += "[PATTERN:";
+                file_buffer += matched_patterns[i].front();
+                file_buffer += "] ";
+            }
+            events[i]->to_string(file_buffer);
+            file_buffer += '\n';
         }
-        log_file_ << processed_event.to_string() << std::endl;
+        file_sink_->append(file_buffer);
     }
     
     // Print to console if enabled
     if (config_.log_to_console) {
-        if (!matched_patterns.empty()) {
-            std::cout << "🔍 PATTERN: " << matched_patterns.front() << " - ";
-        }
-        if (processed_event.is_anomalous()) {
-            std::cout << "🔴 " << processed_event.to_string() << std::endl;
-        } else if (processed_event.severity() >= Severity::WARNING) {
-            std::cout << "🟡 " << processed_event.to_string() << std::endl;
+        for (size_t i = 0; i < events.size(); ++i) {
+            const auto& event = *events[i];
+            if (!matched_patterns[i].empty()) {
+                std::cout << "🔍 PATTERN: " << matched_patterns[i].front() << " - ";
+            }
+            if (event.is_anomalous()) {
+                std::cout << "🔴 " << event.to_string() << std::endl;
+            } else if (event.severity() >= Severity::WARNING) {
+                std::cout << "🟡 " << event.to_string() << std::endl;
+            }
         }
     }
+    
+    if (file_sink_ || config_.log_to_console) {
+        metrics.sink_stage.record(clock::now() - stage_start);
+    }
 }
 
 bool Logger::should_sample(const LogEvent& event) const {
-    // Always keep anomalies and high-severity events
-    if (config_.sample_anomalies_always) {
-        if (event.is_anomalous() || event.severity() >= Severity::ERROR) {
-            return true;
-        }
-    }
-    
-    // Apply sampling rate
-    if (config_.sampling_rate >= 1.0) {
-        return true;
-    }
-    
-    // Random sampling
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 1.0);
-    
-    return dis(gen) < config_.sampling_rate;
+    return !sampler_ || sampler_->keep(event);
+}
+
+SubscriptionId Logger::subscribe(EventCallback callback, SubscriptionOptions options) {
+    return subscribers_->subscribe(std::move(callback), std::move(options));
+}
+
+bool Logger::unsubscribe(SubscriptionId id) {
+    return subscribers_->unsubscribe(id);
 }
 
 void Logger::on_event(EventCallback callback) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    event_callbacks_.push_back(std::move(callback));
+    subscribe(std::move(callback));
 }
 
 void Logger::on_anomaly(EventCallback callback) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    anomaly_callbacks_.push_back(std::move(callback));
+    SubscriptionOptions options;
+    options.filter.min_anomaly_score = 0.7;
+    subscribe(std::move(callback), std::move(options));
 }
 
+PatternEnginePtr Logger::pattern_engine(size_t partition) const {
+    return partition < partitions_.size() ? partitions_[partition]->pattern_engine : nullptr;
+}
+
+CorrelationEnginePtr Logger::correlation_engine(size_t partition) const {
+    return partition < partitions_.size() ? partitions_[partition]->correlation_engine : nullptr;
+}
+
+namespace {
+
+Logger::LatencyStats summarize(const detail::LatencyHistogram& histogram) {
+    Logger::LatencyStats stats;
+    stats.count = histogram.count();
+    if (stats.count == 0) {
+        return stats;
+    }
+    stats.mean_us = static_cast<double>(histogram.sum()) / stats.count / 1000.0;
+    stats.p50_us = histogram.percentile(0.50) / 1000.0;
+    stats.p90_us = histogram.percentile(0.90) / 1000.0;
+    stats.p99_us = histogram.percentile(0.99) / 1000.0;
+    stats.max_us = histogram.max() / 1000.0;
+    return stats;
+}
+
+void append_metric(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void append_value(std::string& out, const char* name, const char* labels, uint64_t value) {
+    out += name;
+    if (*labels) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+} // namespace
+
 Logger::Stats Logger::get_stats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    return stats_;
+    const Metrics& m = *metrics_;
+    Stats stats;
+    stats.events_total = m.events_total.value();
+    stats.events_dropped_newest = m.dropped_newest.value();
+    stats.events_dropped_oldest = m.dropped_oldest.value();
+    stats.events_shed = m.shed.value();
+    stats.events_dropped = stats.events_dropped_newest + stats.events_dropped_oldest + stats.events_shed;
+    stats.events_blocked = m.blocked.value();
+    stats.events_spilled = m.spilled.value();
+    stats.events_replayed = m.replayed.value();
+    stats.events_subscriber_dropped = subscribers_->dropped();
+    stats.anomalies_detected = m.anomalies.value();
+    stats.patterns_matched = m.patterns_matched.value();
+    stats.correlations_found = m.correlations_found.value();
+    stats.incidents_created = m.incidents_created.value();
+    
+    for (const auto& partition : partitions_) {
+        if (partition->queue) {
+            stats.queue_depth += partition->queue->size();
+            stats.queue_capacity += partition->queue->capacity();
+        }
+    }
+    
+    stats.queue_wait = summarize(m.queue_wait);
+    stats.anomaly_stage = summarize(m.anomaly_stage);
+    stats.storage_stage = summarize(m.storage_stage);
+    stats.pattern_stage = summarize(m.pattern_stage);
+    stats.correlation_stage = summarize(m.correlation_stage);
+    stats.incident_stage = summarize(m.incident_stage);
+    stats.callback_stage = summarize(m.callback_stage);
+    stats.sink_stage = summarize(m.sink_stage);
+    return stats;
+}
+
+std::string Logger::prometheus_metrics() const {
+    const Metrics& m = *metrics_;
+    Stats stats = get_stats();
+    std::string out;
+    
+    append_metric(out, "agentlog_events_total", "counter", "Events accepted by emit() after sampling.");
+    append_value(out, "agentlog_events_total", "", stats.events_total);
+    
+    append_metric(out, "agentlog_events_dropped_total", "counter", "Events lost to a full queue.");
+    append_value(out, "agentlog_events_dropped_total", "reason=\"newest\"", stats.events_dropped_newest);
+    append_value(out, "agentlog_events_dropped_total", "reason=\"oldest\"", stats.events_dropped_oldest);
+    append_value(out, "agentlog_events_dropped_total", "reason=\"shed\"", stats.events_shed);
+    
+    append_metric(out, "agentlog_events_blocked_total", "counter", "Emits that waited for queue space.");
+    append_value(out, "agentlog_events_blocked_total", "", stats.events_blocked);
+    append_metric(out, "agentlog_events_spilled_total", "counter", "Events spilled to disk.");
+    append_value(out, "agentlog_events_spilled_total", "", stats.events_spilled);
+    append_metric(out, "agentlog_events_replayed_total", "counter", "Spilled events processed.");
+    append_value(out, "agentlog_events_replayed_total", "", stats.events_replayed);
+    append_metric(out, "agentlog_subscriber_events_dropped_total", "counter",
+                  "Events dropped by full async subscriber queues.");
+    append_value(out, "agentlog_subscriber_events_dropped_total", "", stats.events_subscriber_dropped);
+    
+    append_metric(out, "agentlog_anomalies_detected_total", "counter", "Events scored as anomalous.");
+    append_value(out, "agentlog_anomalies_detected_total", "", stats.anomalies_detected);
+    append_metric(out, "agentlog_patterns_matched_total", "counter", "Pattern matches.");
+    append_value(out, "agentlog_patterns_matched_total", "", stats.patterns_matched);
+    append_metric(out, "agentlog_correlations_found_total", "counter", "Correlations found.");
+    append_value(out, "agentlog_correlations_found_total", "", stats.correlations_found);
+    append_metric(out, "agentlog_incidents_created_total", "counter", "Incidents created.");
+    append_value(out, "agentlog_incidents_created_total", "", stats.incidents_created);
+    
+    append_metric(out, "agentlog_queue_depth", "gauge", "Events waiting in the queues.");
+    append_value(out, "agentlog_queue_depth", "", stats.queue_depth);
+    append_metric(out, "agentlog_queue_capacity", "gauge", "Total queue capacity.");
+    append_value(out, "agentlog_queue_capacity", "", stats.queue_capacity);
+    
+    append_metric(out, "agentlog_queue_wait_seconds", "histogram",
+                  "Time from an event's push onto the queue until a worker picked it up.");
+    detail::write_prometheus_histogram(out, "agentlog_queue_wait_seconds", "", m.queue_wait);
+    
+    append_metric(out, "agentlog_stage_duration_seconds", "histogram",
+                  "Worker time per batch in each pipeline stage.");
+    const std::pair<const char*, const detail::LatencyHistogram*> stages[] = {
+        {"stage=\"anomaly\"", &m.anomaly_stage},
+        {"stage=\"storage\"", &m.storage_stage},
+        {"stage=\"pattern\"", &m.pattern_stage},
+        {"stage=\"correlation\"", &m.correlation_stage},
+        {"stage=\"incident\"", &m.incident_stage},
+        {"stage=\"callbacks\"", &m.callback_stage},
+        {"stage=\"sinks\"", &m.sink_stage},
+    };
+    for (const auto& [labels, histogram] : stages) {
+        detail::write_prometheus_histogram(out, "agentlog_stage_duration_seconds", labels, *histogram);
+    }
+    return out;
 }
 
 } // namespace agentlog
@@ -2,70 +2,159 @@
 // SPDX-License-Identifier: MIT
 
 #include "agentlog/pattern_engine.h"
+#include "binary_codec.h"
+#include "frequency_sketch.h"
+#include "literal_scanner.h"
 #include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <sstream>
+#include <typeinfo>
 
 namespace agentlog {
 
+using namespace detail;
+
+namespace {
+
+// Leading byte of every serialized pattern state
+constexpr uint8_t kStateVersion = 1;
+
+// Leading byte of a FrequencyPattern state in SKETCH counting
+constexpr uint8_t kSketchStateVersion = 2;
+
+} // namespace
+
 //=============================================================================
 // SequentialPattern Implementation
 //=============================================================================
 
+SequentialPattern::SequentialPattern(std::string name, std::vector<Step> steps)
+    : name_(std::move(name))
+    , steps_(std::move(steps))
+    , chain_ends_(steps_.size())
+    , match_count_(0)
+{
+    step_symbols_.reserve(steps_.size());
+    for (const auto& step : steps_) {
+        StepSymbols symbols{Symbol(step.event_type), {}, std::nullopt};
+        for (const auto& required : step.required_entities) {
+            symbols.required_entities.emplace_back(required);
+        }
+        if (step.entity_matcher) {
+            symbols.entity_regex.emplace(*step.entity_matcher);
+        }
+        step_symbols_.push_back(std::move(symbols));
+    }
+}
+
 double SequentialPattern::match(const LogEvent& event, 
-                               const std::deque<LogEvent>& context) {
+                               const EventHistory& /*context*/) {
     if (steps_.empty()) return 0.0;
     
     // Check if current event matches the last step
-    const auto& last_step = steps_.back();
-    if (!matches_step(event, last_step)) {
+    if (!matches_step(event, steps_.size() - 1)) {
         return 0.0;
     }
     
-    // If single-step pattern, we're done
-    if (steps_.size() == 1) {
-        std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Single-step patterns, or a run of every earlier step still open
+    size_t last = steps_.size() - 1;
+    if (last == 0 || chain_live(last - 1, event.timestamp())) {
         match_count_++;
         return 1.0;
     }
     
-    // For multi-step patterns, look for previous steps in context
-    size_t current_step = steps_.size() - 1;
-    auto current_time = event.timestamp();
-    
-    // Walk backwards through context to find matching steps
-    for (auto it = context.rbegin(); it != context.rend() && current_step > 0; ++it) {
-        const auto& prev_step = steps_[current_step - 1];
-        
-        // Check time constraint
-        auto time_diff = std::chrono::duration_cast<duration_t>(
-            current_time - it->timestamp()
-        );
-        
-        if (time_diff > prev_step.max_time_since_prev) {
-            break;  // Too old, pattern broken
-        }
-        
-        // Check if this event matches the previous step
-        if (matches_step(*it, prev_step)) {
-            current_step--;
-            current_time = it->timestamp();
-            
-            if (current_step == 0) {
-                // Found complete pattern!
-                std::lock_guard<std::mutex> lock(mutex_);
-                match_count_++;
-                return 1.0;
-            }
+    // Partial match: the longest run of leading steps still open, plus this
+    // event, out of the whole sequence
+    size_t found = 1;
+    for (size_t i = last - 1; i-- > 0;) {
+        if (chain_live(i, event.timestamp())) {
+            found = i + 2;
+            break;
         }
     }
     
-    // Calculate partial match score
-    double progress = 1.0 - (static_cast<double>(current_step) / steps_.size());
+    double progress = static_cast<double>(found) / steps_.size();
     return progress * 0.5;  // Partial matches get lower scores
 }
 
 void SequentialPattern::train(const LogEvent& event) {
-    // Sequential patterns don't need training
+    if (steps_.size() < 2) {
+        return;
+    }
+    
+    // Advance from the latest step down, so an event that matches two
+    // adjacent steps cannot link to itself. The final step only completes
+    // a match and is never extended, so it keeps no state.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = steps_.size() - 1; i-- > 0;) {
+        if (!matches_step(event, i)) {
+            continue;
+        }
+        if (i == 0 || chain_live(i - 1, event.timestamp())) {
+            chain_ends_[i] = event.timestamp();
+        }
+    }
+}
+
+bool SequentialPattern::chain_live(size_t index, timestamp_t now) const {
+    const auto& end = chain_ends_[index];
+    return end && std::chrono::duration_cast<duration_t>(now - *end) <=
+                      steps_[index].max_time_since_prev;
+}
+
+std::vector<Symbol> SequentialPattern::event_types() const {
+    std::vector<Symbol> types;
+    for (const auto& symbols : step_symbols_) {
+        if (std::find(types.begin(), types.end(), symbols.event_type) == types.end()) {
+            types.push_back(symbols.event_type);
+        }
+    }
+    return types;
+}
+
+// u8 version, varint step count, then per step a u8 flag and, when set,
+// the time that step's newest run completed
+void SequentialPattern::serialize_state(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, chain_ends_.size());
+    for (const auto& end : chain_ends_) {
+        out += static_cast<char>(end ? 1 : 0);
+        if (end) {
+            put_time(out, *end);
+        }
+    }
+}
+
+bool SequentialPattern::restore_state(std::string_view data) {
+    BinaryReader in(data);
+    std::vector<std::optional<timestamp_t>> chain_ends(steps_.size());
+    
+    if (in.u8() == kStateVersion) {
+        size_t count = in.count();
+        for (size_t i = 0; i < count && in.ok; ++i) {
+            bool has_end = in.u8() != 0;
+            timestamp_t end = has_end ? in.time() : timestamp_t();
+            // A snapshot of a differently shaped pattern restores nothing
+            if (has_end && count == chain_ends.size()) {
+                chain_ends[i] = end;
+            }
+        }
+    } else {
+        in.ok = false;
+    }
+    
+    if (!in.ok || !in.at_end()) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    chain_ends_ = std::move(chain_ends);
+    return true;
 }
 
 std::string SequentialPattern::description() const {
@@ -79,26 +168,27 @@ std::string SequentialPattern::description() const {
     return oss.str();
 }
 
-bool SequentialPattern::matches_step(const LogEvent& event, const Step& step) const {
+bool SequentialPattern::matches_step(const LogEvent& event, size_t index) const {
+    const auto& symbols = step_symbols_[index];
+    
     // Check event type
-    if (event.event_type() != step.event_type) {
+    if (event.event_type_symbol() != symbols.event_type) {
         return false;
     }
     
     // Check required entities
-    for (const auto& required : step.required_entities) {
+    for (const auto& required : symbols.required_entities) {
         if (event.entities().find(required) == event.entities().end()) {
             return false;
         }
     }
     
     // Check entity matcher regex
-    if (step.entity_matcher) {
-        std::regex pattern(*step.entity_matcher);
+    if (symbols.entity_regex) {
         bool found_match = false;
         
         for (const auto& [key, value] : event.entities()) {
-            if (std::regex_search(value, pattern)) {
+            if (std::regex_search(value, *symbols.entity_regex)) {
                 found_match = true;
                 break;
             }
@@ -114,25 +204,76 @@ bool SequentialPattern::matches_step(const LogEvent& event, const Step& step) co
 // FrequencyPattern Implementation
 //=============================================================================
 
+size_t FrequencySketchConfig::width_for(size_t threshold, duration_t window) const {
+    if (width > 0) {
+        return width;
+    }
+    double per_window = expected_events_per_second *
+                        std::chrono::duration<double>(window).count();
+    double columns = std::ceil(std::exp(1.0) * per_window /
+                               static_cast<double>(std::max<size_t>(threshold, 1)));
+    return static_cast<size_t>(std::clamp(columns, 64.0, double(1 << 24)));
+}
+
+// Fixed-memory counters replacing event_times_ and entity_times_
+struct FrequencyPattern::Sketch {
+    WindowedCounter events;
+    std::optional<WindowedCountMin> entities;  // REPEATED only
+    
+    Sketch(FrequencyType type, size_t threshold, duration_t window, const SketchConfig& config)
+        : events(window, config.buckets)
+    {
+        if (type == FrequencyType::REPEATED) {
+            entities.emplace(window, config.buckets, config.width_for(threshold, window),
+                             config.depth);
+        }
+    }
+};
+
+FrequencyPattern::FrequencyPattern(std::string name,
+                                   std::string event_type,
+                                   FrequencyType type,
+                                   size_t threshold,
+                                   duration_t window,
+                                   Counting counting,
+                                   SketchConfig sketch)
+    : name_(std::move(name))
+    , event_type_(std::move(event_type))
+    , event_symbol_(event_type_)
+    , type_(type)
+    , threshold_(threshold)
+    , window_(window)
+{
+    if (counting == Counting::SKETCH) {
+        sketch_ = std::make_unique<Sketch>(type_, threshold_, window_, sketch);
+    }
+}
+
+FrequencyPattern::~FrequencyPattern() = default;
+
 double FrequencyPattern::match(const LogEvent& event, 
-                              const std::deque<LogEvent>& context) {
+                              const EventHistory& context) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     // Only match events of our type
-    if (event.event_type() != event_type_) {
+    if (event.event_type_symbol() != event_symbol_) {
         return 0.0;
     }
     
     auto now = event.timestamp();
     auto cutoff = now - window_;
     
-    // Clean old entries
-    while (!event_times_.empty() && event_times_.front() < cutoff) {
-        event_times_.pop_front();
+    size_t count;
+    if (sketch_) {
+        count = static_cast<size_t>(sketch_->events.count(now));
+    } else {
+        // Clean old entries
+        while (!event_times_.empty() && event_times_.front() < cutoff) {
+            event_times_.pop_front();
+        }
+        count = event_times_.size();
     }
     
-    size_t count = event_times_.size();
-    
     switch (type_) {
         case FrequencyType::BURST: {
             // Check if we're over threshold
@@ -146,6 +287,16 @@ double FrequencyPattern::match(const LogEvent& event,
         
         case FrequencyType::REPEATED: {
             // Check if any entity appears too frequently
+            if (sketch_) {
+                for (const auto& [entity_key, entity_value] : event.entities()) {
+                    uint64_t hash = WindowedCountMin::hash(entity_value);
+                    if (sketch_->entities->estimate(hash, now) >= threshold_) {
+                        return 1.0;
+                    }
+                }
+                return 0.0;
+            }
+            
             for (const auto& [entity_key, entity_value] : event.entities()) {
                 auto& times = entity_times_[entity_value];
                 
@@ -171,12 +322,22 @@ double FrequencyPattern::match(const LogEvent& event,
 }
 
 void FrequencyPattern::train(const LogEvent& event) {
-    if (event.event_type() != event_type_) {
+    if (event.event_type_symbol() != event_symbol_) {
         return;
     }
     
     std::lock_guard<std::mutex> lock(mutex_);
     
+    if (sketch_) {
+        sketch_->events.add(event.timestamp());
+        if (sketch_->entities) {
+            for (const auto& [key, value] : event.entities()) {
+                sketch_->entities->add(WindowedCountMin::hash(value), event.timestamp());
+            }
+        }
+        return;
+    }
+    
     event_times_.push_back(event.timestamp());
     
     // Track entities
@@ -185,6 +346,87 @@ void FrequencyPattern::train(const LogEvent& event) {
     }
 }
 
+// EXACT: u8 version, varint n, n x time (event_times_), varint entity
+// count, then (str entity, varint n, n x time) per entity.
+// SKETCH: u8 sketch version, event counter, then the entity sketch if
+// REPEATED. Restoring into the other counting mode or another sketch size
+// fails.
+void FrequencyPattern::serialize_state(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (sketch_) {
+        out += static_cast<char>(kSketchStateVersion);
+        sketch_->events.serialize(out);
+        if (sketch_->entities) {
+            sketch_->entities->serialize(out);
+        }
+        return;
+    }
+    
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, event_times_.size());
+    for (const auto& ts : event_times_) {
+        put_time(out, ts);
+    }
+    
+    put_varint(out, entity_times_.size());
+    for (const auto& [entity, times] : entity_times_) {
+        put_str(out, entity);
+        put_varint(out, times.size());
+        for (const auto& ts : times) {
+            put_time(out, ts);
+        }
+    }
+}
+
+bool FrequencyPattern::restore_state(std::string_view data) {
+    BinaryReader in(data);
+    
+    if (sketch_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in.ok = in.u8() == kSketchStateVersion && sketch_->events.restore(in) &&
+                (!sketch_->entities || sketch_->entities->restore(in)) && in.at_end();
+        if (!in.ok) {
+            sketch_->events.clear();
+            if (sketch_->entities) {
+                sketch_->entities->clear();
+            }
+        }
+        return in.ok;
+    }
+    
+    std::deque<timestamp_t> event_times;
+    std::unordered_map<std::string, std::deque<timestamp_t>> entity_times;
+    
+    if (in.u8() == kStateVersion) {
+        size_t n = in.count();
+        for (size_t i = 0; i < n && in.ok; ++i) {
+            event_times.push_back(in.time());
+        }
+        
+        size_t count = in.count();
+        entity_times.reserve(count);
+        for (size_t i = 0; i < count && in.ok; ++i) {
+            auto& times = entity_times[std::string(in.str())];
+            n = in.count();
+            for (size_t j = 0; j < n && in.ok; ++j) {
+                times.push_back(in.time());
+            }
+        }
+    } else {
+        in.ok = false;
+    }
+    
+    if (!in.ok || !in.at_end()) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    event_times_ = std::move(event_times);
+    entity_times_ = std::move(entity_times);
+    return true;
+}
+
 std::string FrequencyPattern::description() const {
     std::ostringstream oss;
     oss << "Frequency pattern: " << event_type_;
@@ -200,6 +442,9 @@ std::string FrequencyPattern::description() const {
             oss << " (absence detection)";
             break;
     }
+    if (sketch_) {
+        oss << " [sketch]";
+    }
     
     return oss.str();
 }
@@ -209,24 +454,30 @@ std::string FrequencyPattern::description() const {
 //=============================================================================
 
 double RegexPattern::match(const LogEvent& event, 
-                          const std::deque<LogEvent>& context) {
-    std::string value;
+                          const EventHistory& /*context*/) {
+    auto value = field_value(event, field_);
+    if (!value) {
+        return 0.0;
+    }
     
-    if (field_ == "message") {
-        value = event.message();
-    } else if (field_ == "event_type") {
-        value = event.event_type();
-    } else {
-        // Check entities
-        auto it = event.entities().find(field_);
-        if (it != event.entities().end()) {
-            value = it->second;
-        } else {
-            return 0.0;
-        }
+    return std::regex_search(value->begin(), value->end(), regex_) ? 1.0 : 0.0;
+}
+
+std::optional<std::string_view> RegexPattern::field_value(const LogEvent& event,
+                                                          const std::string& field) {
+    if (field == "message") {
+        return std::string_view(event.message());
+    }
+    if (field == "event_type") {
+        return std::string_view(event.event_type());
     }
     
-    return std::regex_search(value, regex_) ? 1.0 : 0.0;
+    // Check entities
+    auto it = event.entities().find(field);
+    if (it == event.entities().end()) {
+        return std::nullopt;
+    }
+    return std::string_view(it->second);
 }
 
 std::string RegexPattern::description() const {
@@ -237,19 +488,140 @@ std::string RegexPattern::description() const {
 // PatternEngine Implementation
 //=============================================================================
 
+// One scanner per field over the literals of the regex patterns reading it.
+// A prefiltered pattern is a candidate for the current event when its
+// candidate epoch equals epoch; the rest of patterns_ is never skipped.
+struct PatternEngine::RegexPrefilter {
+    struct Field {
+        std::string name;
+        LiteralScanner scanner;
+        bool built{false};
+    };
+    
+    std::vector<Field> fields;
+    std::vector<bool> filtered;        // Per pattern index
+    std::vector<uint64_t> candidate;   // Per pattern index
+    uint64_t epoch{0};
+    
+    void add(size_t index, const PatternMatcher& pattern) {
+        filtered.resize(index + 1, false);
+        candidate.resize(index + 1, 0);
+        
+        // Only plain RegexPatterns: a subclass may match on more than its regex
+        if (typeid(pattern) != typeid(RegexPattern)) {
+            return;
+        }
+        const auto& regex = static_cast<const RegexPattern&>(pattern);
+        auto literals = required_literals(regex.pattern());
+        if (!literals) {
+            return;
+        }
+        
+        auto it = std::find_if(fields.begin(), fields.end(),
+            [&](const Field& field) { return field.name == regex.field(); });
+        if (it == fields.end()) {
+            it = fields.insert(fields.end(), Field{regex.field(), {}, false});
+        }
+        for (const auto& literal : *literals) {
+            it->scanner.add(literal, static_cast<uint32_t>(index));
+        }
+        it->built = false;
+        filtered[index] = true;
+    }
+    
+    void scan(const LogEvent& event) {
+        ++epoch;
+        for (auto& field : fields) {
+            if (!field.built) {
+                field.scanner.build();
+                field.built = true;
+            }
+            if (auto value = RegexPattern::field_value(event, field.name)) {
+                field.scanner.scan(*value, [this](uint32_t owner) { candidate[owner] = epoch; });
+            }
+        }
+    }
+    
+    bool skip(size_t index) const {
+        return filtered[index] && candidate[index] != epoch;
+    }
+};
+
+PatternEngine::PatternEngine() : prefilter_(std::make_unique<RegexPrefilter>()) {}
+
+PatternEngine::~PatternEngine() = default;
+
 void PatternEngine::register_pattern(std::shared_ptr<PatternMatcher> pattern) {
+    std::vector<Symbol> types = pattern->event_types();
+    
     std::lock_guard<std::mutex> lock(mutex_);
+    size_t index = patterns_.size();
+    prefilter_->add(index, *pattern);
     patterns_.push_back(std::move(pattern));
+    if (types.empty()) {
+        any_type_.push_back(index);
+    }
+    for (Symbol type : types) {
+        by_type_[type.id()].push_back(index);
+    }
+}
+
+const std::vector<size_t>& PatternEngine::relevant_locked(const LogEvent& event) {
+    auto it = by_type_.find(event.event_type_symbol().id());
+    if (it == by_type_.end()) {
+        return any_type_;
+    }
+    if (any_type_.empty()) {
+        return it->second;
+    }
+    
+    // Both lists are ascending; merge to keep registration order
+    relevant_.clear();
+    std::merge(it->second.begin(), it->second.end(),
+               any_type_.begin(), any_type_.end(), std::back_inserter(relevant_));
+    return relevant_;
 }
 
 std::vector<PatternEngine::PatternMatch> PatternEngine::match_patterns(
     const LogEvent& event,
-    const std::deque<LogEvent>& context) {
+    const EventHistory& context) {
     
-    std::vector<PatternMatch> matches;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return match_locked(event, context);
+}
+
+std::vector<std::vector<PatternEngine::PatternMatch>> PatternEngine::match_patterns_batch(
+    const std::vector<LogEventPtr>& events,
+    EventHistory& context) {
+    
+    std::vector<std::vector<PatternMatch>> results;
+    results.reserve(events.size());
     
     std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& pattern : patterns_) {
+    for (const auto& event : events) {
+        results.push_back(match_locked(*event, context));
+        for (size_t index : relevant_locked(*event)) {
+            patterns_[index]->train(*event);
+        }
+        context.push_back(event);
+    }
+    context.erase(context.end() - events.size(), context.end());
+    
+    return results;
+}
+
+std::vector<PatternEngine::PatternMatch> PatternEngine::match_locked(
+    const LogEvent& event,
+    const EventHistory& context) {
+    
+    std::vector<PatternMatch> matches;
+    
+    prefilter_->scan(event);
+    for (size_t index : relevant_locked(event)) {
+        if (prefilter_->skip(index)) {
+            continue;  // Its regex cannot match: no required literal present
+        }
+        const auto& pattern = patterns_[index];
         double score = pattern->match(event, context);
         if (score > 0.5) {  // Only report significant matches
             matches.push_back({
@@ -269,9 +641,50 @@ std::vector<PatternEngine::PatternMatch> PatternEngine::match_patterns(
 
 void PatternEngine::train_all(const LogEvent& event) {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& pattern : patterns_) {
-        pattern->train(event);
+    for (size_t index : relevant_locked(event)) {
+        patterns_[index]->train(event);
+    }
+}
+
+// u8 version, varint pattern count, then (str name, str state) per pattern
+void PatternEngine::serialize_state(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string pattern_state;
+    
+    out += static_cast<char>(kStateVersion);
+    put_varint(out, patterns_.size());
+    for (const auto& pattern : patterns_) {
+        pattern_state.clear();
+        pattern->serialize_state(pattern_state);
+        put_str(out, pattern->name());
+        put_str(out, pattern_state);
+    }
+}
+
+bool PatternEngine::restore_state(std::string_view data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BinaryReader in(data);
+    if (in.u8() != kStateVersion) {
+        return false;
     }
+    
+    bool ok = true;
+    size_t count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        std::string_view pattern_name = in.str();
+        std::string_view pattern_state = in.str();
+        if (!in.ok) {
+            break;
+        }
+        for (auto& pattern : patterns_) {
+            if (pattern->name() == pattern_name) {
+                ok = pattern->restore_state(pattern_state) && ok;
+                break;
+            }
+        }
+    }
+    
+    return ok && in.ok && in.at_end();
 }
 
 std::vector<std::shared_ptr<PatternMatcher>> PatternEngine::patterns() const {
@@ -300,23 +713,29 @@ std::shared_ptr<SequentialPattern> PatternFactory::cascading_failure() {
     return std::make_shared<SequentialPattern>("cascading_failure", std::move(steps));
 }
 
-std::shared_ptr<FrequencyPattern> PatternFactory::auth_failure_pattern() {
+std::shared_ptr<FrequencyPattern> PatternFactory::auth_failure_pattern(
+    FrequencyPattern::Counting counting, FrequencyPattern::SketchConfig sketch) {
     return std::make_shared<FrequencyPattern>(
         "auth_failure_burst",
         "auth.failed",
         FrequencyPattern::FrequencyType::REPEATED,
         5,  // 5 failures
-        std::chrono::seconds(60)
+        std::chrono::seconds(60),
+        counting,
+        sketch
     );
 }
 
-std::shared_ptr<FrequencyPattern> PatternFactory::retry_storm() {
+std::shared_ptr<FrequencyPattern> PatternFactory::retry_storm(
+    FrequencyPattern::Counting counting, FrequencyPattern::SketchConfig sketch) {
     return std::make_shared<FrequencyPattern>(
         "retry_storm",
         "api.retry",
         FrequencyPattern::FrequencyType::BURST,
         10,  // 10 retries
-        std::chrono::seconds(30)
+        std::chrono::seconds(30),
+        counting,
+        sketch
     );
 }
 
@@ -0,0 +1,163 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "pipeline_metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace agentlog {
+namespace detail {
+
+//=============================================================================
+// ShardedCounter Implementation
+//=============================================================================
+
+size_t ShardedCounter::shard_index() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return index;
+}
+
+uint64_t ShardedCounter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+//=============================================================================
+// LatencyHistogram Implementation
+//=============================================================================
+
+// Values below kSubBuckets get a bucket each; above that, bucket
+// (shift + 1) * kSubBuckets + sub holds [(kSubBuckets + sub) << shift,
+// (kSubBuckets + sub + 1) << shift)
+size_t LatencyHistogram::bucket_of(uint64_t ns) {
+    if (ns < kSubBuckets) {
+        return static_cast<size_t>(ns);
+    }
+    int top = 63 - __builtin_clzll(ns);
+    int shift = top - kSubBucketBits;
+    size_t sub = static_cast<size_t>(ns >> shift) & (kSubBuckets - 1);
+    return static_cast<size_t>(shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::lower_bound(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    int shift = static_cast<int>(bucket / kSubBuckets) - 1;
+    return (kSubBuckets + bucket % kSubBuckets) << shift;
+}
+
+uint64_t LatencyHistogram::upper_bound(size_t bucket) {
+    if (bucket + 1 >= kBuckets) {
+        return UINT64_MAX;
+    }
+    return lower_bound(bucket + 1) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets_[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (ns > seen && !max_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += buckets_[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Midpoint of the bucket, never above the largest value seen
+            uint64_t low = lower_bound(bucket);
+            uint64_t mid = low + (upper_bound(bucket) - low) / 2;
+            return std::min(mid, max());
+        }
+    }
+    return max();
+}
+
+uint64_t LatencyHistogram::count_at_most(uint64_t limit) const {
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < kBuckets && upper_bound(bucket) <= limit; ++bucket) {
+        total += buckets_[bucket].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+//=============================================================================
+// Prometheus export
+//=============================================================================
+
+namespace {
+
+constexpr int kFirstBoundaryBits = 10;  // 1.024us
+constexpr int kLastBoundaryBits = 34;   // ~17.2s
+constexpr int kBoundaryStepBits = 2;
+
+void append_seconds(std::string& out, uint64_t ns) {
+    char buffer[32];
+    int n = std::snprintf(buffer, sizeof(buffer), "%.12g", static_cast<double>(ns) / 1e9);
+    out.append(buffer, static_cast<size_t>(n));
+}
+
+void append_sample(std::string& out, std::string_view name, std::string_view suffix,
+                   std::string_view labels, std::string_view extra_label, uint64_t value) {
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra_label.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra_label.empty()) {
+            out += ',';
+        }
+        out += extra_label;
+        out += '}';
+    }
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+} // namespace
+
+void write_prometheus_histogram(std::string& out, std::string_view name,
+                                std::string_view labels, const LatencyHistogram& histogram) {
+    std::string le;
+    for (int bits = kFirstBoundaryBits; bits <= kLastBoundaryBits; bits += kBoundaryStepBits) {
+        uint64_t boundary = uint64_t(1) << bits;
+        le = "le=\"";
+        append_seconds(le, boundary);
+        le += '"';
+        append_sample(out, name, "_bucket", labels, le, histogram.count_at_most(boundary - 1));
+    }
+    uint64_t count = histogram.count();
+    append_sample(out, name, "_bucket", labels, "le=\"+Inf\"", count);
+
+    out += name;
+    out += "_sum";
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    append_seconds(out, histogram.sum());
+    out += '\n';
+    append_sample(out, name, "_count", labels, "", count);
+}
+
+} // namespace detail
+} // namespace agentlog
@@ -0,0 +1,100 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_PIPELINE_METRICS_H
+#define AGENTLOG_PIPELINE_METRICS_H
+
+#include "event_queue.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace agentlog {
+namespace detail {
+
+/**
+ * @brief Counter bumped from many threads without sharing a cache line
+ *
+ * Each thread adds to one of kShards padded slots, picked round-robin the
+ * first time it touches any counter; reads sum the slots.
+ */
+class ShardedCounter {
+public:
+    void add(uint64_t n = 1) {
+        shards_[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct alignas(kCacheLineSize) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    static size_t shard_index();
+
+    std::array<Shard, kShards> shards_;
+};
+
+/**
+ * @brief Log-linear (HDR-style) histogram of durations in nanoseconds
+ *
+ * Every power of two is split into kSubBuckets linear buckets, so a
+ * recorded value is known to within 1/kSubBuckets of itself across the
+ * full range. Recording is a few relaxed atomic adds; reads are not a
+ * consistent snapshot while writers run, which is fine for monitoring.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    void record(uint64_t ns);
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> elapsed) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    // Value below which a fraction q of the recorded values fall
+    uint64_t percentile(double q) const;
+
+    // Recorded values <= limit; exact when limit + 1 is a power of two
+    uint64_t count_at_most(uint64_t limit) const;
+
+    static size_t bucket_of(uint64_t ns);
+    static uint64_t lower_bound(size_t bucket);
+    static uint64_t upper_bound(size_t bucket);  // Inclusive
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief Append @p histogram in Prometheus text format, in seconds
+ *
+ * @p labels is empty or a comma-separated list such as `stage="pattern"`.
+ * The "le" boundaries are powers of four nanoseconds, 1.024us to ~17s.
+ * They fall on bucket edges, so each cumulative count is exact for the
+ * values below its boundary.
+ */
+void write_prometheus_histogram(std::string& out, std::string_view name,
+                                std::string_view labels, const LatencyHistogram& histogram);
+
+} // namespace detail
+} // namespace agentlog
+
+#endif // AGENTLOG_PIPELINE_METRICS_H
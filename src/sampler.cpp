@@ -0,0 +1,210 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "sampler.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace agentlog {
+
+namespace {
+
+// Weight of the newest interval in a type's smoothed rate
+constexpr double kRateSmoothing = 0.5;
+
+// Smoothed rates below this count as an idle type
+constexpr double kIdleRate = 1e-3;
+
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// FNV-1a with a final avalanche, so the top bits are usable as a draw
+uint64_t trace_hash(std::string_view trace_id) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : trace_id) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return mix64(hash);
+}
+
+// splitmix64 over per-thread state seeded once per thread
+uint64_t thread_random() {
+    thread_local uint64_t state = [] {
+        std::random_device rd;
+        uint64_t seed = (uint64_t(rd()) << 32) ^ rd();
+        return seed ^ reinterpret_cast<uintptr_t>(&state);
+    }();
+    state += 0x9e3779b97f4a7c15ULL;
+    return mix64(state);
+}
+
+int64_t nanos_of(timestamp_t ts) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count();
+}
+
+} // namespace
+
+//=============================================================================
+// Sampler Implementation
+//=============================================================================
+
+Sampler::Sampler(Config config)
+    : config_(std::move(config))
+    , base_threshold_(threshold_of(config_.rate)) {}
+
+Sampler::~Sampler() {
+    for (auto& chunk : chunks_) {
+        delete chunk.load(std::memory_order_relaxed);
+    }
+}
+
+uint64_t Sampler::threshold_of(double rate) {
+    if (!(rate > 0.0)) {
+        return 0;
+    }
+    if (rate >= 1.0) {
+        return kKeepAll;
+    }
+    return static_cast<uint64_t>(rate * static_cast<double>(kKeepAll));
+}
+
+Sampler::TypeState* Sampler::state_for(SymbolId type) {
+    size_t index = type / kChunkSize;
+    if (index >= kMaxChunks) {
+        return nullptr;
+    }
+
+    Chunk* chunk = chunks_[index].load(std::memory_order_acquire);
+    if (!chunk) {
+        auto fresh = std::make_unique<Chunk>();
+        for (auto& state : fresh->types) {
+            state.threshold.store(base_threshold_, std::memory_order_relaxed);
+        }
+        if (chunks_[index].compare_exchange_strong(chunk, fresh.get(),
+                                                   std::memory_order_acq_rel)) {
+            chunk = fresh.release();
+        }
+        // Otherwise another thread won and chunk now holds its table
+    }
+    return &chunk->types[type % kChunkSize];
+}
+
+const Sampler::TypeState* Sampler::find_state(SymbolId type) const {
+    size_t index = type / kChunkSize;
+    if (index >= kMaxChunks) {
+        return nullptr;
+    }
+    const Chunk* chunk = chunks_[index].load(std::memory_order_acquire);
+    return chunk ? &chunk->types[type % kChunkSize] : nullptr;
+}
+
+bool Sampler::keep(const LogEvent& event) {
+    // Always keep anomalies and high-severity events
+    if (config_.keep_anomalies &&
+        (event.is_anomalous() || event.severity() >= Severity::ERROR)) {
+        return true;
+    }
+
+    uint64_t threshold = base_threshold_;
+    if (config_.target_per_second > 0.0) {
+        int64_t now_ns = nanos_of(event.timestamp());
+        if (now_ns >= next_adjust_ns_.load(std::memory_order_relaxed)) {
+            adjust(now_ns);
+        }
+        if (TypeState* state = state_for(event.event_type_symbol().id())) {
+            state->seen.fetch_add(1, std::memory_order_relaxed);
+            threshold = state->threshold.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (threshold >= kKeepAll) {
+        return true;
+    }
+    if (threshold == 0) {
+        return false;
+    }
+
+    uint64_t draw = (config_.by_trace_id && !event.trace_id().empty())
+        ? trace_hash(event.trace_id())
+        : thread_random();
+    return (draw >> 32) < threshold;
+}
+
+double Sampler::rate_for(Symbol event_type) const {
+    uint64_t threshold = base_threshold_;
+    if (config_.target_per_second > 0.0) {
+        if (const TypeState* state = find_state(event_type.id())) {
+            threshold = state->threshold.load(std::memory_order_relaxed);
+        }
+    }
+    return static_cast<double>(threshold) / static_cast<double>(kKeepAll);
+}
+
+void Sampler::adjust(int64_t now_ns) {
+    // One thread adjusts; the others carry on with the current rates
+    std::unique_lock<std::mutex> lock(adjust_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || now_ns < next_adjust_ns_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    int64_t interval_ns = std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(config_.adjust_interval).count(), 1);
+    next_adjust_ns_.store(now_ns + interval_ns, std::memory_order_relaxed);
+
+    int64_t elapsed_ns = now_ns - last_adjust_ns_;
+    bool first = last_adjust_ns_ == 0;
+    last_adjust_ns_ = now_ns;
+    if (first || elapsed_ns <= 0) {
+        return;  // Counts so far only start the first interval
+    }
+    double elapsed = static_cast<double>(elapsed_ns) / 1e9;
+
+    // Smoothed arrival rate of every active type
+    std::vector<std::pair<double, TypeState*>> active;
+    for (auto& slot : chunks_) {
+        Chunk* chunk = slot.load(std::memory_order_acquire);
+        if (!chunk) {
+            continue;
+        }
+        for (auto& state : chunk->types) {
+            double rate = static_cast<double>(state.seen.exchange(0, std::memory_order_relaxed)) / elapsed;
+            if (rate == 0.0 && state.smoothed_rate == 0.0) {
+                continue;
+            }
+            state.smoothed_rate = state.smoothed_rate == 0.0
+                ? rate
+                : kRateSmoothing * rate + (1.0 - kRateSmoothing) * state.smoothed_rate;
+            if (state.smoothed_rate < kIdleRate) {
+                state.smoothed_rate = 0.0;
+                state.threshold.store(base_threshold_, std::memory_order_relaxed);
+                continue;
+            }
+            active.emplace_back(state.smoothed_rate, &state);
+        }
+    }
+
+    // Max-min fair split: the quietest types are served first, and any
+    // share they leave unused goes to the busier ones
+    std::sort(active.begin(), active.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    double budget = config_.target_per_second;
+    double base_rate = static_cast<double>(base_threshold_) / static_cast<double>(kKeepAll);
+    for (size_t i = 0; i < active.size(); ++i) {
+        auto [rate, state] = active[i];
+        double share = budget / static_cast<double>(active.size() - i);
+        double kept = std::min(rate * base_rate, share);
+        state->threshold.store(threshold_of(kept / rate), std::memory_order_relaxed);
+        budget -= kept;
+    }
+}
+
+} // namespace agentlog
@@ -0,0 +1,87 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_SAMPLER_H
+#define AGENTLOG_SAMPLER_H
+
+#include "agentlog/event.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace agentlog {
+
+/**
+ * @brief Thread-safe event sampling decision for the emit path
+ *
+ * Each emitting thread draws from its own RNG, so no state is shared on
+ * the non-adaptive path. Events with a trace ID are decided by a hash of
+ * the ID instead, so a trace is kept or dropped as a whole.
+ *
+ * The adaptive mode counts events per event type and, once per
+ * adjust_interval of event time, sets each type's rate so the kept events
+ * fit target_per_second. The budget is shared max-min fairly: types
+ * below an equal share keep their base rate, and the rest split what is
+ * left. Rates never exceed the base rate. Hash-based decisions stay
+ * nested across rates, so a trace kept at the lowest of its types' rates
+ * is kept in full.
+ */
+class Sampler {
+public:
+    struct Config {
+        double rate{1.0};               // Base fraction of events kept
+        bool keep_anomalies{true};      // Anomalous and ERROR+ events bypass sampling and the budget
+        bool by_trace_id{true};         // Decide traced events by trace ID hash
+        double target_per_second{0.0};  // Adaptive budget of kept events; 0 = off
+        std::chrono::milliseconds adjust_interval{1000};
+    };
+
+    explicit Sampler(Config config);
+    ~Sampler();
+
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    // Whether to keep @p event; safe to call from any thread
+    bool keep(const LogEvent& event);
+
+    // Fraction of @p event_type currently kept (before the severity bypass)
+    double rate_for(Symbol event_type) const;
+
+private:
+    // Draws are uniform in [0, 2^32); an event is kept if draw < threshold
+    static constexpr uint64_t kKeepAll = uint64_t(1) << 32;
+
+    static constexpr size_t kChunkSize = 1024;   // Event types per table chunk
+    static constexpr size_t kMaxChunks = 256;    // Types with larger ids use the base rate
+
+    struct TypeState {
+        std::atomic<uint64_t> seen{0};           // Since the last adjustment
+        std::atomic<uint64_t> threshold{kKeepAll};
+        double smoothed_rate{0.0};               // Events/s; adjuster only
+    };
+
+    struct Chunk {
+        std::array<TypeState, kChunkSize> types;
+    };
+
+    static uint64_t threshold_of(double rate);
+
+    TypeState* state_for(SymbolId type);         // Allocates its chunk on first use
+    const TypeState* find_state(SymbolId type) const;
+    void adjust(int64_t now_ns);
+
+    Config config_;
+    uint64_t base_threshold_;
+    std::array<std::atomic<Chunk*>, kMaxChunks> chunks_{};
+
+    std::atomic<int64_t> next_adjust_ns_{0};     // Event time of the next adjustment
+    std::mutex adjust_mutex_;
+    int64_t last_adjust_ns_{0};
+};
+
+} // namespace agentlog
+
+#endif // AGENTLOG_SAMPLER_H
@@ -0,0 +1,249 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "socket_util.h"
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace agentlog {
+namespace detail {
+
+//=============================================================================
+// Endpoint parsing
+//=============================================================================
+
+std::optional<Endpoint> parse_endpoint(std::string_view spec) {
+    static constexpr struct {
+        std::string_view scheme;
+        Endpoint::Transport transport;
+    } kSchemes[] = {
+        {"tcp://", Endpoint::Transport::TCP},
+        {"udp://", Endpoint::Transport::UDP},
+        {"unix://", Endpoint::Transport::UNIX_STREAM},
+        {"unixgram://", Endpoint::Transport::UNIX_DGRAM},
+    };
+
+    Endpoint endpoint;
+    bool known = false;
+    for (const auto& scheme : kSchemes) {
+        if (spec.substr(0, scheme.scheme.size()) == scheme.scheme) {
+            endpoint.transport = scheme.transport;
+            spec.remove_prefix(scheme.scheme.size());
+            known = true;
+            break;
+        }
+    }
+    if (!known || spec.empty()) {
+        return std::nullopt;
+    }
+
+    if (endpoint.is_unix()) {
+        endpoint.path = std::string(spec);
+        return endpoint;
+    }
+
+    // host:port, with [v6-address]:port
+    size_t colon = spec.rfind(':');
+    if (colon == std::string_view::npos || colon + 1 == spec.size()) {
+        return std::nullopt;
+    }
+    std::string_view host = spec.substr(0, colon);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    unsigned long port = 0;
+    for (char c : spec.substr(colon + 1)) {
+        if (c < '0' || c > '9' || (port = port * 10 + (c - '0')) > 65535) {
+            return std::nullopt;
+        }
+    }
+    endpoint.host = host.empty() ? "0.0.0.0" : std::string(host);
+    endpoint.port = static_cast<uint16_t>(port);
+    return endpoint;
+}
+
+#ifndef _WIN32
+
+//=============================================================================
+// Sockets
+//=============================================================================
+
+namespace {
+
+int socket_type(const Endpoint& endpoint) {
+    int type = endpoint.is_stream() ? SOCK_STREAM : SOCK_DGRAM;
+#ifdef SOCK_CLOEXEC
+    type |= SOCK_CLOEXEC;
+#endif
+    return type;
+}
+
+bool unix_address(const Endpoint& endpoint, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (endpoint.path.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::memcpy(address.sun_path, endpoint.path.data(), endpoint.path.size());
+    return true;
+}
+
+addrinfo* resolve(const Endpoint& endpoint, bool passive) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = endpoint.is_stream() ? SOCK_STREAM : SOCK_DGRAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(endpoint.port);
+    if (getaddrinfo(endpoint.host.c_str(), port.c_str(), &hints, &result) != 0) {
+        errno = EADDRNOTAVAIL;
+        return nullptr;
+    }
+    return result;
+}
+
+} // namespace
+
+int open_listener(const Endpoint& endpoint, int backlog) {
+    int fd = -1;
+    if (endpoint.is_unix()) {
+        sockaddr_un address;
+        if (!unix_address(endpoint, address)) {
+            return -1;
+        }
+        // Replace a socket file left behind by a previous run, nothing else
+        struct stat st;
+        if (::lstat(endpoint.path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+            ::unlink(endpoint.path.c_str());
+        }
+        fd = ::socket(AF_UNIX, socket_type(endpoint), 0);
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close_socket(fd);
+            return -1;
+        }
+    } else {
+        addrinfo* addresses = resolve(endpoint, true);
+        if (!addresses) {
+            return -1;
+        }
+        for (addrinfo* ai = addresses; ai; ai = ai->ai_next) {
+            fd = ::socket(ai->ai_family, socket_type(endpoint), 0);
+            if (fd < 0) {
+                continue;
+            }
+            int on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+                break;
+            }
+            close_socket(fd);
+            fd = -1;
+        }
+        freeaddrinfo(addresses);
+        if (fd < 0) {
+            return -1;
+        }
+    }
+
+    if (!endpoint.is_stream()) {
+        // Room for bursts while the receive thread is busy decoding
+        int size = 4 * 1024 * 1024;
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    } else if (::listen(fd, backlog) != 0) {
+        close_socket(fd);
+        return -1;
+    }
+    set_nonblocking(fd);
+    return fd;
+}
+
+int open_connection(const Endpoint& endpoint) {
+    if (endpoint.is_unix()) {
+        sockaddr_un address;
+        if (!unix_address(endpoint, address)) {
+            return -1;
+        }
+        int fd = ::socket(AF_UNIX, socket_type(endpoint), 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close_socket(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    addrinfo* addresses = resolve(endpoint, false);
+    if (!addresses) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = addresses; ai; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, socket_type(endpoint), 0);
+        if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        close_socket(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd >= 0 && endpoint.transport == Endpoint::Transport::TCP) {
+        // Batches are already large; don't hold the tail of one back
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+uint16_t bound_port(int fd) {
+    sockaddr_storage address{};
+    socklen_t length = sizeof(address);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return 0;
+    }
+    if (address.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+    }
+    if (address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+    }
+    return 0;
+}
+
+void set_nonblocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+void close_socket(int fd) {
+    if (fd >= 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+    }
+}
+
+#else
+
+int open_listener(const Endpoint&, int) { errno = ENOSYS; return -1; }
+int open_connection(const Endpoint&) { errno = ENOSYS; return -1; }
+uint16_t bound_port(int) { return 0; }
+void set_nonblocking(int) {}
+void close_socket(int) {}
+
+#endif
+
+} // namespace detail
+} // namespace agentlog
@@ -0,0 +1,49 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_SOCKET_UTIL_H
+#define AGENTLOG_SOCKET_UTIL_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace agentlog {
+namespace detail {
+
+/**
+ * @brief A parsed ingestion endpoint (see agentlog/ingestion.h for the syntax)
+ */
+struct Endpoint {
+    enum class Transport { TCP, UDP, UNIX_STREAM, UNIX_DGRAM };
+
+    Transport transport{Transport::TCP};
+    std::string host;   // TCP and UDP
+    uint16_t port{0};
+    std::string path;   // Unix-domain
+
+    bool is_stream() const {
+        return transport == Transport::TCP || transport == Transport::UNIX_STREAM;
+    }
+    bool is_unix() const {
+        return transport == Transport::UNIX_STREAM || transport == Transport::UNIX_DGRAM;
+    }
+};
+
+std::optional<Endpoint> parse_endpoint(std::string_view spec);
+
+// Both return a socket or -1 with errno set. A listener is bound, listening
+// if it is a stream, and non-blocking; a stale unix socket file is replaced.
+// A connection is blocking; datagram sockets are connected as well.
+int open_listener(const Endpoint& endpoint, int backlog);
+int open_connection(const Endpoint& endpoint);
+
+uint16_t bound_port(int fd);
+void set_nonblocking(int fd);
+void close_socket(int fd);
+
+} // namespace detail
+} // namespace agentlog
+
+#endif // AGENTLOG_SOCKET_UTIL_H
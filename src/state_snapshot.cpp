@@ -0,0 +1,167 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "state_snapshot.h"
+#include "binary_codec.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace agentlog {
+
+using namespace detail;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[8] = {'A', 'G', 'L', 'S', 'T', 'A', 'T', 'E'};
+constexpr uint8_t kSnapshotVersion = 1;
+
+uint64_t fnv1a(std::string_view data) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool sync_file(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return ::_commit(::_fileno(file)) == 0;
+#else
+    return ::fsync(::fileno(file)) == 0;
+#endif
+}
+
+} // namespace
+
+//=============================================================================
+// StateSnapshot Implementation
+//=============================================================================
+
+void StateSnapshot::add(std::string name, std::string payload) {
+    sections_.emplace_back(std::move(name), std::move(payload));
+}
+
+const std::string* StateSnapshot::find(std::string_view name) const {
+    for (const auto& [section_name, payload] : sections_) {
+        if (section_name == name) {
+            return &payload;
+        }
+    }
+    return nullptr;
+}
+
+bool StateSnapshot::save(const std::string& path) const {
+    std::string data(kMagic, sizeof(kMagic));
+    data += static_cast<char>(kSnapshotVersion);
+    put_varint(data, sections_.size());
+    for (const auto& [name, payload] : sections_) {
+        put_str(data, name);
+        put_str(data, payload);
+    }
+    put_fixed64(data, fnv1a(data));
+
+    std::error_code ec;
+    fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+
+    std::string tmp_path = path + ".tmp";
+    std::FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "AgentLog: Cannot write state snapshot " << tmp_path
+                  << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size() &&
+                   sync_file(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::cerr << "AgentLog: Failed to write state snapshot " << tmp_path << std::endl;
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        std::cerr << "AgentLog: Failed to replace state snapshot " << path
+                  << ": " << ec.message() << std::endl;
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool StateSnapshot::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        if (errno != ENOENT) {
+            std::cerr << "AgentLog: Cannot read state snapshot " << path
+                      << ": " << std::strerror(errno) << std::endl;
+        }
+        return false;
+    }
+
+    std::string data;
+    char buf[64 * 1024];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+        data.append(buf, n);
+    }
+    bool read_error = std::ferror(file) != 0;
+    std::fclose(file);
+
+    if (read_error || data.size() < sizeof(kMagic) + 1 + 8 ||
+        std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "AgentLog: Ignoring invalid state snapshot " << path << std::endl;
+        return false;
+    }
+
+    std::string_view body(data.data(), data.size() - 8);
+    BinaryReader trailer(std::string_view(data).substr(body.size()));
+    if (trailer.fixed64() != fnv1a(body)) {
+        std::cerr << "AgentLog: Ignoring corrupt state snapshot " << path << std::endl;
+        return false;
+    }
+
+    BinaryReader in(body.substr(sizeof(kMagic)));
+    if (in.u8() != kSnapshotVersion) {
+        std::cerr << "AgentLog: Unsupported state snapshot version in " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::pair<std::string, std::string>> sections;
+    size_t count = in.count();
+    for (size_t i = 0; i < count && in.ok; ++i) {
+        std::string name(in.str());
+        std::string payload(in.str());
+        sections.emplace_back(std::move(name), std::move(payload));
+    }
+
+    if (!in.ok || !in.at_end()) {
+        std::cerr << "AgentLog: Ignoring truncated state snapshot " << path << std::endl;
+        return false;
+    }
+
+    sections_ = std::move(sections);
+    return true;
+}
+
+} // namespace agentlog
@@ -0,0 +1,50 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_STATE_SNAPSHOT_H
+#define AGENTLOG_STATE_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace agentlog {
+
+/**
+ * @brief Named blobs of learned state saved to and loaded from one file
+ *
+ * Each component serializes itself into its own section, so a snapshot
+ * taken with a component disabled still restores the others. The file is
+ *
+ *   8 bytes  magic "AGLSTATE"
+ *   u8       format version (1)
+ *   varint   section count, then (str name, str payload) per section
+ *   u64      FNV-1a of everything above (little-endian)
+ *
+ * and is replaced atomically: written to "<path>.tmp", synced, then renamed
+ * over the old snapshot, so a crash mid-save leaves the previous one intact.
+ */
+class StateSnapshot {
+public:
+    void add(std::string name, std::string payload);
+
+    // Payload of the named section, or nullptr if it is absent
+    const std::string* find(std::string_view name) const;
+
+    bool empty() const { return sections_.empty(); }
+
+    // Write to path atomically; reports failures on stderr
+    bool save(const std::string& path) const;
+
+    // Replace the sections with the ones in path. Returns false (quietly
+    // when the file does not exist) if nothing could be loaded.
+    bool load(const std::string& path);
+
+private:
+    std::vector<std::pair<std::string, std::string>> sections_;
+};
+
+} // namespace agentlog
+
+#endif // AGENTLOG_STATE_SNAPSHOT_H
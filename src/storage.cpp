@@ -1,5 +1,571 @@
 // Copyright (c) 2025 AgentLog Contributors
 // SPDX-License-Identifier: MIT
 
-// Placeholder for storage implementation
-// TODO: Implement RocksDB-based event storage
+#include "agentlog/storage.h"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace agentlog {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* kSegmentPrefix = "segment-";
+constexpr const char* kSegmentSuffix = ".events";
+
+int64_t to_nanos(timestamp_t ts) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count();
+}
+
+// Two bits of a 64-bit mask per key: a tiny bloom filter per index block
+uint64_t bloom_bits(uint64_t hash) {
+    hash *= 0x9E3779B97F4A7C15ull;
+    return (1ull << (hash >> 58)) | (1ull << ((hash >> 52) & 63));
+}
+
+uint64_t type_bloom(const Symbol& type) {
+    return bloom_bits(type.id());
+}
+
+uint64_t trace_bloom(std::string_view trace_id) {
+    return trace_id.empty() ? 0 : bloom_bits(std::hash<std::string_view>()(trace_id));
+}
+
+std::string segment_name(uint64_t sequence) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%020" PRIu64 "%s", kSegmentPrefix, sequence, kSegmentSuffix);
+    return name;
+}
+
+#ifndef _WIN32
+// Allocates every block of a new segment up front. The segment is written
+// through a shared mapping, where a page the filesystem cannot back (full
+// disk, quota) raises SIGBUS instead of failing a call; a sparse ftruncate
+// defers exactly that failure to the first write. Returns 0 or an errno.
+int reserve_segment(int fd, uint64_t size) {
+#ifdef __APPLE__
+    fstore_t store{F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, static_cast<off_t>(size), 0};
+    if (::fcntl(fd, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        if (::fcntl(fd, F_PREALLOCATE, &store) == -1) {
+            return errno;
+        }
+    }
+    return ::ftruncate(fd, static_cast<off_t>(size)) == 0 ? 0 : errno;
+#else
+    return ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+#endif
+}
+#endif
+
+} // namespace
+
+//=============================================================================
+// Segment
+//=============================================================================
+
+struct EventStore::Segment {
+    // Covers index_interval consecutive records
+    struct IndexEntry {
+        uint64_t offset;
+        uint32_t count{0};
+        int64_t min_ts{std::numeric_limits<int64_t>::max()};
+        int64_t max_ts{std::numeric_limits<int64_t>::min()};
+        uint64_t min_id{std::numeric_limits<uint64_t>::max()};
+        uint64_t max_id{0};
+        uint64_t type_bloom{0};
+        uint64_t trace_bloom{0};
+    };
+    
+    std::string path;
+    uint64_t sequence{0};
+    int fd{-1};
+    char* data{nullptr};
+    uint64_t mapped{0};    // Bytes mapped
+    uint64_t used{0};      // Bytes holding records
+    bool sealed{false};
+    
+    uint64_t events{0};
+    int64_t min_ts{std::numeric_limits<int64_t>::max()};
+    int64_t max_ts{std::numeric_limits<int64_t>::min()};
+    uint64_t min_id{std::numeric_limits<uint64_t>::max()};
+    uint64_t max_id{0};
+    std::vector<IndexEntry> index;
+    
+    ~Segment() { unmap(); }
+    
+    void unmap() {
+#ifndef _WIN32
+        if (data) {
+            ::munmap(data, mapped);
+            data = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+    
+    // Account for a record already written at offset
+    void note_record(uint64_t offset, uint64_t size, const LogEvent& event, size_t interval) {
+        if (events % interval == 0) {
+            index.push_back(IndexEntry{offset});
+        }
+        auto& entry = index.back();
+        int64_t ts = to_nanos(event.timestamp());
+        uint64_t id = event.event_id();
+        
+        entry.count++;
+        entry.min_ts = std::min(entry.min_ts, ts);
+        entry.max_ts = std::max(entry.max_ts, ts);
+        entry.min_id = std::min(entry.min_id, id);
+        entry.max_id = std::max(entry.max_id, id);
+        entry.type_bloom |= type_bloom(event.event_type_symbol());
+        entry.trace_bloom |= trace_bloom(event.trace_id());
+        
+        events++;
+        min_ts = std::min(min_ts, ts);
+        max_ts = std::max(max_ts, ts);
+        min_id = std::min(min_id, id);
+        max_id = std::max(max_id, id);
+        used = offset + size;
+    }
+    
+#ifndef _WIN32
+    bool map(uint64_t size, bool writable) {
+        int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        data = static_cast<char*>(p);
+        mapped = size;
+        return true;
+    }
+    
+    // Shrink the file to its records and remap it read-only
+    void seal() {
+        if (sealed || !data) {
+            return;
+        }
+        ::msync(data, used, MS_ASYNC);
+        ::munmap(data, mapped);
+        data = nullptr;
+        if (::ftruncate(fd, static_cast<off_t>(used)) != 0) {
+            std::cerr << "EventStore: Failed to truncate " << path << std::endl;
+        }
+        if (used > 0) {
+            map(used, false);
+        }
+        sealed = true;
+    }
+#endif
+};
+
+//=============================================================================
+// EventStore Implementation
+//=============================================================================
+
+EventStore::EventStore(Config config)
+    : config_(std::move(config)) {
+    if (config_.index_interval == 0) {
+        config_.index_interval = 1;
+    }
+#ifdef _WIN32
+    std::cerr << "EventStore: Memory-mapped storage is not supported on Windows yet" << std::endl;
+#else
+    std::error_code ec;
+    fs::create_directories(config_.path, ec);
+    if (ec) {
+        std::cerr << "EventStore: Cannot create " << config_.path << ": " << ec.message() << std::endl;
+        return;
+    }
+    open_ = open_segments() && roll_segment();
+#endif
+}
+
+EventStore::~EventStore() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+#ifndef _WIN32
+    if (!segments_.empty()) {
+        segments_.back()->seal();
+    }
+#endif
+    segments_.clear();
+}
+
+bool EventStore::append(const LogEvent& event) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    thread_local std::string scratch;
+    return append_locked(event, scratch);
+}
+
+bool EventStore::append_batch(const std::vector<LogEventPtr>& events) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    thread_local std::string scratch;
+    bool ok = true;
+    for (const auto& event : events) {
+        ok = append_locked(*event, scratch) && ok;
+    }
+    return ok;
+}
+
+bool EventStore::append_locked(const LogEvent& event, std::string& scratch) {
+    if (!open_) {
+        return false;
+    }
+    
+    scratch.clear();
+    event.encode_binary(scratch);
+    if (scratch.size() > config_.segment_bytes) {
+        return false;  // Can never fit in a segment
+    }
+    
+    Segment* active = segments_.back().get();
+    if (active->used + scratch.size() > active->mapped) {
+        if (config_.reject_when_full && config_.max_total_bytes > 0 &&
+            total_bytes() - active->mapped + active->used + config_.segment_bytes >
+                config_.max_total_bytes) {
+            return false;  // Full until the reader releases something
+        }
+        if (!roll_segment()) {
+            open_ = false;
+            return false;
+        }
+        active = segments_.back().get();
+    }
+    
+    uint64_t offset = active->used;
+    std::memcpy(active->data + offset, scratch.data(), scratch.size());
+    active->note_record(offset, scratch.size(), event, config_.index_interval);
+    return true;
+}
+
+void EventStore::sync() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+#ifndef _WIN32
+    if (open_ && !segments_.empty() && segments_.back()->used > 0) {
+        ::msync(segments_.back()->data, segments_.back()->used, MS_SYNC);
+    }
+#endif
+}
+
+bool EventStore::open_segments() {
+#ifdef _WIN32
+    return false;
+#else
+    std::vector<std::pair<uint64_t, fs::path>> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(config_.path, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(kSegmentPrefix, 0) != 0 ||
+            name.size() <= std::strlen(kSegmentPrefix) + std::strlen(kSegmentSuffix)) {
+            continue;
+        }
+        uint64_t sequence = 0;
+        if (std::sscanf(name.c_str() + std::strlen(kSegmentPrefix), "%" SCNu64, &sequence) == 1) {
+            files.emplace_back(sequence, entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    
+    // Rebuild each segment's index from its records; the first record that
+    // does not decode (zero-filled tail, torn write) marks the end
+    for (const auto& [sequence, path] : files) {
+        auto segment = std::make_unique<Segment>();
+        segment->path = path.string();
+        segment->sequence = sequence;
+        segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CLOEXEC);
+        next_sequence_ = std::max(next_sequence_, sequence + 1);
+        
+        struct stat st {};
+        if (segment->fd < 0 || ::fstat(segment->fd, &st) != 0) {
+            continue;
+        }
+        
+        uint64_t size = static_cast<uint64_t>(st.st_size);
+        if (size > 0 && segment->map(size, true)) {
+            uint64_t offset = 0;
+            while (size - offset >= 4) {
+                size_t consumed = 0;
+                auto event = LogEvent::decode_binary(
+                    std::string_view(segment->data + offset, size - offset), &consumed);
+                if (!event) {
+                    break;
+                }
+                segment->note_record(offset, consumed, *event, config_.index_interval);
+                offset += consumed;
+            }
+        }
+        
+        if (segment->events == 0) {
+            segment->unmap();
+            fs::remove(path, ec);
+            continue;
+        }
+        
+        segment->seal();
+        LogEvent::skip_ids_through(segment->max_id);
+        segments_.push_back(std::move(segment));
+    }
+    
+    enforce_retention();
+    return true;
+#endif
+}
+
+bool EventStore::roll_segment() {
+#ifdef _WIN32
+    return false;
+#else
+    if (!segments_.empty()) {
+        segments_.back()->seal();
+    }
+    
+    auto segment = std::make_unique<Segment>();
+    segment->sequence = next_sequence_++;
+    segment->path = (fs::path(config_.path) / segment_name(segment->sequence)).string();
+    segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    int error = segment->fd < 0 ? errno : reserve_segment(segment->fd, config_.segment_bytes);
+    if (error != 0 || !segment->map(config_.segment_bytes, true)) {
+        std::cerr << "EventStore: Cannot create segment " << segment->path;
+        if (error != 0) {
+            std::cerr << ": " << std::strerror(error);
+        }
+        std::cerr << std::endl;
+        segment->unmap();
+        std::error_code ec;
+        fs::remove(segment->path, ec);
+        return false;
+    }
+    
+    segments_.push_back(std::move(segment));
+    enforce_retention();
+    return true;
+#endif
+}
+
+uint64_t EventStore::total_bytes() const {
+    uint64_t total = 0;
+    for (const auto& segment : segments_) {
+        total += segment->sealed ? segment->used : segment->mapped;
+    }
+    return total;
+}
+
+void EventStore::enforce_retention() {
+    if (config_.max_total_bytes == 0 || config_.reject_when_full) {
+        return;
+    }
+    
+    uint64_t total = total_bytes();
+    
+    // Never drop the active segment
+    while (segments_.size() > 1 && total > config_.max_total_bytes) {
+        auto& oldest = segments_.front();
+        total -= oldest->sealed ? oldest->used : oldest->mapped;
+        std::string path = oldest->path;
+        oldest->unmap();
+        std::error_code ec;
+        fs::remove(path, ec);
+        segments_.erase(segments_.begin());
+        segments_dropped_++;
+    }
+}
+
+template<typename Visitor>
+void EventStore::scan_segment(const Segment& segment, const EventQuery& query, Visitor&& visit) const {
+    int64_t from = query.from ? to_nanos(*query.from) : std::numeric_limits<int64_t>::min();
+    int64_t to = query.to ? to_nanos(*query.to) : std::numeric_limits<int64_t>::max();
+    if (segment.events == 0 || segment.max_ts < from || segment.min_ts >= to) {
+        return;
+    }
+    
+    std::optional<Symbol> type;
+    uint64_t type_mask = 0;
+    if (query.event_type) {
+        type = Symbol(*query.event_type);
+        type_mask = type_bloom(*type);
+    }
+    uint64_t trace_mask = query.trace_id ? trace_bloom(*query.trace_id) : 0;
+    
+    for (const auto& entry : segment.index) {
+        if (entry.max_ts < from || entry.min_ts >= to ||
+            (entry.type_bloom & type_mask) != type_mask ||
+            (entry.trace_bloom & trace_mask) != trace_mask) {
+            continue;
+        }
+        
+        uint64_t offset = entry.offset;
+        for (uint32_t i = 0; i < entry.count; ++i) {
+            size_t consumed = 0;
+            auto event = LogEvent::decode_binary(
+                std::string_view(segment.data + offset, segment.used - offset), &consumed);
+            if (!event) {
+                break;
+            }
+            offset += consumed;
+            
+            int64_t ts = to_nanos(event->timestamp());
+            if (ts < from || ts >= to ||
+                (type && event->event_type_symbol() != *type) ||
+                (query.trace_id && event->trace_id() != *query.trace_id)) {
+                continue;
+            }
+            if (!visit(*event)) {
+                return;
+            }
+        }
+    }
+}
+
+size_t EventStore::scan(const EventQuery& query,
+                        const std::function<bool(const LogEvent&)>& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    size_t visited = 0;
+    bool stopped = false;
+    for (const auto& segment : segments_) {
+        scan_segment(*segment, query, [&](const LogEvent& event) {
+            visited++;
+            if (!visitor(event) || (query.limit > 0 && visited >= query.limit)) {
+                stopped = true;
+            }
+            return !stopped;
+        });
+        if (stopped) {
+            break;
+        }
+    }
+    return visited;
+}
+
+std::vector<LogEvent> EventStore::scan(const EventQuery& query) const {
+    std::vector<LogEvent> result;
+    scan(query, [&](const LogEvent& event) {
+        result.push_back(event);
+        return true;
+    });
+    return result;
+}
+
+std::optional<LogEvent> EventStore::get(uint64_t event_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    // Newest first; recent IDs are the ones looked up most
+    for (auto it = segments_.rbegin(); it != segments_.rend(); ++it) {
+        const Segment& segment = **it;
+        if (segment.events == 0 || event_id < segment.min_id || event_id > segment.max_id) {
+            continue;
+        }
+        
+        for (const auto& entry : segment.index) {
+            if (event_id < entry.min_id || event_id > entry.max_id) {
+                continue;
+            }
+            uint64_t offset = entry.offset;
+            for (uint32_t i = 0; i < entry.count; ++i) {
+                size_t consumed = 0;
+                auto event = LogEvent::decode_binary(
+                    std::string_view(segment.data + offset, segment.used - offset), &consumed);
+                if (!event) {
+                    break;
+                }
+                if (event->event_id() == event_id) {
+                    return event;
+                }
+                offset += consumed;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+size_t EventStore::read_from(Cursor& cursor, size_t max_events,
+                             const std::function<void(LogEvent&&)>& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    size_t visited = 0;
+    for (const auto& segment : segments_) {
+        if (segment->sequence < cursor.segment) {
+            continue;
+        }
+        if (segment->sequence > cursor.segment) {
+            cursor = Cursor{segment->sequence, 0};
+        }
+        
+        while (visited < max_events && cursor.offset < segment->used) {
+            size_t consumed = 0;
+            auto event = LogEvent::decode_binary(
+                std::string_view(segment->data + cursor.offset, segment->used - cursor.offset),
+                &consumed);
+            if (!event) {
+                cursor.offset = segment->used;  // Unreadable tail; nothing follows it
+                break;
+            }
+            cursor.offset += consumed;
+            visited++;
+            visitor(std::move(*event));
+        }
+        
+        // The active segment may still grow, so the cursor stays on it
+        if (visited >= max_events || !segment->sealed) {
+            break;
+        }
+    }
+    return visited;
+}
+
+size_t EventStore::release(const Cursor& cursor) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    
+    size_t released = 0;
+    while (segments_.size() > 1) {
+        auto& oldest = segments_.front();
+        bool consumed = oldest->sequence < cursor.segment ||
+                        (oldest->sequence == cursor.segment && cursor.offset >= oldest->used);
+        if (!oldest->sealed || !consumed) {
+            break;
+        }
+        std::string path = oldest->path;
+        oldest->unmap();
+        std::error_code ec;
+        fs::remove(path, ec);
+        segments_.erase(segments_.begin());
+        released++;
+    }
+    return released;
+}
+
+EventStore::Stats EventStore::get_stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    Stats stats;
+    stats.segments = segments_.size();
+    stats.segments_dropped = segments_dropped_;
+    for (const auto& segment : segments_) {
+        stats.events += segment->events;
+        stats.bytes += segment->used;
+    }
+    return stats;
+}
+
+} // namespace agentlog
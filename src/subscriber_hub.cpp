@@ -0,0 +1,186 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "subscriber_hub.h"
+#include <algorithm>
+
+namespace agentlog {
+
+//=============================================================================
+// SubscriberHub Implementation
+//=============================================================================
+
+SubscriberHub::~SubscriberHub() {
+    auto list = std::atomic_load(&list_);
+    for (const auto& subscriber : *list) {
+        stop(*subscriber);
+    }
+}
+
+bool SubscriberHub::Subscriber::matches(const LogEvent& event) const {
+    const SubscriptionFilter& filter = options.filter;
+    if (event.severity() < filter.min_severity ||
+        event.anomaly_score() < filter.min_anomaly_score) {
+        return false;
+    }
+    const std::string& type = event.event_type();
+    return type.compare(0, filter.event_type_prefix.size(), filter.event_type_prefix) == 0;
+}
+
+void SubscriberHub::Subscriber::run() {
+    std::vector<LogEventPtr> batch;
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    for (;;) {
+        queue_cv.wait(lock, [this] { return stop || !queue.empty(); });
+        if (queue.empty()) {
+            return;  // Stopped
+        }
+
+        // Take everything queued so the worker side is rarely blocked
+        batch.assign(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.end()));
+        queue.clear();
+        busy = true;
+        lock.unlock();
+
+        // Checked per event, so unsubscribe() need not wait out the batch
+        for (const auto& event : batch) {
+            if (stop.load(std::memory_order_relaxed)) {
+                break;
+            }
+            callback(*event);
+        }
+        batch.clear();
+
+        lock.lock();
+        busy = false;
+        if (queue.empty()) {
+            idle_cv.notify_all();
+        }
+    }
+}
+
+SubscriptionId SubscriberHub::subscribe(EventCallback callback, SubscriptionOptions options) {
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->callback = std::move(callback);
+    subscriber->options = std::move(options);
+    subscriber->options.queue_size = std::max<size_t>(subscriber->options.queue_size, 1);
+    if (subscriber->options.async) {
+        // The thread keeps its subscriber alive, in case it unsubscribes itself
+        subscriber->thread = std::thread([subscriber] { subscriber->run(); });
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    subscriber->id = next_id_++;
+    auto list = std::make_shared<List>(*std::atomic_load(&list_));
+    list->push_back(subscriber);
+    std::atomic_store(&list_, std::shared_ptr<const List>(std::move(list)));
+    return subscriber->id;
+}
+
+bool SubscriberHub::unsubscribe(SubscriptionId id) {
+    std::shared_ptr<Subscriber> removed;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto list = std::make_shared<List>(*std::atomic_load(&list_));
+        auto it = std::find_if(list->begin(), list->end(),
+                               [id](const auto& subscriber) { return subscriber->id == id; });
+        if (it == list->end()) {
+            return false;
+        }
+        removed = *it;
+        list->erase(it);
+        std::atomic_store(&list_, std::shared_ptr<const List>(std::move(list)));
+    }
+
+    stop(*removed);
+    retired_dropped_.fetch_add(removed->dropped.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+    return true;
+}
+
+// Queued events are discarded; a subscriber unsubscribing itself from its
+// own delivery thread lets that thread finish on its own
+void SubscriberHub::stop(Subscriber& subscriber) {
+    if (!subscriber.thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(subscriber.queue_mutex);
+        subscriber.stop = true;
+        subscriber.queue.clear();
+    }
+    subscriber.queue_cv.notify_all();
+    subscriber.idle_cv.notify_all();
+    if (subscriber.thread.get_id() == std::this_thread::get_id()) {
+        subscriber.thread.detach();
+    } else {
+        subscriber.thread.join();
+    }
+}
+
+void SubscriberHub::publish(const std::vector<LogEventPtr>& events) {
+    auto list = std::atomic_load(&list_);
+    for (const auto& subscriber : *list) {
+        if (!subscriber->options.async) {
+            std::lock_guard<std::mutex> lock(subscriber->call_mutex);
+            for (const auto& event : events) {
+                if (subscriber->matches(*event)) {
+                    subscriber->callback(*event);
+                }
+            }
+            continue;
+        }
+
+        size_t queued = 0;
+        uint64_t dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(subscriber->queue_mutex);
+            if (subscriber->stop) {
+                continue;
+            }
+            for (const auto& event : events) {
+                if (!subscriber->matches(*event)) {
+                    continue;
+                }
+                if (subscriber->queue.size() >= subscriber->options.queue_size) {
+                    dropped++;
+                    continue;
+                }
+                subscriber->queue.push_back(event);
+                queued++;
+            }
+        }
+        if (queued > 0) {
+            subscriber->queue_cv.notify_one();
+        }
+        if (dropped > 0) {
+            subscriber->dropped.fetch_add(dropped, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool SubscriberHub::drain(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto list = std::atomic_load(&list_);
+    bool drained = true;
+    for (const auto& subscriber : *list) {
+        if (!subscriber->options.async) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(subscriber->queue_mutex);
+        drained &= subscriber->idle_cv.wait_until(lock, deadline, [&] {
+            return subscriber->stop || (subscriber->queue.empty() && !subscriber->busy);
+        });
+    }
+    return drained;
+}
+
+uint64_t SubscriberHub::dropped() const {
+    uint64_t total = retired_dropped_.load(std::memory_order_relaxed);
+    for (const auto& subscriber : *std::atomic_load(&list_)) {
+        total += subscriber->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+} // namespace agentlog
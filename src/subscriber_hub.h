@@ -0,0 +1,84 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_SUBSCRIBER_HUB_H
+#define AGENTLOG_SUBSCRIBER_HUB_H
+
+#include "agentlog/logger.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace agentlog {
+
+/**
+ * @brief Filtered fan-out of processed events to subscriber callbacks
+ *
+ * The subscriber list is copy-on-write: publish() takes a snapshot with
+ * one atomic load and never locks it, while subscribe() and unsubscribe()
+ * replace the list under their own mutex. Synchronous subscribers are
+ * called on the publishing worker, one batch at a time per subscriber,
+ * so a callback never runs concurrently with itself. Async subscribers
+ * get a bounded queue and a delivery thread each; the worker only enqueues,
+ * and events that find the queue full are dropped and counted.
+ */
+class SubscriberHub {
+public:
+    SubscriberHub() = default;
+    ~SubscriberHub();
+
+    SubscriberHub(const SubscriberHub&) = delete;
+    SubscriberHub& operator=(const SubscriberHub&) = delete;
+
+    SubscriptionId subscribe(EventCallback callback, SubscriptionOptions options);
+
+    // An event already taken by a worker may still be delivered afterwards
+    bool unsubscribe(SubscriptionId id);
+
+    // Delivers the batch to every subscriber whose filter matches
+    void publish(const std::vector<LogEventPtr>& events);
+
+    // Waits until every async queue is empty and idle; false on timeout
+    bool drain(std::chrono::milliseconds timeout);
+
+    uint64_t dropped() const;
+
+private:
+    struct Subscriber {
+        SubscriptionId id{0};
+        EventCallback callback;
+        SubscriptionOptions options;
+        std::mutex call_mutex;  // Serializes synchronous delivery
+
+        // Async delivery
+        std::thread thread;
+        std::mutex queue_mutex;
+        std::condition_variable queue_cv;
+        std::condition_variable idle_cv;
+        std::deque<LogEventPtr> queue;
+        bool busy{false};
+        std::atomic<bool> stop{false};  // Written under queue_mutex
+        std::atomic<uint64_t> dropped{0};
+
+        bool matches(const LogEvent& event) const;
+        void run();
+    };
+
+    using List = std::vector<std::shared_ptr<Subscriber>>;
+
+    static void stop(Subscriber& subscriber);
+
+    std::shared_ptr<const List> list_{std::make_shared<const List>()};  // Atomic access only
+    std::mutex write_mutex_;
+    SubscriptionId next_id_{1};
+    std::atomic<uint64_t> retired_dropped_{0};  // From removed subscribers
+};
+
+} // namespace agentlog
+
+#endif // AGENTLOG_SUBSCRIBER_HUB_H
@@ -0,0 +1,132 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/symbol_table.h"
+#include <array>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace agentlog {
+
+namespace {
+
+/**
+ * Owns the interned strings. std::deque never relocates its elements, so
+ * the pointers handed out in Symbols stay valid for the life of the process.
+ * The table is intentionally leaked to stay usable during static destruction.
+ */
+struct InternStorage {
+    InternStorage() {
+        strings.emplace_back();
+        by_id.push_back(&strings.back());
+        by_text.emplace(std::string_view(strings.back()), 0);
+    }
+
+    std::shared_mutex mutex;
+    std::deque<std::string> strings;
+    std::vector<const std::string*> by_id;
+    std::unordered_map<std::string_view, SymbolId> by_text;
+};
+
+InternStorage& storage() {
+    static InternStorage* instance = new InternStorage();
+    return *instance;
+}
+
+const std::string* empty_string() {
+    static const std::string* empty = storage().by_id[0];
+    return empty;
+}
+
+// Direct-mapped per-thread cache in front of the shared table
+constexpr size_t kThreadCacheSize = 64;
+
+struct CacheEntry {
+    size_t hash{0};
+    const std::string* str{nullptr};
+    SymbolId id{0};
+};
+
+thread_local std::array<CacheEntry, kThreadCacheSize> t_cache;
+
+} // namespace
+
+Symbol::Symbol() noexcept : str_(empty_string()), id_(0) {}
+
+Symbol::Symbol(std::string_view text) : Symbol(SymbolTable::intern(text)) {}
+
+Symbol SymbolTable::intern(std::string_view text) {
+    return intern(text, static_cast<size_t>(-1));
+}
+
+Symbol SymbolTable::intern(std::string_view text, size_t max_size) {
+    if (text.empty()) {
+        return Symbol();
+    }
+
+    size_t hash = std::hash<std::string_view>()(text);
+    CacheEntry& cached = t_cache[hash % kThreadCacheSize];
+    if (cached.str && cached.hash == hash && *cached.str == text) {
+        return Symbol(cached.str, cached.id);
+    }
+
+    auto& table = storage();
+    Symbol symbol;
+    {
+        std::shared_lock<std::shared_mutex> lock(table.mutex);
+        auto it = table.by_text.find(text);
+        if (it != table.by_text.end()) {
+            symbol = Symbol(table.by_id[it->second], it->second);
+        }
+    }
+
+    if (symbol.empty()) {
+        std::unique_lock<std::shared_mutex> lock(table.mutex);
+        auto it = table.by_text.find(text);
+        if (it != table.by_text.end()) {
+            symbol = Symbol(table.by_id[it->second], it->second);
+        } else if (table.by_id.size() >= max_size) {
+            return Symbol();
+        } else {
+            auto id = static_cast<SymbolId>(table.by_id.size());
+            table.strings.emplace_back(text);
+            const std::string* str = &table.strings.back();
+            table.by_id.push_back(str);
+            table.by_text.emplace(std::string_view(*str), id);
+            symbol = Symbol(str, id);
+        }
+    }
+
+    cached = CacheEntry{hash, &symbol.str(), symbol.id()};
+    return symbol;
+}
+
+Symbol SymbolTable::find(std::string_view text) {
+    auto& table = storage();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    auto it = table.by_text.find(text);
+    if (it == table.by_text.end()) {
+        return Symbol();
+    }
+    return Symbol(table.by_id[it->second], it->second);
+}
+
+Symbol SymbolTable::from_id(SymbolId id) {
+    auto& table = storage();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    if (id >= table.by_id.size()) {
+        return Symbol();
+    }
+    return Symbol(table.by_id[id], id);
+}
+
+size_t SymbolTable::size() {
+    auto& table = storage();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    return table.by_id.size();
+}
+
+} // namespace agentlog
@@ -0,0 +1,108 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "symbolizer.h"
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+#ifdef __GNUC__
+#include <execinfo.h>
+#include <cxxabi.h>
+#endif
+
+namespace agentlog {
+namespace detail {
+
+//=============================================================================
+// Symbolizer Implementation
+//=============================================================================
+
+Symbolizer& Symbolizer::instance() {
+    static Symbolizer symbolizer;
+    return symbolizer;
+}
+
+size_t Symbolizer::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return frames_.size();
+}
+
+// Parses backtrace_symbols() output: module(function+offset) [address]
+StackFrame Symbolizer::parse(const char* text) {
+    std::string symbol = text;
+    StackFrame frame;
+
+    size_t paren_start = symbol.find('(');
+    size_t paren_end = symbol.find('+');
+
+    if (paren_start != std::string::npos && paren_end != std::string::npos) {
+        frame.module = symbol.substr(0, paren_start);
+        std::string mangled = symbol.substr(paren_start + 1, paren_end - paren_start - 1);
+
+#ifdef __GNUC__
+        // Demangle C++ names
+        int status;
+        char* demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+        if (status == 0 && demangled) {
+            frame.function = demangled;
+            free(demangled);
+        } else {
+            frame.function = mangled;
+        }
+#else
+        frame.function = mangled;
+#endif
+    } else {
+        frame.function = symbol;
+    }
+    return frame;
+}
+
+void Symbolizer::resolve(const std::vector<uintptr_t>& addresses, StackTrace& out) {
+    size_t first = out.size();
+    out.resize(first + addresses.size());
+
+    std::vector<size_t> missing;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            auto it = frames_.find(addresses[i]);
+            if (it != frames_.end()) {
+                out[first + i] = it->second;
+            } else {
+                missing.push_back(i);
+            }
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+#ifdef __GNUC__
+    std::vector<void*> unresolved;
+    unresolved.reserve(missing.size());
+    for (size_t i : missing) {
+        unresolved.push_back(reinterpret_cast<void*>(addresses[i]));
+    }
+    char** symbols = backtrace_symbols(unresolved.data(), static_cast<int>(unresolved.size()));
+    if (!symbols) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (frames_.size() + missing.size() > kMaxEntries) {
+        frames_.clear();
+    }
+    for (size_t j = 0; j < missing.size(); ++j) {
+        StackFrame& frame = out[first + missing[j]];
+        frame = parse(symbols[j]);
+        frames_.emplace(addresses[missing[j]], frame);
+    }
+    lock.unlock();
+    free(symbols);
+#endif
+}
+
+} // namespace detail
+} // namespace agentlog
@@ -0,0 +1,48 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_SYMBOLIZER_H
+#define AGENTLOG_SYMBOLIZER_H
+
+#include "agentlog/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace agentlog {
+namespace detail {
+
+/**
+ * @brief Process-wide return address -> StackFrame cache
+ *
+ * Resolving an address means backtrace_symbols() plus demangling, tens of
+ * microseconds and several allocations. Call sites repeat, so each address
+ * is resolved once and later traces through it cost one hash lookup per
+ * frame under a shared lock. The misses of one trace are resolved with a
+ * single backtrace_symbols() call. Past 64K entries the cache starts over,
+ * which bounds it when code is loaded and unloaded.
+ */
+class Symbolizer {
+public:
+    static Symbolizer& instance();
+
+    // Appends one frame per address to out
+    void resolve(const std::vector<uintptr_t>& addresses, StackTrace& out);
+
+    size_t size() const;
+
+private:
+    static constexpr size_t kMaxEntries = 64 * 1024;
+
+    static StackFrame parse(const char* symbol);
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<uintptr_t, StackFrame> frames_;
+};
+
+} // namespace detail
+} // namespace agentlog
+
+#endif // AGENTLOG_SYMBOLIZER_H
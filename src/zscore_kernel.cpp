@@ -0,0 +1,194 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "zscore_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AGENTLOG_ZSCORE_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define AGENTLOG_ZSCORE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace agentlog {
+namespace detail {
+
+namespace {
+
+// Matches the scalar detector's "no variance" and "changed" tolerances
+constexpr double kEpsilon = 1e-6;
+
+// Beyond this the approximation drifts above 1; tanh(9) rounds to 1 anyway
+constexpr double kTanhClamp = 9.0;
+
+// tanh(x) ~ x (135135 + 17325 x^2 + 378 x^4 + x^6) /
+//             (135135 + 62370 x^2 + 3150 x^4 + 28 x^6), for x >= 0
+inline double tanh_approx(double x) {
+    x = std::min(x, kTanhClamp);
+    double x2 = x * x;
+    double num = x * (135135.0 + x2 * (17325.0 + x2 * (378.0 + x2)));
+    double den = 135135.0 + x2 * (62370.0 + x2 * (3150.0 + x2 * 28.0));
+    return std::min(num / den, 1.0);
+}
+
+void contributions_scalar(const double* values, const double* means,
+                          const double* m2s, const double* counts, size_t n,
+                          double min_count, double inv_threshold, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        if (counts[i] < min_count) {
+            out[i] = 0.0;
+            continue;
+        }
+        double stddev = std::sqrt(m2s[i] / (counts[i] - 1.0));
+        double diff = std::abs(values[i] - means[i]);
+        if (stddev < kEpsilon) {
+            out[i] = diff > kEpsilon ? 1.0 : 0.0;
+        } else {
+            out[i] = tanh_approx(diff / stddev * inv_threshold);
+        }
+    }
+}
+
+#if defined(AGENTLOG_ZSCORE_AVX2)
+
+__attribute__((target("avx2")))
+void contributions_avx2(const double* values, const double* means,
+                        const double* m2s, const double* counts, size_t n,
+                        double min_count, double inv_threshold, double* out) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d eps = _mm256_set1_pd(kEpsilon);
+    const __m256d clamp = _mm256_set1_pd(kTanhClamp);
+    const __m256d min_cnt = _mm256_set1_pd(min_count);
+    const __m256d inv_thr = _mm256_set1_pd(inv_threshold);
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(values + i);
+        __m256d mean = _mm256_loadu_pd(means + i);
+        __m256d m2 = _mm256_loadu_pd(m2s + i);
+        __m256d cnt = _mm256_loadu_pd(counts + i);
+
+        __m256d enough = _mm256_cmp_pd(cnt, min_cnt, _CMP_GE_OQ);
+        // count - 1 >= 1 wherever the result is kept; elsewhere avoid /0
+        __m256d denom = _mm256_max_pd(_mm256_sub_pd(cnt, one), one);
+        __m256d stddev = _mm256_sqrt_pd(_mm256_div_pd(m2, denom));
+        __m256d diff = _mm256_and_pd(_mm256_sub_pd(v, mean), abs_mask);
+
+        // Constant metric: 1 if it moved, else 0
+        __m256d flat = _mm256_cmp_pd(stddev, eps, _CMP_LT_OQ);
+        __m256d moved = _mm256_and_pd(_mm256_cmp_pd(diff, eps, _CMP_GT_OQ), one);
+
+        __m256d safe_std = _mm256_blendv_pd(stddev, one, flat);
+        __m256d x = _mm256_min_pd(_mm256_mul_pd(_mm256_div_pd(diff, safe_std), inv_thr), clamp);
+        __m256d x2 = _mm256_mul_pd(x, x);
+        __m256d num = _mm256_add_pd(_mm256_set1_pd(378.0), x2);
+        num = _mm256_add_pd(_mm256_set1_pd(17325.0), _mm256_mul_pd(x2, num));
+        num = _mm256_add_pd(_mm256_set1_pd(135135.0), _mm256_mul_pd(x2, num));
+        num = _mm256_mul_pd(x, num);
+        __m256d den = _mm256_add_pd(_mm256_set1_pd(3150.0), _mm256_mul_pd(x2, _mm256_set1_pd(28.0)));
+        den = _mm256_add_pd(_mm256_set1_pd(62370.0), _mm256_mul_pd(x2, den));
+        den = _mm256_add_pd(_mm256_set1_pd(135135.0), _mm256_mul_pd(x2, den));
+        __m256d t = _mm256_min_pd(_mm256_div_pd(num, den), one);
+
+        __m256d result = _mm256_blendv_pd(t, moved, flat);
+        result = _mm256_blendv_pd(zero, result, enough);
+        _mm256_storeu_pd(out + i, result);
+    }
+
+    contributions_scalar(values + i, means + i, m2s + i, counts + i, n - i,
+                         min_count, inv_threshold, out + i);
+}
+
+#elif defined(AGENTLOG_ZSCORE_NEON)
+
+void contributions_neon(const double* values, const double* means,
+                        const double* m2s, const double* counts, size_t n,
+                        double min_count, double inv_threshold, double* out) {
+    const float64x2_t one = vdupq_n_f64(1.0);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    const float64x2_t eps = vdupq_n_f64(kEpsilon);
+    const float64x2_t clamp = vdupq_n_f64(kTanhClamp);
+    const float64x2_t min_cnt = vdupq_n_f64(min_count);
+    const float64x2_t inv_thr = vdupq_n_f64(inv_threshold);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(values + i);
+        float64x2_t mean = vld1q_f64(means + i);
+        float64x2_t m2 = vld1q_f64(m2s + i);
+        float64x2_t cnt = vld1q_f64(counts + i);
+
+        uint64x2_t enough = vcgeq_f64(cnt, min_cnt);
+        float64x2_t denom = vmaxq_f64(vsubq_f64(cnt, one), one);
+        float64x2_t stddev = vsqrtq_f64(vdivq_f64(m2, denom));
+        float64x2_t diff = vabsq_f64(vsubq_f64(v, mean));
+
+        uint64x2_t flat = vcltq_f64(stddev, eps);
+        float64x2_t moved = vbslq_f64(vcgtq_f64(diff, eps), one, zero);
+
+        float64x2_t safe_std = vbslq_f64(flat, one, stddev);
+        float64x2_t x = vminq_f64(vmulq_f64(vdivq_f64(diff, safe_std), inv_thr), clamp);
+        float64x2_t x2 = vmulq_f64(x, x);
+        float64x2_t num = vaddq_f64(vdupq_n_f64(378.0), x2);
+        num = vaddq_f64(vdupq_n_f64(17325.0), vmulq_f64(x2, num));
+        num = vaddq_f64(vdupq_n_f64(135135.0), vmulq_f64(x2, num));
+        num = vmulq_f64(x, num);
+        float64x2_t den = vaddq_f64(vdupq_n_f64(3150.0), vmulq_f64(x2, vdupq_n_f64(28.0)));
+        den = vaddq_f64(vdupq_n_f64(62370.0), vmulq_f64(x2, den));
+        den = vaddq_f64(vdupq_n_f64(135135.0), vmulq_f64(x2, den));
+        float64x2_t t = vminq_f64(vdivq_f64(num, den), one);
+
+        float64x2_t result = vbslq_f64(flat, moved, t);
+        result = vbslq_f64(enough, result, zero);
+        vst1q_f64(out + i, result);
+    }
+
+    contributions_scalar(values + i, means + i, m2s + i, counts + i, n - i,
+                         min_count, inv_threshold, out + i);
+}
+
+#endif
+
+using Kernel = void (*)(const double*, const double*, const double*, const double*,
+                        size_t, double, double, double*);
+
+struct KernelChoice {
+    Kernel kernel;
+    const char* name;
+};
+
+KernelChoice choose_kernel() {
+#if defined(AGENTLOG_ZSCORE_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return {contributions_avx2, "avx2"};
+    }
+#elif defined(AGENTLOG_ZSCORE_NEON)
+    return {contributions_neon, "neon"};
+#endif
+    return {contributions_scalar, "scalar"};
+}
+
+const KernelChoice& kernel_choice() {
+    static const KernelChoice choice = choose_kernel();
+    return choice;
+}
+
+} // namespace
+
+void zscore_contributions(const double* values, const double* means,
+                          const double* m2s, const double* counts, size_t n,
+                          double min_count, double inv_threshold, double* out) {
+    kernel_choice().kernel(values, means, m2s, counts, n, min_count, inv_threshold, out);
+}
+
+const char* zscore_kernel_name() {
+    return kernel_choice().name;
+}
+
+} // namespace detail
+} // namespace agentlog
@@ -0,0 +1,42 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef AGENTLOG_ZSCORE_KERNEL_H
+#define AGENTLOG_ZSCORE_KERNEL_H
+
+#include <cstddef>
+
+namespace agentlog {
+namespace detail {
+
+/**
+ * @brief Normalized z-score contribution of each (value, stats) pair
+ *
+ * Inputs are structure-of-arrays gathers of one metric observation per
+ * element: the observed value and that metric's Welford mean, m2 and count.
+ * out[i] is
+ *   - 0 when count < min_count (not enough data yet),
+ *   - 1 or 0 when the metric has had no variance (changed or not),
+ *   - tanh(|value - mean| / (stddev * threshold)) otherwise.
+ *
+ * tanh is a [7/6] continued-fraction approximation (abs error < 1e-4) so
+ * the same arithmetic runs in every lane. The AVX2 path is chosen at run
+ * time on x86, NEON is used on AArch64, and a scalar loop everywhere else;
+ * they agree to within floating-point rounding.
+ */
+void zscore_contributions(const double* values,
+                          const double* means,
+                          const double* m2s,
+                          const double* counts,
+                          size_t n,
+                          double min_count,
+                          double inv_threshold,
+                          double* out);
+
+// Name of the kernel zscore_contributions() dispatches to
+const char* zscore_kernel_name();
+
+} // namespace detail
+} // namespace agentlog
+
+#endif // AGENTLOG_ZSCORE_KERNEL_H
@@ -0,0 +1,250 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file agentlog_bench.cpp
+ * @brief Google Benchmark microbenchmarks of the hot paths
+ *
+ * Covers LogEvent construction, to_json(), each AnomalyDetector,
+ * PatternEngine::match_patterns() and EventCorrelator::correlate() at
+ * several retained sizes. Every benchmark also reports the heap bytes and
+ * allocations per operation, so allocation regressions show up next to
+ * time regressions. Run with --benchmark_filter=<regex> to pick a subset.
+ */
+
+#include "allocation_counter.h"
+#include <agentlog/agentlog.h>
+#include <agentlog/correlation_engine.h>
+#include <agentlog/pattern_engine.h>
+#include <benchmark/benchmark.h>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace agentlog;
+
+namespace {
+
+// Reports heap traffic between construction and destruction as per-op counters
+class AllocationScope {
+public:
+    explicit AllocationScope(benchmark::State& state)
+        : state_(state), start_(allocation_counter::now()) {}
+
+    ~AllocationScope() {
+        auto end = allocation_counter::now();
+        double ops = static_cast<double>(std::max<benchmark::IterationCount>(state_.iterations(), 1));
+        state_.counters["bytes_per_op"] = static_cast<double>(end.bytes - start_.bytes - excluded_.bytes) / ops;
+        state_.counters["allocs_per_op"] = static_cast<double>(end.count - start_.count - excluded_.count) / ops;
+    }
+
+    // Leave out setup done inside the loop, alongside state.PauseTiming()
+    void pause() { paused_ = allocation_counter::now(); }
+    void resume() {
+        auto now = allocation_counter::now();
+        excluded_.bytes += now.bytes - paused_.bytes;
+        excluded_.count += now.count - paused_.count;
+    }
+
+private:
+    benchmark::State& state_;
+    allocation_counter::Snapshot start_;
+    allocation_counter::Snapshot paused_{0, 0};
+    allocation_counter::Snapshot excluded_{0, 0};
+};
+
+// A request event shaped like those in microservices_correlation.cpp
+LogEvent make_request(std::mt19937& rng, size_t users = 1000) {
+    std::uniform_int_distribution<size_t> user(0, users - 1);
+    std::normal_distribution<double> latency(120.0, 15.0);
+
+    LogEvent event("api.request.received");
+    event.severity(Severity::INFO)
+        .service_name("api-gateway")
+        .trace_id("trace-" + std::to_string(rng()))
+        .entity("user_id", "user-" + std::to_string(user(rng)))
+        .entity("endpoint", "/api/orders")
+        .metric("latency_ms", latency(rng))
+        .metric("response_size_bytes", 1024.0)
+        .context("method", "POST");
+    return event;
+}
+
+// Each call continues the sequence, so trace IDs are not reused
+std::vector<LogEvent> make_requests(size_t n, size_t users = 1000) {
+    static std::mt19937 rng(7);
+    std::vector<LogEvent> events;
+    events.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        events.push_back(make_request(rng, users));
+    }
+    return events;
+}
+
+std::vector<LogEventPtr> make_shared_requests(size_t n, size_t users) {
+    std::vector<LogEventPtr> events;
+    events.reserve(n);
+    for (auto& event : make_requests(n, users)) {
+        events.push_back(std::make_shared<const LogEvent>(std::move(event)));
+    }
+    return events;
+}
+
+// Events the builtin patterns react to, mixed with plain requests
+std::vector<LogEvent> make_pattern_events(size_t n) {
+    static const char* const kTypes[] = {
+        "api.request.received", "auth.failed", "api.retry", "database.slow",
+        "api.timeout", "user.error", "api.request.received", "app.log",
+    };
+    std::mt19937 rng(11);
+    std::vector<LogEvent> events;
+    events.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        LogEvent event(kTypes[i % std::size(kTypes)]);
+        event.entity("user_id", "user-" + std::to_string(rng() % 50))
+            .message(i % 16 == 0 ? "NullPointerException at Foo.bar(Foo.java:42)" : "request handled");
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+//=============================================================================
+// LogEvent
+//=============================================================================
+
+void BM_LogEventConstruction(benchmark::State& state) {
+    std::mt19937 rng(7);
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        LogEvent event = make_request(rng);
+        benchmark::DoNotOptimize(event);
+    }
+}
+BENCHMARK(BM_LogEventConstruction);
+
+void BM_ToJson(benchmark::State& state) {
+    auto events = make_requests(256);
+    std::string out;
+    size_t i = 0;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        out.clear();
+        events[i++ % events.size()].to_json(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * out.size()));
+}
+BENCHMARK(BM_ToJson);
+
+//=============================================================================
+// Anomaly detectors
+//=============================================================================
+
+void run_detector(benchmark::State& state, std::shared_ptr<AnomalyDetector> detector) {
+    auto events = make_requests(4096);
+    for (const auto& event : events) {
+        detector->train(event);  // Past warm-up, as in a long-running service
+    }
+
+    size_t i = 0;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(detector->score_and_train(events[i++ % events.size()]));
+    }
+}
+
+void BM_ZScoreDetector(benchmark::State& state) {
+    run_detector(state, DetectorFactory::create_z_score());
+}
+BENCHMARK(BM_ZScoreDetector);
+
+void BM_MovingAverageDetector(benchmark::State& state) {
+    run_detector(state, DetectorFactory::create_moving_average());
+}
+BENCHMARK(BM_MovingAverageDetector);
+
+void BM_MovingAverageDetectorStreaming(benchmark::State& state) {
+    run_detector(state, DetectorFactory::create_moving_average(
+        100, MovingAverageDetector::Dispersion::STREAMING_STDDEV));
+}
+BENCHMARK(BM_MovingAverageDetectorStreaming);
+
+void BM_RateDetector(benchmark::State& state) {
+    run_detector(state, DetectorFactory::create_rate());
+}
+BENCHMARK(BM_RateDetector);
+
+void BM_EnsembleDetector(benchmark::State& state) {
+    run_detector(state, DetectorFactory::create_default());
+}
+BENCHMARK(BM_EnsembleDetector);
+
+//=============================================================================
+// Pattern engine
+//=============================================================================
+
+// Builtin patterns against a history of state.range(0) events
+void BM_MatchPatterns(benchmark::State& state) {
+    PatternEngine engine;
+    engine.register_builtin_patterns();
+
+    EventHistory history;
+    for (auto& event : make_pattern_events(static_cast<size_t>(state.range(0)))) {
+        history.push_back(std::make_shared<const LogEvent>(std::move(event)));
+    }
+    auto events = make_pattern_events(1024);
+
+    size_t i = 0;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        auto matches = engine.match_patterns(events[i++ % events.size()], history);
+        benchmark::DoNotOptimize(matches.data());
+    }
+}
+BENCHMARK(BM_MatchPatterns)->Arg(100)->Arg(1000);
+
+//=============================================================================
+// Event correlator
+//=============================================================================
+
+// correlate() with state.range(0) events retained: the correlator is filled
+// to its cap first, so every call also evicts the oldest event. Events are
+// never fed twice; fresh ones are built, untimed, as the supply runs out.
+// They all carry about the same timestamp, so the temporal strategy sees
+// every retained event: the cost of a burst.
+void BM_Correlate(benchmark::State& state) {
+    constexpr size_t kSupply = 8192;
+    size_t retained = static_cast<size_t>(state.range(0));
+    EventCorrelator::Config config;
+    config.max_events = retained;
+    config.max_correlations = retained;
+    EventCorrelator correlator(config);
+
+    // Few users, so entity correlations are found
+    constexpr size_t kUsers = 500;
+    for (const auto& event : make_shared_requests(retained, kUsers)) {
+        correlator.correlate(event);
+    }
+    auto events = make_shared_requests(kSupply, kUsers);
+
+    size_t i = 0;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        if (i == events.size()) {
+            state.PauseTiming();
+            allocations.pause();
+            events = make_shared_requests(kSupply, kUsers);
+            i = 0;
+            allocations.resume();
+            state.ResumeTiming();
+        }
+        auto found = correlator.correlate(events[i++]);
+        benchmark::DoNotOptimize(found.data());
+    }
+}
+BENCHMARK(BM_Correlate)->Arg(1000)->Arg(4000)->Arg(16000);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,292 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/event.h"
+#include "binary_codec.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+using namespace agentlog;
+
+namespace {
+
+LogEvent full_event() {
+    LogEvent event("payment.failed");
+    event.severity(Severity::ERROR)
+        .message("card declined")
+        .entity("user_id", "user-42")
+        .entity("merchant", "m-7")
+        .metric("amount", 99.5)
+        .metric("latency_ms", 12.0)
+        .context("region", "eu-west-1")
+        .tag("billing")
+        .tag("retryable")
+        .service_name("payments")
+        .service_instance("payments-3")
+        .trace_id("trace-abc")
+        .span_id("span-1")
+        .anomaly_score(0.875)
+        .predicted_label("fraud")
+        .incident_id("INC-000001");
+    return event;
+}
+
+std::string encode(const LogEvent& event) {
+    std::string out;
+    event.encode_binary(out);
+    return out;
+}
+
+} // namespace
+
+TEST(EventCodec, RoundTripsEveryField) {
+    LogEvent original = full_event();
+    std::string record = encode(original);
+
+    size_t consumed = 0;
+    auto decoded = LogEvent::decode_binary(record, &consumed);
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(consumed, record.size());
+
+    EXPECT_EQ(decoded->event_id(), original.event_id());
+    EXPECT_EQ(decoded->timestamp(), original.timestamp());
+    EXPECT_EQ(decoded->event_type(), "payment.failed");
+    EXPECT_EQ(decoded->severity(), Severity::ERROR);
+    EXPECT_EQ(decoded->message(), "card declined");
+    EXPECT_EQ(decoded->entities(), original.entities());
+    EXPECT_EQ(decoded->metrics(), original.metrics());
+    EXPECT_EQ(decoded->context(), original.context());
+    EXPECT_EQ(decoded->tags(), original.tags());
+    EXPECT_EQ(decoded->service_name(), "payments");
+    EXPECT_EQ(decoded->trace_id(), "trace-abc");
+    EXPECT_EQ(decoded->span_id(), "span-1");
+    EXPECT_DOUBLE_EQ(decoded->anomaly_score(), 0.875);
+    ASSERT_TRUE(decoded->incident_id());
+    EXPECT_EQ(*decoded->incident_id(), "INC-000001");
+
+    // Re-encoding the decoded event reproduces the record byte for byte
+    EXPECT_EQ(encode(*decoded), record);
+}
+
+TEST(EventCodec, DecodesRecordsBackToBack) {
+    std::string stream;
+    for (int i = 0; i < 3; ++i) {
+        LogEvent event("seq.event");
+        event.metric("i", i);
+        event.encode_binary(stream);
+    }
+
+    std::string_view rest(stream);
+    for (int i = 0; i < 3; ++i) {
+        size_t consumed = 0;
+        auto event = LogEvent::decode_binary(rest, &consumed);
+        ASSERT_TRUE(event);
+        EXPECT_EQ(event->metrics().at("i"), i);
+        rest.remove_prefix(consumed);
+    }
+    EXPECT_TRUE(rest.empty());
+}
+
+TEST(EventCodec, RejectsEveryTruncation) {
+    std::string record = encode(full_event());
+    for (size_t size = 0; size < record.size(); ++size) {
+        EXPECT_FALSE(LogEvent::decode_binary(std::string_view(record.data(), size)))
+            << "prefix of " << size << " bytes decoded";
+    }
+}
+
+TEST(EventCodec, RejectsShortenedLengthPrefix) {
+    // The fields run past the declared length
+    std::string record = encode(full_event());
+    for (uint32_t length = 0; length + 4 < record.size(); ++length) {
+        std::string shortened = record;
+        for (int i = 0; i < 4; ++i) {
+            shortened[i] = static_cast<char>(length >> (8 * i));
+        }
+        EXPECT_FALSE(LogEvent::decode_binary(shortened)) << "length " << length;
+    }
+}
+
+TEST(EventCodec, RejectsBadVersionAndSeverity) {
+    std::string record = encode(full_event());
+
+    std::string bad_version = record;
+    bad_version[4] = 99;
+    EXPECT_FALSE(LogEvent::decode_binary(bad_version));
+
+    // Version, varint id, svarint time, then the severity byte
+    LogEvent event("x");
+    std::string plain = encode(event);
+    detail::BinaryReader in(std::string_view(plain).substr(5));
+    in.varint();
+    in.svarint();
+    size_t severity_at = plain.size() - static_cast<size_t>(in.end - in.p);
+    plain[severity_at] = 42;
+    EXPECT_FALSE(LogEvent::decode_binary(plain));
+}
+
+TEST(EventCodec, RejectsHugeLengthsAndCounts) {
+    // Length prefix far beyond the buffer
+    std::string huge_length = encode(full_event());
+    huge_length[3] = '\x7f';
+    EXPECT_FALSE(LogEvent::decode_binary(huge_length));
+
+    // A string whose varint length claims more bytes than remain
+    std::string body;
+    body += '\x01';
+    detail::put_varint(body, 1);
+    detail::put_time(body, timestamp_t{});
+    body += '\x02';
+    detail::put_double(body, 0.0);
+    detail::put_varint(body, 1ull << 40);
+    std::string record(4, '\0');
+    for (int i = 0; i < 4; ++i) {
+        record[i] = static_cast<char>(body.size() >> (8 * i));
+    }
+    record += body;
+    EXPECT_FALSE(LogEvent::decode_binary(record));
+
+    // A varint that never terminates
+    std::string endless(4, '\0');
+    endless[0] = 16;
+    endless += '\x01';
+    endless.append(15, '\xff');
+    EXPECT_FALSE(LogEvent::decode_binary(endless));
+}
+
+TEST(EventCodec, CountsAreBoundedByElementSize) {
+    std::string bytes;
+    detail::put_varint(bytes, 10);
+    bytes.append(20, '\0');
+    const auto* p = reinterpret_cast<const unsigned char*>(bytes.data());
+
+    detail::BinaryReader narrow{p, p + bytes.size()};
+    EXPECT_EQ(narrow.count(), 10u);
+    EXPECT_TRUE(narrow.ok);
+
+    // Ten elements of four bytes or more cannot fit in the twenty left
+    detail::BinaryReader wide{p, p + bytes.size()};
+    EXPECT_EQ(wide.count(4), 0u);
+    EXPECT_FALSE(wide.ok);
+}
+
+TEST(EventCodec, SurvivesCorruptedInput) {
+    // Whatever the bytes, decoding must either fail or produce a record
+    // that stays inside the buffer
+    std::string record = encode(full_event());
+    std::mt19937 rng(12345);
+    for (int round = 0; round < 20000; ++round) {
+        std::string mutated = record;
+        int flips = 1 + static_cast<int>(rng() % 4);
+        for (int i = 0; i < flips; ++i) {
+            mutated[rng() % mutated.size()] = static_cast<char>(rng());
+        }
+        size_t consumed = 0;
+        auto event = LogEvent::decode_binary(mutated, &consumed);
+        if (event) {
+            EXPECT_LE(consumed, mutated.size());
+        }
+    }
+
+    for (int round = 0; round < 5000; ++round) {
+        std::string noise(rng() % 256, '\0');
+        for (auto& c : noise) {
+            c = static_cast<char>(rng());
+        }
+        size_t consumed = 0;
+        if (LogEvent::decode_binary(noise, &consumed)) {
+            EXPECT_LE(consumed, noise.size());
+        }
+    }
+}
+
+TEST(EventCodec, FreshIdReplacesTheSendersId) {
+    LogEvent original = full_event();
+    std::string record = encode(original);
+
+    DecodeOptions options;
+    options.fresh_id = true;
+    auto first = LogEvent::decode_binary(record, nullptr, options);
+    auto second = LogEvent::decode_binary(record, nullptr, options);
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    EXPECT_NE(first->event_id(), original.event_id());
+    EXPECT_NE(first->event_id(), second->event_id());
+    EXPECT_EQ(first->timestamp(), original.timestamp());
+    EXPECT_EQ(first->entities(), original.entities());
+}
+
+TEST(EventCodec, SymbolLimitRefusesOnlyNewNames) {
+    // Names already interned decode even with the table at its cap
+    std::string known = encode(full_event());
+
+    // Constructing an event interns its type, so rename it in the record
+    std::string record = encode(LogEvent("codec.test.placeholder"));
+    size_t at = record.find("placeholder");
+    ASSERT_NE(at, std::string::npos);
+    record.replace(at, 11, "neverseenXY");
+
+    DecodeOptions options;
+    options.max_symbols = SymbolTable::size();
+    DecodeError error = DecodeError::MALFORMED;
+    EXPECT_TRUE(LogEvent::decode_binary(known, nullptr, options, &error));
+
+    size_t before = SymbolTable::size();
+    EXPECT_FALSE(LogEvent::decode_binary(record, nullptr, options, &error));
+    EXPECT_EQ(error, DecodeError::SYMBOL_LIMIT);
+    EXPECT_EQ(SymbolTable::size(), before);
+
+    error = DecodeError::SYMBOL_LIMIT;
+    EXPECT_FALSE(LogEvent::decode_binary(std::string_view(record).substr(0, 6), nullptr,
+                                         options, &error));
+    EXPECT_EQ(error, DecodeError::MALFORMED);
+}
+
+TEST(EventCodec, RejectedRecordsInternNothing) {
+    LogEvent event("codec.test.placeholder");
+    event.service_name("codec.test.placeholder")
+        .entity("codec.test.placeholder", "v")
+        .tag("tail");
+    std::string record = encode(event);
+    for (size_t at = record.find("placeholder"); at != std::string::npos;
+         at = record.find("placeholder", at)) {
+        record.replace(at, 11, "truncatedXY");
+    }
+
+    // Every field up to the last tag parses before the declared length ends
+    size_t before = SymbolTable::size();
+    for (uint32_t length = 0; length + 4 < record.size(); ++length) {
+        std::string shortened = record;
+        for (int i = 0; i < 4; ++i) {
+            shortened[i] = static_cast<char>(length >> (8 * i));
+        }
+        EXPECT_FALSE(LogEvent::decode_binary(shortened)) << "length " << length;
+    }
+    EXPECT_EQ(SymbolTable::size(), before);
+    EXPECT_TRUE(SymbolTable::find("codec.test.truncatedXY").empty());
+
+    auto decoded = LogEvent::decode_binary(record);
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(decoded->event_type(), "codec.test.truncatedXY");
+    EXPECT_EQ(decoded->service_name(), "codec.test.truncatedXY");
+    EXPECT_EQ(decoded->entities().size(), 1u);
+}
+
+TEST(EventCodec, SymbolLimitCoversMetricNames) {
+    // Metric names are plain strings until decoded
+    LogEvent event("payment.failed");
+    event.metric("codec_test_unseen_metric", 1.0);
+    std::string record = encode(event);
+
+    DecodeOptions options;
+    options.max_symbols = SymbolTable::size();
+    DecodeError error = DecodeError::MALFORMED;
+    EXPECT_FALSE(LogEvent::decode_binary(record, nullptr, options, &error));
+    EXPECT_EQ(error, DecodeError::SYMBOL_LIMIT);
+    EXPECT_TRUE(SymbolTable::find("codec_test_unseen_metric").empty());
+
+    options.max_symbols = SymbolTable::size() + 1;
+    EXPECT_TRUE(LogEvent::decode_binary(record, nullptr, options, &error));
+    EXPECT_FALSE(SymbolTable::find("codec_test_unseen_metric").empty());
+}
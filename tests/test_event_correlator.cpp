@@ -0,0 +1,76 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/correlation_engine.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace agentlog;
+
+namespace {
+
+CorrelationPtr of_type(const std::vector<CorrelationPtr>& found, const std::string& type) {
+    for (const auto& corr : found) {
+        if (corr->correlation_type == type) {
+            return corr;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(EventCorrelator, FutureTimestampDoesNotExpireTheRest) {
+    EventCorrelator correlator;
+    auto now = std::chrono::system_clock::now();
+
+    for (int i = 0; i < 50; ++i) {
+        LogEvent event("request");
+        event.trace_id("trace-1");
+        event.timestamp(now - std::chrono::seconds(50 - i));
+        correlator.correlate(event);
+    }
+
+    // A producer whose clock runs two hours ahead
+    LogEvent skewed("request");
+    skewed.timestamp(now + std::chrono::hours(2));
+    correlator.correlate(skewed);
+    EXPECT_EQ(correlator.event_count(), 51u);
+
+    LogEvent next("request");
+    next.trace_id("trace-1");
+    auto corr = of_type(correlator.correlate(next), "trace_id");
+    ASSERT_NE(corr, nullptr);
+    EXPECT_EQ(corr->event_ids.size(), 51u);
+}
+
+TEST(EventCorrelator, EventsPastMaxAgeStillExpire) {
+    EventCorrelator::Config config;
+    config.max_age = std::chrono::minutes(1);
+    EventCorrelator correlator(config);
+    auto now = std::chrono::system_clock::now();
+
+    LogEvent old("request");
+    old.timestamp(now - std::chrono::minutes(5));
+    correlator.correlate(old);
+
+    LogEvent fresh("request");
+    correlator.correlate(fresh);
+    EXPECT_EQ(correlator.event_count(), 1u);
+}
+
+TEST(EventCorrelator, EntitiesSharingAValueDoNotCorrelateAnEventWithItself) {
+    EventCorrelator correlator;
+
+    LogEvent call("rpc");
+    call.entity("caller", "svc-a").entity("callee", "svc-a");
+    EXPECT_EQ(of_type(correlator.correlate(call), "entity"), nullptr);
+
+    LogEvent next("rpc");
+    next.entity("caller", "svc-a");
+    auto corr = of_type(correlator.correlate(next), "entity");
+    ASSERT_NE(corr, nullptr);
+    EXPECT_EQ(corr->event_ids.to_vector(),
+              (std::vector<uint64_t>{call.event_id(), next.event_id()}));
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/correlation_engine.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace agentlog;
+
+namespace {
+
+CorrelationPtr of_type(const std::vector<CorrelationPtr>& found, const std::string& type) {
+    for (const auto& corr : found) {
+        if (corr->correlation_type == type) {
+            return corr;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(EventIdView, OwningViewCopiesIds) {
+    std::vector<uint64_t> ids{5, 3, 9};
+    EventIdView view(ids);
+    ids.clear();
+
+    EXPECT_EQ(view.size(), 3u);
+    EXPECT_EQ(view.front(), 5u);
+    EXPECT_EQ(view.to_vector(), (std::vector<uint64_t>{5, 3, 9}));
+    EXPECT_TRUE(view.contains(9));
+    EXPECT_FALSE(view.contains(4));
+
+    EventIdView empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.begin(), empty.end());
+}
+
+TEST(EventIdView, TraceViewsIterateAcrossChunks) {
+    // Membership lists grow in chunks of 4, 8, 16, ... ids; views over a
+    // long trace have to follow the chunk chain
+    EventCorrelator correlator;
+    std::vector<uint64_t> ids;
+    std::vector<CorrelationPtr> views;
+    for (int i = 0; i < 3000; ++i) {
+        LogEvent event("step");
+        event.trace_id("trace-long");
+        ids.push_back(event.event_id());
+        auto corr = of_type(correlator.correlate(event), "trace_id");
+        if (i == 0) {
+            EXPECT_EQ(corr, nullptr);
+        } else {
+            ASSERT_NE(corr, nullptr);
+            views.push_back(corr);
+        }
+    }
+
+    // Every view is the prefix up to its event, even after later appends
+    for (size_t v : {size_t(0), size_t(2), size_t(3), size_t(10), size_t(1022), views.size() - 1}) {
+        std::vector<uint64_t> expected(ids.begin(), ids.begin() + v + 2);
+        EXPECT_EQ(views[v]->event_ids.size(), expected.size());
+        EXPECT_EQ(views[v]->event_ids.to_vector(), expected) << "view " << v;
+    }
+}
+
+TEST(EventIdView, ViewsOutliveEvictedIds) {
+    EventCorrelator::Config config;
+    config.max_events = 50;
+    EventCorrelator correlator(config);
+
+    std::vector<uint64_t> ids;
+    CorrelationPtr early;
+    for (int i = 0; i < 500; ++i) {
+        LogEvent event("step");
+        event.trace_id("trace-evicting");
+        ids.push_back(event.event_id());
+        auto corr = of_type(correlator.correlate(event), "trace_id");
+        if (i == 20) {
+            early = corr;
+        }
+    }
+    EXPECT_EQ(correlator.event_count(), 50u);
+
+    ASSERT_NE(early, nullptr);
+    EXPECT_EQ(early->event_ids.to_vector(),
+              std::vector<uint64_t>(ids.begin(), ids.begin() + 21));
+}
+
+TEST(EventIdView, EntityViewSpansSeveralLists) {
+    EventCorrelator correlator;
+
+    LogEvent a("a");
+    a.entity("user_id", "u-1");
+    LogEvent b("b");
+    b.entity("order_id", "o-9");
+    LogEvent both("c");
+    both.entity("user_id", "u-1").entity("order_id", "o-9");
+
+    correlator.correlate(a);
+    correlator.correlate(b);
+    auto corr = of_type(correlator.correlate(both), "entity");
+    ASSERT_NE(corr, nullptr);
+
+    // The new event is in both lists but is listed once
+    auto view = corr->event_ids.to_vector();
+    EXPECT_EQ(view.size(), 3u);
+    EXPECT_TRUE(corr->event_ids.contains(a.event_id()));
+    EXPECT_TRUE(corr->event_ids.contains(b.event_id()));
+    EXPECT_EQ(std::count(view.begin(), view.end(), both.event_id()), 1);
+}
+
+TEST(EventIdView, ServiceViewsShareTimeBuckets) {
+    EventCorrelator correlator;
+    auto start = std::chrono::system_clock::now();
+
+    std::vector<uint64_t> ids;
+    std::vector<CorrelationPtr> views;
+    for (int i = 0; i < 2000; ++i) {
+        LogEvent event("request");
+        event.service_name("checkout");
+        event.timestamp(start + std::chrono::milliseconds(i));
+        ids.push_back(event.event_id());
+        auto corr = of_type(correlator.correlate(event), "service");
+        if (i > 0) {
+            ASSERT_NE(corr, nullptr);
+            views.push_back(corr);
+        }
+    }
+
+    // Each view covers the service's events up to and including its own
+    for (size_t v : {size_t(0), size_t(500), size_t(1000), views.size() - 1}) {
+        std::vector<uint64_t> expected(ids.begin(), ids.begin() + v + 2);
+        EXPECT_EQ(views[v]->event_ids.to_vector(), expected) << "view " << v;
+    }
+}
+
+TEST(EventIdView, TemporalViewsSkipDistantBuckets) {
+    EventCorrelator correlator;
+    auto start = std::chrono::system_clock::now();
+
+    std::vector<uint64_t> near;
+    for (int i = 0; i < 3; ++i) {
+        LogEvent event("tick");
+        event.timestamp(start + std::chrono::milliseconds(i));
+        near.push_back(event.event_id());
+        correlator.correlate(event);
+    }
+    LogEvent far("tick");
+    far.timestamp(start + std::chrono::seconds(30));
+    EXPECT_EQ(of_type(correlator.correlate(far), "temporal"), nullptr);
+
+    LogEvent close("tick");
+    close.timestamp(start + std::chrono::milliseconds(3));
+    near.push_back(close.event_id());
+    auto corr = of_type(correlator.correlate(close), "temporal");
+    ASSERT_NE(corr, nullptr);
+    EXPECT_EQ(corr->event_ids.to_vector(), near);
+}
+
+TEST(EventIdView, ListsShedIdsEvictedBehindALongLivedHead) {
+    EventCorrelator::Config config;
+    config.max_events = 50;
+    EventCorrelator correlator(config);
+    auto now = std::chrono::system_clock::now();
+
+    // Stamped ahead of the rest, the head is evicted last and so stays at
+    // the front of the trace's list while everything behind it expires
+    LogEvent head("step");
+    head.trace_id("trace-pinned");
+    head.timestamp(now + std::chrono::minutes(30));
+    correlator.correlate(head);
+
+    CorrelationPtr last;
+    for (int i = 0; i < 1000; ++i) {
+        LogEvent event("step");
+        event.trace_id("trace-pinned");
+        event.timestamp(now + std::chrono::milliseconds(i));
+        last = of_type(correlator.correlate(event), "trace_id");
+    }
+    EXPECT_EQ(correlator.event_count(), 50u);
+
+    // Dead ids may linger, but never more than the live ones
+    ASSERT_NE(last, nullptr);
+    EXPECT_LE(last->event_ids.size(), 2 * correlator.event_count() + 1);
+    EXPECT_EQ(last->event_ids.front(), head.event_id());
+}
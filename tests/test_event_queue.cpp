@@ -0,0 +1,353 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "event_queue.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace agentlog;
+using detail::MpmcRingBuffer;
+
+namespace {
+
+LogEvent numbered(int n) {
+    LogEvent event("test.event");
+    event.metric("n", n);
+    return event;
+}
+
+int number_of(const LogEvent& event) {
+    return static_cast<int>(event.metrics().at("n"));
+}
+
+} // namespace
+
+//=============================================================================
+// MpmcRingBuffer
+//=============================================================================
+
+TEST(MpmcRingBuffer, RoundsCapacityUpToPowerOfTwo) {
+    EXPECT_EQ(MpmcRingBuffer<int>(0).capacity(), 2u);
+    EXPECT_EQ(MpmcRingBuffer<int>(5).capacity(), 8u);
+    EXPECT_EQ(MpmcRingBuffer<int>(64).capacity(), 64u);
+}
+
+TEST(MpmcRingBuffer, FifoUntilFullThenEmpty) {
+    MpmcRingBuffer<int> ring(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_push(int(i)));
+    }
+    int rejected = 99;
+    EXPECT_FALSE(ring.try_push(std::move(rejected)));
+    EXPECT_EQ(ring.size(), 4u);
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(ring.try_pop(value));
+    EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(MpmcRingBuffer, WrapsAroundManyLaps) {
+    MpmcRingBuffer<int> ring(4);
+    int value = -1;
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(ring.try_push(int(i)));
+        ASSERT_TRUE(ring.try_push(int(i + 1000000)));
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(value, i);
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(value, i + 1000000);
+    }
+}
+
+TEST(MpmcRingBuffer, DestroysQueuedElements) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        MpmcRingBuffer<std::shared_ptr<int>> ring(8);
+        for (int i = 0; i < 5; ++i) {
+            ring.try_push(std::shared_ptr<int>(tracker));
+        }
+        std::shared_ptr<int> popped;
+        ring.try_pop(popped);
+        popped.reset();
+        EXPECT_EQ(tracker.use_count(), 5);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(MpmcRingBuffer, ConcurrentProducersAndConsumersLoseNothing) {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kPerProducer = 50000;
+
+    MpmcRingBuffer<int> ring(1024);
+    std::atomic<int> consumed{0};
+    std::vector<std::vector<int>> seen(kConsumers);
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&, c] {
+            int value;
+            while (consumed.load(std::memory_order_relaxed) < kProducers * kPerProducer) {
+                if (ring.try_pop(value)) {
+                    seen[c].push_back(value);
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                int value = p * kPerProducer + i;
+                while (!ring.try_push(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Each consumer sees every producer's values in push order
+    std::vector<int> all;
+    for (const auto& values : seen) {
+        std::vector<int> last(kProducers, -1);
+        for (int value : values) {
+            int producer = value / kPerProducer;
+            EXPECT_GT(value, last[producer]);
+            last[producer] = value;
+        }
+        all.insert(all.end(), values.begin(), values.end());
+    }
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), size_t(kProducers * kPerProducer));
+    for (size_t i = 0; i < all.size(); ++i) {
+        ASSERT_EQ(all[i], static_cast<int>(i));
+    }
+}
+
+//=============================================================================
+// EventQueue
+//=============================================================================
+
+TEST(EventQueue, PushFailsWhenFullAndLeavesEventIntact) {
+    EventQueue queue(2);
+    EXPECT_TRUE(queue.push(numbered(0)));
+    EXPECT_TRUE(queue.push(numbered(1)));
+
+    LogEvent extra = numbered(2);
+    EXPECT_FALSE(queue.push(std::move(extra)));
+    EXPECT_EQ(number_of(extra), 2);
+    EXPECT_EQ(queue.size(), 2u);
+
+    LogEvent out;
+    ASSERT_TRUE(queue.pop(out));
+    EXPECT_EQ(number_of(out), 0);
+}
+
+TEST(EventQueue, PushEvictingDropsOldest) {
+    EventQueue queue(4);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.push(numbered(i)));
+    }
+    EXPECT_EQ(queue.push_evicting(numbered(4)), 1u);
+    EXPECT_EQ(queue.push_evicting(numbered(5)), 1u);
+
+    std::vector<LogEvent> batch;
+    EXPECT_EQ(queue.pop_batch(batch, 16, std::chrono::microseconds(0)), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(number_of(batch[i]), i + 2);
+    }
+}
+
+TEST(EventQueue, PushWaitTimesOutWhenFull) {
+    EventQueue queue(2);
+    queue.push(numbered(0));
+    queue.push(numbered(1));
+
+    LogEvent extra = numbered(2);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.push_wait(std::move(extra), std::chrono::milliseconds(20)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(number_of(extra), 2);
+}
+
+TEST(EventQueue, PushWaitSucceedsOnceConsumerMakesRoom) {
+    EventQueue queue(2);
+    queue.push(numbered(0));
+    queue.push(numbered(1));
+
+    std::thread consumer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        LogEvent out;
+        queue.pop(out);
+    });
+    EXPECT_TRUE(queue.push_wait(numbered(2), std::chrono::seconds(5)));
+    consumer.join();
+    EXPECT_EQ(queue.size(), 2u);
+}
+
+TEST(EventQueue, PopBatchHonorsMaxEvents) {
+    EventQueue queue(16);
+    for (int i = 0; i < 10; ++i) {
+        queue.push(numbered(i));
+    }
+    std::vector<LogEvent> batch;
+    EXPECT_EQ(queue.pop_batch(batch, 4, std::chrono::microseconds(0)), 4u);
+    EXPECT_EQ(queue.pop_batch(batch, 100, std::chrono::microseconds(0)), 6u);
+    ASSERT_EQ(batch.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(number_of(batch[i]), i);
+    }
+    EXPECT_EQ(queue.pop_batch(batch, 0, std::chrono::microseconds(0)), 0u);
+}
+
+TEST(EventQueue, PopBatchLingersWithoutSpinning) {
+    EventQueue queue(16);
+    queue.push(numbered(0));
+
+    std::vector<LogEvent> batch;
+    auto start = std::chrono::steady_clock::now();
+    std::clock_t cpu_start = std::clock();
+    EXPECT_EQ(queue.pop_batch(batch, 16, std::chrono::milliseconds(100)), 1u);
+    double cpu_seconds = double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_LT(cpu_seconds, 0.05);
+}
+
+TEST(EventQueue, PopBatchLingerPicksUpStragglers) {
+    EventQueue queue(16);
+    queue.push(numbered(0));
+
+    std::thread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.push(numbered(1));
+    });
+    std::vector<LogEvent> batch;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(queue.pop_batch(batch, 2, std::chrono::seconds(5)), 2u);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    producer.join();
+    EXPECT_EQ(number_of(batch[1]), 1);
+}
+
+TEST(EventQueue, PopBatchReportsPushTimes) {
+    EventQueue queue(16);
+
+    // An event stamped long ago has still only waited since its push
+    LogEvent stale = numbered(0);
+    stale.timestamp(std::chrono::system_clock::now() - std::chrono::hours(1));
+    auto before = std::chrono::steady_clock::now();
+    queue.push(std::move(stale));
+    queue.push(numbered(1));
+    auto after = std::chrono::steady_clock::now();
+
+    std::vector<LogEvent> batch;
+    std::vector<std::chrono::steady_clock::time_point> enqueued_at;
+    ASSERT_EQ(queue.pop_batch(batch, 16, std::chrono::microseconds(0), &enqueued_at), 2u);
+    ASSERT_EQ(enqueued_at.size(), 2u);
+    for (auto pushed : enqueued_at) {
+        EXPECT_GE(pushed, before);
+        EXPECT_LE(pushed, after);
+    }
+    EXPECT_LE(enqueued_at[0], enqueued_at[1]);
+}
+
+TEST(EventQueue, ShutdownDrainsThenWakesSleepingWorker) {
+    EventQueue queue(8);
+    queue.push(numbered(7));
+
+    std::atomic<int> popped{0};
+    std::atomic<bool> finished{false};
+    std::thread worker([&] {
+        LogEvent out;
+        while (queue.pop(out)) {
+            popped++;
+        }
+        finished = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(popped.load(), 1);
+    EXPECT_FALSE(finished.load());
+
+    queue.shutdown();
+    worker.join();
+    EXPECT_TRUE(finished.load());
+    EXPECT_EQ(popped.load(), 1);
+}
+
+TEST(EventQueue, ShutdownReleasesBlockedProducer) {
+    EventQueue queue(2);
+    queue.push(numbered(0));
+    queue.push(numbered(1));
+
+    std::thread producer([&] {
+        EXPECT_FALSE(queue.push_wait(numbered(2), std::chrono::seconds(30)));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto start = std::chrono::steady_clock::now();
+    queue.shutdown();
+    producer.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(EventQueue, ConcurrentProducersAndBatchingWorkers) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 20000;
+
+    EventQueue queue(256);
+    std::atomic<int> total{0};
+    std::vector<std::thread> workers;
+    std::vector<std::vector<int>> seen(2);
+    for (int w = 0; w < 2; ++w) {
+        workers.emplace_back([&, w] {
+            std::vector<LogEvent> batch;
+            while (queue.pop_batch(batch, 64, std::chrono::microseconds(50)) > 0) {
+                for (const auto& event : batch) {
+                    seen[w].push_back(number_of(event));
+                }
+                total += static_cast<int>(batch.size());
+                batch.clear();
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ASSERT_TRUE(queue.push_wait(numbered(p * kPerProducer + i), std::chrono::seconds(10)));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.shutdown();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    EXPECT_EQ(total.load(), kProducers * kPerProducer);
+    std::vector<int> all = seen[0];
+    all.insert(all.end(), seen[1].begin(), seen[1].end());
+    std::sort(all.begin(), all.end());
+    for (size_t i = 0; i < all.size(); ++i) {
+        ASSERT_EQ(all[i], static_cast<int>(i));
+    }
+}
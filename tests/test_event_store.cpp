@@ -0,0 +1,291 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/event.h"
+#include "agentlog/storage.h"
+#include "binary_codec.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace agentlog;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class EventStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        dir_ = fs::temp_directory_path() /
+               ("agentlog_store_" + std::to_string(::getpid()) + "_" + info->name());
+        fs::remove_all(dir_);
+    }
+
+    void TearDown() override { fs::remove_all(dir_); }
+
+    EventStore::Config config(uint64_t segment_bytes = 4096, uint64_t max_total_bytes = 0) const {
+        EventStore::Config c;
+        c.path = dir_.string();
+        c.segment_bytes = segment_bytes;
+        c.max_total_bytes = max_total_bytes;
+        c.index_interval = 4;
+        return c;
+    }
+
+    static LogEvent numbered(int n, const std::string& type = "store.event") {
+        LogEvent event(type);
+        event.metric("n", n).trace_id("trace-" + std::to_string(n % 3));
+        return event;
+    }
+
+    static int number_of(const LogEvent& event) {
+        return static_cast<int>(event.metrics().at("n"));
+    }
+
+    size_t segment_files() const {
+        size_t count = 0;
+        for (const auto& entry : fs::directory_iterator(dir_)) {
+            count += entry.path().extension() == ".events";
+        }
+        return count;
+    }
+
+    fs::path dir_;
+};
+
+} // namespace
+
+TEST_F(EventStoreTest, ScanFiltersByTypeTraceAndTime) {
+    EventStore store(config());
+    ASSERT_TRUE(store.is_open());
+
+    auto base = std::chrono::system_clock::now();
+    for (int i = 0; i < 60; ++i) {
+        store.append(numbered(i, i % 2 ? "odd" : "even"));
+    }
+
+    EventQuery by_type;
+    by_type.event_type = "odd";
+    auto odd = store.scan(by_type);
+    ASSERT_EQ(odd.size(), 30u);
+    for (const auto& event : odd) {
+        EXPECT_EQ(number_of(event) % 2, 1);
+    }
+
+    EventQuery by_trace;
+    by_trace.trace_id = "trace-1";
+    by_trace.limit = 5;
+    auto traced = store.scan(by_trace);
+    ASSERT_EQ(traced.size(), 5u);
+    for (const auto& event : traced) {
+        EXPECT_EQ(event.trace_id(), "trace-1");
+    }
+
+    EventQuery before;
+    before.to = base;
+    EXPECT_TRUE(store.scan(before).empty());
+    EventQuery after;
+    after.from = base;
+    EXPECT_EQ(store.scan(after).size(), 60u);
+}
+
+TEST_F(EventStoreTest, GetFindsEventsInEverySegment) {
+    EventStore store(config());
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 200; ++i) {
+        LogEvent event = numbered(i);
+        ids.push_back(event.event_id());
+        ASSERT_TRUE(store.append(event));
+    }
+    ASSERT_GT(store.get_stats().segments, 1u);
+
+    for (size_t i = 0; i < ids.size(); i += 17) {
+        auto event = store.get(ids[i]);
+        ASSERT_TRUE(event);
+        EXPECT_EQ(number_of(*event), static_cast<int>(i));
+    }
+    EXPECT_FALSE(store.get(ids.back() + 1000));
+}
+
+TEST_F(EventStoreTest, ReadFromFollowsAppendOrderAcrossSegments) {
+    EventStore store(config());
+    EventStore::Cursor cursor;
+    std::vector<int> read;
+    auto visit = [&](LogEvent&& event) { read.push_back(number_of(event)); };
+
+    for (int i = 0; i < 100; ++i) {
+        store.append(numbered(i));
+    }
+    EXPECT_EQ(store.read_from(cursor, 30, visit), 30u);
+    for (int i = 100; i < 250; ++i) {
+        store.append(numbered(i));
+    }
+    while (store.read_from(cursor, 7, visit) > 0) {}
+    EXPECT_EQ(store.read_from(cursor, 100, visit), 0u);
+
+    ASSERT_EQ(read.size(), 250u);
+    for (int i = 0; i < 250; ++i) {
+        EXPECT_EQ(read[i], i);
+    }
+
+    // The cursor stays on the active segment and picks up later appends
+    store.append(numbered(250));
+    EXPECT_EQ(store.read_from(cursor, 100, visit), 1u);
+    EXPECT_EQ(read.back(), 250);
+}
+
+TEST_F(EventStoreTest, RetentionDropsOldestSegments) {
+    EventStore store(config(4096, 3 * 4096));
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(store.append(numbered(i)));
+    }
+
+    auto stats = store.get_stats();
+    EXPECT_GT(stats.segments_dropped, 0u);
+    EXPECT_LE(stats.bytes, 3u * 4096);
+    EXPECT_EQ(segment_files(), stats.segments);
+
+    // What is left is the newest tail, still in order
+    auto events = store.scan(EventQuery{});
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(number_of(events.back()), 999);
+    for (size_t i = 1; i < events.size(); ++i) {
+        EXPECT_EQ(number_of(events[i]), number_of(events[i - 1]) + 1);
+    }
+}
+
+TEST_F(EventStoreTest, RejectsEventLargerThanSegment) {
+    EventStore store(config(1024));
+    LogEvent event("big");
+    event.message(std::string(2048, 'x'));
+    EXPECT_FALSE(store.append(event));
+    EXPECT_TRUE(store.append(numbered(1)));
+}
+
+TEST_F(EventStoreTest, ReopenRecoversEventsAndIgnoresTornTail) {
+    {
+        EventStore store(config());
+        for (int i = 0; i < 120; ++i) {
+            store.append(numbered(i));
+        }
+    }
+
+    // A crash mid-write leaves a partial record after the last complete one
+    fs::path newest;
+    for (const auto& entry : fs::directory_iterator(dir_)) {
+        if (newest.empty() || entry.path() > newest) {
+            newest = entry.path();
+        }
+    }
+    {
+        // A length prefix promising more bytes than follow it
+        const char torn[] = {0x30, 0, 0, 0, 1, 'g', 'a', 'r', 'b'};
+        std::ofstream tail(newest, std::ios::binary | std::ios::app);
+        tail.write(torn, sizeof(torn));
+    }
+
+    EventStore reopened(config());
+    ASSERT_TRUE(reopened.is_open());
+    auto events = reopened.scan(EventQuery{});
+    ASSERT_EQ(events.size(), 120u);
+    for (int i = 0; i < 120; ++i) {
+        EXPECT_EQ(number_of(events[i]), i);
+    }
+
+    // New appends land in a fresh segment after the recovered ones
+    reopened.append(numbered(120));
+    EXPECT_EQ(reopened.get_stats().events, 121u);
+}
+
+TEST_F(EventStoreTest, ReopenMovesNewIdsPastRecoveredOnes) {
+    // Stand in for an event from an earlier run that got further in its ids
+    uint64_t stored_id = LogEvent("store.event").event_id() + (1ull << 40);
+    std::string record;
+    numbered(0).encode_binary(record);
+    detail::BinaryReader in(std::string_view(record).substr(5));
+    in.varint();
+    std::string body(1, record[4]);
+    detail::put_varint(body, stored_id);
+    body.append(reinterpret_cast<const char*>(in.p), static_cast<size_t>(in.end - in.p));
+    std::string patched(4, '\0');
+    for (int i = 0; i < 4; ++i) {
+        patched[i] = static_cast<char>(body.size() >> (8 * i));
+    }
+    patched += body;
+    auto earlier = LogEvent::decode_binary(patched);
+    ASSERT_TRUE(earlier);
+    ASSERT_EQ(earlier->event_id(), stored_id);
+
+    {
+        EventStore store(config());
+        ASSERT_TRUE(store.append(*earlier));
+    }
+
+    EventStore reopened(config());
+    ASSERT_TRUE(reopened.is_open());
+    LogEvent fresh("store.event");
+    EXPECT_GT(fresh.event_id(), stored_id);
+    ASSERT_TRUE(reopened.get(stored_id));
+    EXPECT_EQ(number_of(*reopened.get(stored_id)), 0);
+}
+
+TEST_F(EventStoreTest, ReleaseDeletesSegmentsTheReaderFinished) {
+    EventStore store(config());
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_TRUE(store.append(numbered(i)));
+    }
+    size_t files = segment_files();
+    ASSERT_GT(files, 3u);
+
+    EventStore::Cursor cursor;
+    EXPECT_EQ(store.read_from(cursor, 100, [](LogEvent&&) {}), 100u);
+    size_t released = store.release(cursor);
+    EXPECT_GT(released, 0u);
+    EXPECT_EQ(segment_files(), files - released);
+    EXPECT_EQ(store.get_stats().segments_dropped, 0u);
+
+    // The unread rest is still there, in order
+    std::vector<int> rest;
+    store.read_from(cursor, 1000, [&](LogEvent&& event) { rest.push_back(number_of(event)); });
+    ASSERT_EQ(rest.size(), 100u);
+    EXPECT_EQ(rest.front(), 100);
+    EXPECT_EQ(rest.back(), 199);
+
+    // The active segment is never released
+    store.release(cursor);
+    EXPECT_EQ(segment_files(), 1u);
+}
+
+TEST_F(EventStoreTest, RejectWhenFullKeepsUnreadEvents) {
+    auto c = config(4096, 3 * 4096);
+    c.reject_when_full = true;
+    EventStore store(c);
+
+    int appended = 0;
+    while (store.append(numbered(appended))) {
+        ++appended;
+        ASSERT_LT(appended, 10000);
+    }
+    EXPECT_TRUE(store.is_open());
+    EXPECT_EQ(store.get_stats().segments_dropped, 0u);
+
+    // Nothing accepted was lost to retention
+    EventStore::Cursor cursor;
+    std::vector<int> read;
+    store.read_from(cursor, 10, [&](LogEvent&& event) { read.push_back(number_of(event)); });
+    EXPECT_EQ(read.front(), 0);
+
+    // Releasing what was read makes room again
+    store.read_from(cursor, 10000, [&](LogEvent&& event) { read.push_back(number_of(event)); });
+    EXPECT_EQ(read.size(), static_cast<size_t>(appended));
+    EXPECT_GT(store.release(cursor), 0u);
+    EXPECT_TRUE(store.append(numbered(appended)));
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "agentlog/flat_map.h"
+#include "agentlog/symbol_table.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace agentlog;
+
+TEST(FlatMap, IteratesInKeyOrder) {
+    FlatMap<std::string, int> map{{"c", 3}, {"a", 1}, {"b", 2}};
+    std::string keys;
+    for (const auto& [key, value] : map) {
+        keys += key;
+    }
+    EXPECT_EQ(keys, "abc");
+    EXPECT_EQ(map.size(), 3u);
+}
+
+TEST(FlatMap, InsertOrAssignOverwritesTryEmplaceDoesNot) {
+    FlatMap<std::string, int> map;
+    EXPECT_TRUE(map.insert_or_assign("k", 1).second);
+    EXPECT_FALSE(map.insert_or_assign("k", 2).second);
+    EXPECT_EQ(map.at("k"), 2);
+
+    auto [it, inserted] = map.try_emplace("k", 3);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(it->second, 2);
+
+    map["other"] += 5;
+    EXPECT_EQ(map.at("other"), 5);
+}
+
+TEST(FlatMap, HeterogeneousLookup) {
+    FlatMap<std::string, int> map{{"alpha", 1}, {"beta", 2}};
+    EXPECT_NE(map.find(std::string_view("alpha")), map.end());
+    EXPECT_NE(map.find("beta"), map.end());
+    EXPECT_EQ(map.find("gamma"), map.end());
+    EXPECT_EQ(map.count("beta"), 1u);
+    EXPECT_EQ(map.count(std::string("gamma")), 0u);
+    EXPECT_THROW(map.at("gamma"), std::out_of_range);
+}
+
+TEST(FlatMap, SymbolKeysAcceptStringLookups) {
+    FlatMap<Symbol, std::string> map;
+    map.insert_or_assign(Symbol("user_id"), "u1");
+    map.insert_or_assign(Symbol("endpoint"), "/pay");
+    EXPECT_EQ(map.at("user_id"), "u1");
+    EXPECT_EQ(map.begin()->first, "endpoint");
+}
+
+TEST(FlatMap, EraseAndEquality) {
+    FlatMap<std::string, int> a{{"x", 1}, {"y", 2}};
+    FlatMap<std::string, int> b{{"y", 2}, {"x", 1}};
+    EXPECT_EQ(a, b);
+
+    EXPECT_EQ(a.erase("x"), 1u);
+    EXPECT_EQ(a.erase("x"), 0u);
+    EXPECT_NE(a, b);
+
+    b.erase(b.find("x"));
+    EXPECT_EQ(a, b);
+
+    a.clear();
+    EXPECT_TRUE(a.empty());
+}
+
+TEST(FlatMap, MatchesStdMapAcrossSearchStrategies) {
+    // Small maps are scanned linearly and larger ones binary-searched;
+    // both must agree with std::map
+    std::mt19937 rng(7);
+    for (int size_limit : {4, 8, 9, 64}) {
+        FlatMap<std::string, int> flat;
+        std::map<std::string, int> reference;
+        for (int step = 0; step < 2000; ++step) {
+            std::string key = "k" + std::to_string(rng() % size_limit);
+            switch (rng() % 3) {
+                case 0:
+                    flat.insert_or_assign(key, step);
+                    reference.insert_or_assign(key, step);
+                    break;
+                case 1:
+                    EXPECT_EQ(flat.erase(key), reference.erase(key));
+                    break;
+                default:
+                    EXPECT_EQ(flat.count(key), reference.count(key));
+                    break;
+            }
+        }
+        ASSERT_EQ(flat.size(), reference.size());
+        auto it = reference.begin();
+        for (const auto& [key, value] : flat) {
+            EXPECT_EQ(key, it->first);
+            EXPECT_EQ(value, it->second);
+            ++it;
+        }
+    }
+}
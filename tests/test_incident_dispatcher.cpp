@@ -0,0 +1,153 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "incident_dispatcher.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace agentlog;
+
+namespace {
+
+// Records every call; the first create can be held open and made to fail
+class FakeIntegration : public IncidentIntegration {
+public:
+    std::string create_incident(const Incident& incident) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        creates.push_back(incident.title);
+        if (hold_first_create && creates.size() == 1) {
+            first_create_started = true;
+            cv_.notify_all();
+            cv_.wait(lock, [this] { return released; });
+            throw std::runtime_error("unavailable");
+        }
+        return "FAKE-" + incident.incident_id;
+    }
+
+    void update_incident(const std::string& external_id, const Incident& incident) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        updates.push_back(external_id + ":" + incident.title);
+    }
+
+    void resolve_incident(const std::string& external_id, const std::string& resolution) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        resolves.push_back(external_id + ":" + resolution);
+    }
+
+    std::string name() const override { return "fake"; }
+
+    void wait_for_first_create() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return first_create_started; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released = true;
+        cv_.notify_all();
+    }
+
+    bool hold_first_create{false};
+    std::vector<std::string> creates;
+    std::vector<std::string> updates;
+    std::vector<std::string> resolves;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool first_create_started{false};
+    bool released{false};
+};
+
+Incident incident(const std::string& id, const std::string& title) {
+    Incident result;
+    result.incident_id = id;
+    result.title = title;
+    result.severity = IncidentSeverity::HIGH;
+    result.status = IncidentStatus::OPEN;
+    result.created_at = std::chrono::system_clock::now();
+    return result;
+}
+
+IncidentDispatcher::Config fast_config() {
+    IncidentDispatcher::Config config;
+    config.retry_backoff = std::chrono::milliseconds(1);
+    config.max_retry_backoff = std::chrono::milliseconds(5);
+    return config;
+}
+
+} // namespace
+
+TEST(IncidentDispatcher, DeliversCreateUpdateResolveInOrder) {
+    auto fake = std::make_shared<FakeIntegration>();
+    IncidentDispatcher dispatcher(fast_config());
+
+    dispatcher.submit_create(fake, incident("INC-1", "created"));
+    ASSERT_TRUE(dispatcher.flush(std::chrono::seconds(5)));
+    dispatcher.submit_update(fake, incident("INC-1", "updated"));
+    ASSERT_TRUE(dispatcher.flush(std::chrono::seconds(5)));
+    dispatcher.submit_resolve(fake, "INC-1", "fixed");
+    ASSERT_TRUE(dispatcher.flush(std::chrono::seconds(5)));
+
+    EXPECT_EQ(fake->creates, std::vector<std::string>{"created"});
+    EXPECT_EQ(fake->updates, std::vector<std::string>{"FAKE-INC-1:updated"});
+    EXPECT_EQ(fake->resolves, std::vector<std::string>{"FAKE-INC-1:fixed"});
+}
+
+TEST(IncidentDispatcher, FailedCreateKeepsNewerSubmission) {
+    auto fake = std::make_shared<FakeIntegration>();
+    fake->hold_first_create = true;
+    IncidentDispatcher dispatcher(fast_config());
+
+    dispatcher.submit_create(fake, incident("INC-1", "old"));
+    fake->wait_for_first_create();
+    dispatcher.submit_create(fake, incident("INC-1", "new"));
+    fake->release();
+
+    // Nothing is left pending, so flush returns well before its timeout
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(dispatcher.flush(std::chrono::seconds(5)));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+    ASSERT_EQ(fake->creates.size(), 2u);
+    EXPECT_EQ(fake->creates.back(), "new");
+    auto stats = dispatcher.get_stats();
+    EXPECT_EQ(stats.sent, 1u);
+    EXPECT_EQ(stats.coalesced, 1u);
+}
+
+TEST(IncidentDispatcher, EvictsIdleTicketsBeyondCap) {
+    auto fake = std::make_shared<FakeIntegration>();
+    auto config = fast_config();
+    config.max_idle_tickets = 2;
+    IncidentDispatcher dispatcher(config);
+
+    for (int i = 1; i <= 5; ++i) {
+        dispatcher.submit_create(fake, incident("INC-" + std::to_string(i), "t"));
+        ASSERT_TRUE(dispatcher.flush(std::chrono::seconds(5)));
+    }
+    EXPECT_EQ(dispatcher.get_stats().tickets_evicted, 3u);
+
+    // The newest tickets still know their external IDs; evicted ones do not
+    dispatcher.submit_update(fake, incident("INC-5", "late"));
+    dispatcher.submit_update(fake, incident("INC-1", "late"));
+    ASSERT_TRUE(dispatcher.flush(std::chrono::seconds(5)));
+    EXPECT_EQ(fake->updates, std::vector<std::string>{"FAKE-INC-5:late"});
+}
+
+TEST(IncidentDispatcher, EvictsTicketsIdleTooLong) {
+    auto fake = std::make_shared<FakeIntegration>();
+    auto config = fast_config();
+    config.idle_ticket_timeout = std::chrono::seconds(0);
+    IncidentDispatcher dispatcher(config);
+
+    dispatcher.submit_create(fake, incident("INC-1", "t"));
+    ASSERT_TRUE(dispatcher.flush(std::chrono::seconds(5)));
+    EXPECT_EQ(dispatcher.get_stats().tickets_evicted, 1u);
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "literal_scanner.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace agentlog::detail;
+
+namespace {
+
+using Literals = std::optional<std::vector<std::string>>;
+
+Literals literals(std::vector<std::string> expected) {
+    return expected;
+}
+
+// True if some literal occurs in text, as the prefilter would report
+bool prefilter_passes(const std::vector<std::string>& required, const std::string& text) {
+    return std::any_of(required.begin(), required.end(), [&](const std::string& literal) {
+        return text.find(literal) != std::string::npos;
+    });
+}
+
+std::set<uint32_t> scan(const LiteralScanner& scanner, const std::string& text) {
+    std::set<uint32_t> owners;
+    scanner.scan(text, [&](uint32_t owner) { owners.insert(owner); });
+    return owners;
+}
+
+} // namespace
+
+TEST(RequiredLiterals, PlainTextIsOneLiteral) {
+    EXPECT_EQ(required_literals("connection refused"), literals({"connection refused"}));
+}
+
+TEST(RequiredLiterals, TopLevelAlternativesEachNeedALiteral) {
+    EXPECT_EQ(required_literals("timeout|refused"), literals({"timeout", "refused"}));
+    EXPECT_EQ(required_literals("error: (timeout|refused)"), literals({"error: "}));
+    EXPECT_EQ(required_literals("(timeout|refused)"), std::nullopt);
+    EXPECT_EQ(required_literals("timeout|"), std::nullopt);
+    EXPECT_EQ(required_literals("timeout|\\d+"), std::nullopt);
+}
+
+TEST(RequiredLiterals, EscapesStandForTheirCharacterOrEndTheRun) {
+    EXPECT_EQ(required_literals("a\\.b\\|c"), literals({"a.b|c"}));
+    EXPECT_EQ(required_literals("line\\nnext"), literals({"line\nnext"}));
+    EXPECT_EQ(required_literals("\\d+ ms"), literals({" ms"}));
+    EXPECT_EQ(required_literals("ab\\bcd"), literals({"ab"}));
+
+    // Operands of an escape are not literal text
+    EXPECT_EQ(required_literals("\\x41BCD"), literals({"BCD"}));
+    EXPECT_EQ(required_literals("\\u00410Z"), literals({"0Z"}));
+    EXPECT_EQ(required_literals("\\cJxyz"), literals({"xyz"}));
+    EXPECT_EQ(required_literals("(a)\\12b"), literals({"b"}));
+}
+
+TEST(RequiredLiterals, ClassesAndGroupsEndTheRun) {
+    EXPECT_EQ(required_literals("[0-9]+ errors"), literals({" errors"}));
+    EXPECT_EQ(required_literals("[|]x"), literals({"x"}));
+    EXPECT_EQ(required_literals("[]|]yz"), literals({"yz"}));
+    EXPECT_EQ(required_literals("[a\\]|]yz"), literals({"yz"}));
+    EXPECT_EQ(required_literals("disk (full|quota)!"), literals({"disk "}));
+    EXPECT_EQ(required_literals("[a-z]+"), std::nullopt);
+    EXPECT_EQ(required_literals("\\d+"), std::nullopt);
+}
+
+TEST(RequiredLiterals, QuantifiersDropOrEndOnTheirAtom) {
+    // x+ keeps one x; x*, x?, x{n} drop it
+    EXPECT_EQ(required_literals("abc+d"), literals({"abc"}));
+    EXPECT_EQ(required_literals("ab*cde"), literals({"cde"}));
+    EXPECT_EQ(required_literals("abc?de"), literals({"ab"}));
+    EXPECT_EQ(required_literals("abcx{0}yz"), literals({"abc"}));
+    EXPECT_EQ(required_literals("x{0}"), std::nullopt);
+    EXPECT_EQ(required_literals("ab{2,3}c"), literals({"a"}));
+    EXPECT_EQ(required_literals("(ab)+cd"), literals({"cd"}));
+}
+
+TEST(RequiredLiterals, LazyQuantifiersAreSkippedWhole) {
+    EXPECT_EQ(required_literals("ab+?cd"), literals({"ab"}));
+    EXPECT_EQ(required_literals("ab*?cde"), literals({"cde"}));
+    EXPECT_EQ(required_literals("ab??cde"), literals({"cde"}));
+    EXPECT_EQ(required_literals("ab{0,1}?cde"), literals({"cde"}));
+}
+
+TEST(RequiredLiterals, NeverRejectsAStdRegexMatch) {
+    // Random regexes over a small alphabet, checked against random texts:
+    // whenever std::regex_search matches, one required literal must occur
+    const std::vector<std::string> atoms{
+        "a", "b", "ab", "ba", "\\.", "\\d", "[ab]", "[^a]", "(a|b)", "(ab)",
+        ".", "\\x61", "\\cJ", "\\n", "(?:ba)", "\\b", "^", "$", "(a)\\1"};
+    const std::vector<std::string> quantifiers{
+        "", "", "", "", "*", "+", "?", "{0}", "{1,2}", "{2}", "+?", "*?", "??"};
+    const std::string alphabet = "ab.1\n";
+
+    std::mt19937 rng(20251014);
+    auto pick = [&rng](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(rng); };
+
+    size_t checked = 0;
+    for (int r = 0; r < 600; ++r) {
+        std::string pattern;
+        size_t branches = 1 + pick(3);
+        for (size_t b = 0; b < branches; ++b) {
+            if (b > 0) {
+                pattern += '|';
+            }
+            size_t terms = 1 + pick(5);
+            for (size_t t = 0; t < terms; ++t) {
+                pattern += atoms[pick(atoms.size())];
+                pattern += quantifiers[pick(quantifiers.size())];
+            }
+        }
+
+        std::regex regex;
+        try {
+            regex = std::regex(pattern, std::regex::ECMAScript);
+        } catch (const std::regex_error&) {
+            continue;
+        }
+        auto required = required_literals(pattern);
+        if (!required) {
+            continue;
+        }
+
+        for (int n = 0; n < 200; ++n) {
+            std::string text;
+            size_t length = pick(9);
+            for (size_t i = 0; i < length; ++i) {
+                text += alphabet[pick(alphabet.size())];
+            }
+            if (std::regex_search(text, regex)) {
+                ++checked;
+                EXPECT_TRUE(prefilter_passes(*required, text))
+                    << "pattern /" << pattern << "/ matches \"" << text << "\"";
+            }
+        }
+    }
+    EXPECT_GT(checked, 1000u);
+}
+
+TEST(LiteralScanner, ReportsOwnersOfEveryLiteralFound) {
+    LiteralScanner scanner;
+    scanner.add("he", 0);
+    scanner.add("she", 1);
+    scanner.add("his", 2);
+    scanner.add("hers", 3);
+    scanner.build();
+
+    EXPECT_EQ(scan(scanner, "ushers"), (std::set<uint32_t>{0, 1, 3}));
+    EXPECT_EQ(scan(scanner, "this"), (std::set<uint32_t>{2}));
+    EXPECT_TRUE(scan(scanner, "xyz").empty());
+    EXPECT_TRUE(scan(scanner, "").empty());
+}
+
+TEST(LiteralScanner, EmptyUntilBuilt) {
+    LiteralScanner scanner;
+    EXPECT_TRUE(scanner.empty());
+    scanner.add("", 0);
+    EXPECT_TRUE(scanner.empty());
+
+    scanner.add("abc", 7);
+    EXPECT_TRUE(scan(scanner, "abc").empty());
+    scanner.build();
+    EXPECT_EQ(scan(scanner, "xxabcxx"), (std::set<uint32_t>{7}));
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2025 AgentLog Contributors
+// SPDX-License-Identifier: MIT
+
+#include "state_snapshot.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <unistd.h>
+
+using namespace agentlog;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class StateSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        dir_ = fs::temp_directory_path() /
+               ("agentlog_snapshot_" + std::to_string(::getpid()) + "_" + info->name());
+        fs::remove_all(dir_);
+        path_ = (dir_ / "state.snapshot").string();
+    }
+
+    void TearDown() override { fs::remove_all(dir_); }
+
+    std::string read_file() const {
+        std::ifstream in(path_, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    }
+
+    void write_file(const std::string& data) const {
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    // A snapshot that already holds one section, to check failed loads keep it
+    static StateSnapshot loaded_marker() {
+        StateSnapshot snapshot;
+        snapshot.add("marker", "keep");
+        return snapshot;
+    }
+
+    static StateSnapshot sample() {
+        StateSnapshot snapshot;
+        snapshot.add("detectors", std::string("\x00\x01\x02 binary", 10));
+        snapshot.add("patterns", "");
+        snapshot.add("causality", std::string(100000, 'c'));
+        return snapshot;
+    }
+
+    fs::path dir_;
+    std::string path_;
+};
+
+} // namespace
+
+TEST_F(StateSnapshotTest, RoundTripsSections) {
+    ASSERT_TRUE(sample().save(path_));
+    EXPECT_FALSE(fs::exists(path_ + ".tmp"));
+
+    StateSnapshot loaded;
+    ASSERT_TRUE(loaded.load(path_));
+    ASSERT_NE(loaded.find("detectors"), nullptr);
+    EXPECT_EQ(*loaded.find("detectors"), std::string("\x00\x01\x02 binary", 10));
+    ASSERT_NE(loaded.find("patterns"), nullptr);
+    EXPECT_TRUE(loaded.find("patterns")->empty());
+    EXPECT_EQ(loaded.find("causality")->size(), 100000u);
+    EXPECT_EQ(loaded.find("missing"), nullptr);
+}
+
+TEST_F(StateSnapshotTest, SaveReplacesPreviousSnapshot) {
+    ASSERT_TRUE(sample().save(path_));
+    StateSnapshot newer;
+    newer.add("only", "one");
+    ASSERT_TRUE(newer.save(path_));
+
+    StateSnapshot loaded;
+    ASSERT_TRUE(loaded.load(path_));
+    EXPECT_EQ(loaded.find("detectors"), nullptr);
+    EXPECT_EQ(*loaded.find("only"), "one");
+}
+
+TEST_F(StateSnapshotTest, MissingFileLoadsNothing) {
+    StateSnapshot snapshot = loaded_marker();
+    EXPECT_FALSE(snapshot.load(path_));
+    EXPECT_NE(snapshot.find("marker"), nullptr);
+}
+
+TEST_F(StateSnapshotTest, RejectsEveryCorruptedByte) {
+    ASSERT_TRUE(sample().save(path_));
+    std::string good = read_file();
+
+    // Checksummed, so a flip anywhere is caught (step through the large
+    // payload rather than visiting all of it)
+    for (size_t i = 0; i < good.size(); i += (i < 64 || i + 64 > good.size()) ? 1 : 997) {
+        std::string bad = good;
+        bad[i] = static_cast<char>(bad[i] ^ 0x20);
+        write_file(bad);
+        StateSnapshot snapshot = loaded_marker();
+        EXPECT_FALSE(snapshot.load(path_)) << "flip at " << i;
+        EXPECT_NE(snapshot.find("marker"), nullptr);
+    }
+}
+
+TEST_F(StateSnapshotTest, RejectsTruncatedAndForeignFiles) {
+    ASSERT_TRUE(sample().save(path_));
+    std::string good = read_file();
+
+    for (size_t size : {size_t(0), size_t(5), size_t(16), good.size() / 2, good.size() - 1}) {
+        write_file(good.substr(0, size));
+        StateSnapshot snapshot = loaded_marker();
+        EXPECT_FALSE(snapshot.load(path_)) << "truncated to " << size;
+        EXPECT_NE(snapshot.find("marker"), nullptr);
+    }
+
+    write_file("not a snapshot at all, just some text");
+    StateSnapshot snapshot;
+    EXPECT_FALSE(snapshot.load(path_));
+}